@@ -1,5 +1,152 @@
+/**
+ * @file       banword.c
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  BANWORD - removes the lines containing banned words; example that uses
+ *            the 'textfile.h' library
+ * -------------------------------------------------------------------------
+ *  Copyright (c) 2020 Martin Rizzo
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ * -------------------------------------------------------------------------
+ */
+
+/* includes the 'textfile.h' library and its implementation */
+#define TEXTFILE_IMPLEMENTATION
+#include "../textfile.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SPANS 256 /* < number of lines read at once by 'textfgetlines' */
+
+
+/*=================================================================================================================*/
+#pragma mark - > WORD LIST
+
+/** List of banned words */
+typedef struct WORDLIST {
+    char** words;
+    int    count;
+    int    capacity;
+} WORDLIST;
+
+/**
+ * Adds a copy of the provided word to the list
+ * @param list    Pointer to the list of words
+ * @param word    The word to add (it doesn't need to be null-terminated)
+ * @param length  The length of the word in bytes
+ */
+static void addWord(WORDLIST* list, const char* word, size_t length) {
+    assert( list!=NULL && word!=NULL );
 
+    if (list->count==list->capacity) {
+        list->capacity = list->capacity ? 2*list->capacity : 16;
+        list->words    = realloc(list->words, list->capacity*sizeof(char*));
+    }
+    list->words[list->count] = malloc(length+1);
+    memcpy(list->words[list->count], word, length);
+    list->words[list->count][length] = '\0';
+    ++list->count;
+}
 
+/**
+ * Adds to the list all the words contained in a text file (one word per line, the empty lines are ignored)
+ * @param list      Pointer to the list of words
+ * @param filename  The path to the file containing the words
+ * @returns         TRUE if the file was read, FALSE if it can't be opened
+ */
+static int addWordsFromFile(WORDLIST* list, const char* filename) {
+    TEXTFILE* textfile; const char* line; size_t length;
+    assert( list!=NULL && filename!=NULL );
+
+    textfile = textfopen(filename, "r");
+    if (textfile==NULL || !textfissupported(textfile)) { textfclose(textfile); return 0; }
+    while ((line=textfgetline_n(textfile, &length))!=NULL) {
+        if (length>0) { addWord(list, line, length); }
+    }
+    textfclose(textfile);
+    return 1;
+}
+
+/**
+ * Releases all the words contained in the list
+ * @param list  Pointer to the list of words
+ */
+static void freeWords(WORDLIST* list) {
+    int i;
+    assert( list!=NULL );
+    for (i=0; i<list->count; ++i) { free(list->words[i]); }
+    free(list->words);
+    list->words = NULL; list->count = list->capacity = 0;
+}
+
+
+/*=================================================================================================================*/
+#pragma mark - > FILTERING
+
+/**
+ * Prints the lines of a file that don't contain any of the banned words (or only the ones containing them)
+ * @param filename     The path to the file to filter ("-" = standard input)
+ * @param search       The banned words prepared with 'textfsearch_new'
+ * @param printBanned  TRUE to print only the lines containing banned words (instead of removing them)
+ */
+static void filterFile(const char* filename, const TEXTF_SEARCH* search, int printBanned) {
+    TEXTFILE* textfile; TEXTF_SPAN spans[SPANS]; const char* line; size_t length; int i, count;
+    assert( filename!=NULL && search!=NULL );
+
+    textfile = strcmp(filename,"-")==0 ? textfopen_stream(stdin) : textfopen(filename, "r");
+    if (textfile==NULL) { fprintf(stderr, "banword: can't open '%s'\n", filename); return; }
+    if (!textfissupported(textfile)) {
+        fprintf(stderr, "banword: '%s' is not a supported text file\n", filename);
+        textfclose(textfile); return;
+    }
+    if (printBanned) {
+        /* the buffer is searched at once, the lines without banned words are never examined one by one */
+        while ((line=textfgetmatch(textfile, search, &length, NULL))!=NULL) {
+            fwrite(line, sizeof(char), length, stdout); putchar('\n');
+        }
+    }
+    else {
+        while ((count=textfgetlines(textfile, spans, SPANS))>0) {
+            for (i=0; i<count; ++i) {
+                if (textfsearch_find(search, spans[i].line, spans[i].length, NULL)!=NULL) { continue; }
+                fwrite(spans[i].line, sizeof(char), spans[i].length, stdout); putchar('\n');
+            }
+        }
+    }
+    textfclose(textfile);
+}
+
+
+/*=================================================================================================================*/
+#pragma mark - > MAIN
+
+#define VERSION   "0.1"
+#define COPYRIGHT "Copyright (c) 2020 Martin Rizzo"
+#define isOption(param,name1,name2) \
+    (strcmp(param,name1)==0 || strcmp(param,name2)==0)
 
 /**
  * Application starting point
@@ -7,7 +154,62 @@
  * @param argv  An array containing each command-line parameter (starting at argv[1])
  */
 int main(int argc, char *argv[]) {
-    argc = argc;
-    argv = argv;
+    const char **files; int fileCount;
+    const char *param; int i; WORDLIST list; TEXTF_SEARCH* search;
+    int searchFlags=0, printBanned=0;
+    int printHelpAndExit=0, printVersionAndExit=0;
+    const char *help[] = {
+        "USAGE: banword [options] file1.txt file2.txt ...","",
+        "  Prints the lines of the files that don't contain any of the banned words.",
+        "  Use '-' as file name to read the standard input.","",
+        "  OPTIONS:",
+        "    -w, --word <word>      ban the provided word, ex: --word dog (can be repeated)",
+        "    -f, --file <list.txt>  ban all the words contained in the file (one word per line)",
+        "    -i, --ignore-case      ignore the case of the ASCII letters",
+        "    -m, --matches          print only the lines that contain banned words",
+        "    -h, --help             display this help and exit",
+        "    -v, --version          output version information and exit",
+        NULL
+    };
+
+    files = malloc(argc * sizeof(char*));
+    memset(&list, 0, sizeof(list));
+
+    /* process all flags & options */
+    fileCount=0;
+    for (i=1; i<argc; ++i) { param=argv[i];
+        if ( param[0]!='-' || param[1]=='\0' ) { files[fileCount++]=param; }
+        else {
+            if      ( isOption(param,"-w","--word"   ) ) {
+                /* (an empty word would match every line, it's ignored like the empty lines of a word list) */
+                ++i; if (i<argc && argv[i][0]!='\0') { addWord(&list,argv[i],strlen(argv[i])); }
+            }
+            else if ( isOption(param,"-f","--file"   ) ) {
+                ++i; if (i<argc && !addWordsFromFile(&list,argv[i])) {
+                    fprintf(stderr, "banword: can't read the words from '%s'\n", argv[i]); return 1;
+                }
+            }
+            else if ( isOption(param,"-i","--ignore-case") ) { searchFlags=TEXTF_SEARCH_IGNORECASE; }
+            else if ( isOption(param,"-m","--matches") ) { printBanned=1;                                   }
+            else if ( isOption(param,"-h","--help")    ) { printHelpAndExit=1;                              }
+            else if ( isOption(param,"-v","--version") ) { printVersionAndExit=1;                           }
+        }
+    }
+
+    /* print help or version if requested */
+    if ( printHelpAndExit    ) { i=0; while (help[i]!=NULL) { printf("%s\n",help[i++]); } return 0; }
+    if ( printVersionAndExit ) { printf("BANWORD version %s\n%s\n", VERSION, COPYRIGHT);  return 0; }
+
+    /* all the banned words are searched at once */
+    search = textfsearch_new((const char* const*)list.words, list.count, searchFlags);
+    if (!search) { fprintf(stderr, "banword: the banned words can't contain end-of-line characters\n"); return 1; }
+
+    /* filter all requested files */
+    for (i=0; i<fileCount; ++i) {
+        filterFile(files[i], search, printBanned);
+    }
+    textfsearch_free(search);
+    freeWords(&list);
+    free(files);
     return 0;
 }
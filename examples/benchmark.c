@@ -0,0 +1,482 @@
+/**
+ * @file       benchmark.c
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  BENCHMARK - measures the throughput of the 'textfile.h' library
+ * -------------------------------------------------------------------------
+ *  Copyright (c) 2020 Martin Rizzo
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ * -------------------------------------------------------------------------
+ */
+
+/* getline(), clock_gettime(), getrusage() and fork() are POSIX extensions */
+#define _XOPEN_SOURCE 700
+
+/* includes the 'textfile.h' library and its implementation */
+#define TEXTFILE_IMPLEMENTATION
+#include "../textfile.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#define MEGABYTE   (1024L*1024L)
+#define BUFSIZE    4096   /* size of the buffer used by the 'fgets' and 'textfgets' readers */
+#define BLOCKSIZE  65536  /* size of the blocks read by the 'textfgetline-64k' and '-ra' readers */
+#define READAHEAD  4      /* number of blocks read in advance by the 'textfgetline-ra' reader     */
+#define SPANS      256    /* number of lines requested in each call by the 'textfgetlines' reader */
+
+
+/*=================================================================================================================*/
+#pragma mark - > CORPUS GENERATOR
+
+typedef struct CORPUS_ENCODING { const char* name; TEXTF_ENCODING encoding; } CORPUS_ENCODING;
+typedef struct CORPUS_EOL      { const char* name; const char* chars; TEXTF_EOL eol; } CORPUS_EOL;
+typedef struct CORPUS_PROFILE  { const char* name; long minLength; long maxLength; } CORPUS_PROFILE;
+
+static const CORPUS_ENCODING theEncodings[] = {
+    { "utf8",        TEXTF_ENCODING_UTF8         },
+    { "utf8-bom",    TEXTF_ENCODING_UTF8_BOM     },
+    { "utf16le",     TEXTF_ENCODING_UTF16_LE     },
+    { "utf16be",     TEXTF_ENCODING_UTF16_BE     },
+    { "utf16le-bom", TEXTF_ENCODING_UTF16_LE_BOM },
+    { "utf16be-bom", TEXTF_ENCODING_UTF16_BE_BOM },
+    { "cp1252",      TEXTF_ENCODING_WINDOWS1252  },
+    { NULL,          TEXTF_ENCODING_BINARY       }
+};
+static const CORPUS_EOL theEols[] = {
+    { "windows",    "\r\n", TEXTF_EOL_WINDOWS    },
+    { "unix",       "\n",   TEXTF_EOL_UNIX       },
+    { "classicmac", "\r",   TEXTF_EOL_CLASSICMAC },
+    { "acornbbc",   "\n\r", TEXTF_EOL_ACORNBBC   },
+    { NULL,         NULL,   TEXTF_EOL_UNKNOWN    }
+};
+/* line lengths (in characters) of each profile; 'huge' and 'empty' are the pathological cases */
+static const CORPUS_PROFILE theProfiles[] = {
+    { "short", 0,           80            },
+    { "long",  200,         4000          },
+    { "huge",  MEGABYTE,    4*MEGABYTE    },
+    { "empty", 0,           0             },
+    { NULL,    0,           0             }
+};
+
+/** Returns a pseudo-random number between 0 and 32767 (the same sequence in any platform) */
+static long randomNumber(unsigned long* seed) {
+    *seed = (*seed * 1103515245UL + 12345UL) & 0xFFFFFFFFUL;
+    return (long)((*seed >> 16) & 0x7FFF);
+}
+
+/** Returns a pseudo-random unicode character, mostly ASCII but with some 2, 3 and 4 bytes UTF-8 sequences */
+static unsigned long randomCharacter(unsigned long* seed) {
+    static const char letters[] = "abcdefghijklmnopqrstuvwxyz     ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789.,;";
+    long value = randomNumber(seed) % 100;
+    if (value<94) { return (unsigned char)letters[ randomNumber(seed) % (sizeof(letters)-1) ]; }
+    if (value<97) { return 0x00E0 + (unsigned long)(randomNumber(seed) % 32);    } /* latin letters     */
+    if (value<99) { return 0x4E00 + (unsigned long)(randomNumber(seed) % 0x1000); } /* CJK ideographs   */
+    return 0x1F600 + (unsigned long)(randomNumber(seed) % 64);                      /* emoticons (UTF-16 surrogates) */
+}
+
+/**
+ * Writes an unicode character to the file using the provided encoding
+ * @returns the number of bytes written
+ */
+static long writeCharacter(FILE* file, TEXTF_ENCODING encoding, unsigned long ch) {
+    unsigned char bytes[4]; unsigned long high; int i, count=0;
+
+    if (encoding==TEXTF_ENCODING_UTF8 || encoding==TEXTF_ENCODING_UTF8_BOM) {
+        if      (ch<0x80   ) { bytes[0]=(unsigned char)ch; count=1; }
+        else if (ch<0x800  ) { bytes[0]=(unsigned char)(0xC0|(ch>>6));  count=2; }
+        else if (ch<0x10000) { bytes[0]=(unsigned char)(0xE0|(ch>>12)); count=3; }
+        else                 { bytes[0]=(unsigned char)(0xF0|(ch>>18)); count=4; }
+        for (i=1; i<count; ++i) { bytes[i] = (unsigned char)(0x80 | ((ch>>(6*(count-1-i))) & 0x3F)); }
+        fwrite(bytes, 1, (size_t)count, file);
+        return count;
+    }
+    /* the characters that don't exist in Windows-1252 are written as the euro sign (0x80) */
+    if (encoding==TEXTF_ENCODING_WINDOWS1252) {
+        bytes[0] = (unsigned char)(ch<0x80 || (0xA0<=ch && ch<=0xFF) ? ch : 0x80);
+        fwrite(bytes, 1, 1, file);
+        return 1;
+    }
+    if (ch>=0x10000) {
+        ch -= 0x10000; high = 0xD800 + (ch>>10);
+        count += writeCharacter(file, encoding, high);
+        ch = 0xDC00 + (ch & 0x3FF);
+    }
+    if (encoding==TEXTF_ENCODING_UTF16_LE || encoding==TEXTF_ENCODING_UTF16_LE_BOM) {
+        bytes[0]=(unsigned char)(ch & 0xFF); bytes[1]=(unsigned char)(ch>>8);
+    } else {
+        bytes[0]=(unsigned char)(ch>>8); bytes[1]=(unsigned char)(ch & 0xFF);
+    }
+    fwrite(bytes, 1, 2, file);
+    return count+2;
+}
+
+/**
+ * Generates a text file with pseudo-random content
+ * @param filename  The path to the file to generate
+ * @param encoding  The encoding of the text
+ * @param eol       The characters used as end-of-line
+ * @param profile   The minimum and maximum length of the lines
+ * @param size      The approximate size of the file in bytes
+ * @returns TRUE on success, FALSE if the file can't be written
+ */
+static int generateFile(const char* filename, const CORPUS_ENCODING* encoding, const CORPUS_EOL* eol,
+                        const CORPUS_PROFILE* profile, long size) {
+    FILE* file; unsigned long seed=1; long written=0, length, i; const char* ptr;
+    assert( filename!=NULL && encoding!=NULL && eol!=NULL && profile!=NULL );
+
+    file = fopen(filename, "wb"); if (!file) { return 0; }
+    switch (encoding->encoding) {
+        case TEXTF_ENCODING_UTF8_BOM:     fwrite("\xEF\xBB\xBF", 1, 3, file); written=3; break;
+        case TEXTF_ENCODING_UTF16_LE_BOM: fwrite("\xFF\xFE",     1, 2, file); written=2; break;
+        case TEXTF_ENCODING_UTF16_BE_BOM: fwrite("\xFE\xFF",     1, 2, file); written=2; break;
+        default: break;
+    }
+    while (written<size) {
+        length = profile->minLength;
+        if (profile->maxLength>profile->minLength) {
+            length += (randomNumber(&seed)*32768L + randomNumber(&seed)) % (profile->maxLength-profile->minLength+1);
+        }
+        for (i=0; i<length && written<size; ++i) {
+            written += writeCharacter(file, encoding->encoding, randomCharacter(&seed));
+        }
+        for (ptr=eol->chars; *ptr; ++ptr) {
+            written += writeCharacter(file, encoding->encoding, (unsigned char)*ptr);
+        }
+    }
+    return fclose(file)==0;
+}
+
+/**
+ * Generates a file for every combination of encoding, end-of-line and line length
+ * @param directory  The directory where the files will be generated (it must exist)
+ * @param size       The approximate size of each file in bytes
+ * @param files      Array where the paths of the generated files will be stored (it must have room for all)
+ * @returns the number of generated files
+ */
+static int generateCorpus(const char* directory, long size, char** files) {
+    const CORPUS_ENCODING* encoding; const CORPUS_EOL* eol; const CORPUS_PROFILE* profile;
+    char* filename; int count=0;
+    assert( directory!=NULL && files!=NULL );
+
+    for (encoding=theEncodings; encoding->name; ++encoding) {
+        for (eol=theEols; eol->name; ++eol) {
+            for (profile=theProfiles; profile->name; ++profile) {
+                filename = malloc(strlen(directory)+64);
+                sprintf(filename, "%s/%s_%s_%s.txt", directory, encoding->name, eol->name, profile->name);
+                fprintf(stderr, "generating %s\n", filename);
+                if (!generateFile(filename, encoding, eol, profile, size)) {
+                    fprintf(stderr, "error: can't write %s\n", filename);
+                    free(filename); continue;
+                }
+                files[count++] = filename;
+            }
+        }
+    }
+    return count;
+}
+
+
+/*=================================================================================================================*/
+#pragma mark - > READERS
+
+/** Values measured by a reader (the 'checksum' prevents the compiler from discarding the reading loop) */
+typedef struct RESULT {
+    long   lines;
+    long   checksum;
+    double seconds;
+    long   peakRSS;
+} RESULT;
+
+typedef int (*READERFUNC)(const char* filename, RESULT* result);
+
+static int readWithTextfgetline(const char* filename, RESULT* result, const char* mode) {
+    TEXTFILE* textfile; const char* line;
+    textfile = textfopen(filename, mode); if (!textfile) { return 0; }
+    while ((line=textfgetline(textfile))!=NULL) { ++result->lines; result->checksum+=line[0]; }
+    textfclose(textfile);
+    return 1;
+}
+
+static int readTextfgetline(const char* filename, RESULT* result) {
+    return readWithTextfgetline(filename, result, "r");
+}
+
+static int readTextfgetlineMapped(const char* filename, RESULT* result) {
+    return readWithTextfgetline(filename, result, "rm");
+}
+
+static int readWithOptions(const char* filename, RESULT* result, int readAhead, TEXTF_VALIDATE validate) {
+    TEXTFILE* textfile; const char* line; TEXTF_OPTIONS options;
+    memset(&options, 0, sizeof(options));
+    options.blockSize  = BLOCKSIZE;
+    options.bufferSize = 2*BLOCKSIZE;
+    options.readAhead  = readAhead;
+    options.validate   = validate;
+    textfile = textfopen_ex(filename, "r", &options); if (!textfile) { return 0; }
+    while ((line=textfgetline(textfile))!=NULL) { ++result->lines; result->checksum+=line[0]; }
+    textfclose(textfile);
+    return 1;
+}
+
+static int readTextfgetlineBlocks(const char* filename, RESULT* result) {
+    return readWithOptions(filename, result, 0, TEXTF_VALIDATE_NONE);
+}
+
+static int readTextfgetlineValidate(const char* filename, RESULT* result) {
+    return readWithOptions(filename, result, 0, TEXTF_VALIDATE_REPORT);
+}
+
+static int readTextfgetlineAhead(const char* filename, RESULT* result) {
+    return readWithOptions(filename, result, READAHEAD, TEXTF_VALIDATE_NONE);
+}
+
+static int readTextfgetline_n(const char* filename, RESULT* result) {
+    TEXTFILE* textfile; size_t length;
+    textfile = textfopen(filename, "r"); if (!textfile) { return 0; }
+    while (textfgetline_n(textfile, &length)!=NULL) { ++result->lines; result->checksum+=(long)length; }
+    textfclose(textfile);
+    return 1;
+}
+
+static int readTextfgetlines(const char* filename, RESULT* result) {
+    TEXTFILE* textfile; TEXTF_SPAN spans[SPANS]; int count, i;
+    textfile = textfopen(filename, "r"); if (!textfile) { return 0; }
+    while ((count=textfgetlines(textfile, spans, SPANS))>0) {
+        for (i=0; i<count; ++i) { result->checksum+=(long)spans[i].length; }
+        result->lines += count;
+    }
+    textfclose(textfile);
+    return 1;
+}
+
+static int readTextfgets(const char* filename, RESULT* result) {
+    TEXTFILE* textfile; char buffer[BUFSIZE];
+    textfile = textfopen(filename, "r"); if (!textfile) { return 0; }
+    while (textfgets(buffer, BUFSIZE, textfile)!=NULL) { ++result->lines; result->checksum+=(long)strlen(buffer); }
+    textfclose(textfile);
+    return 1;
+}
+
+static int readFgets(const char* filename, RESULT* result) {
+    FILE* file; char buffer[BUFSIZE]; size_t length;
+    file = fopen(filename, "rb"); if (!file) { return 0; }
+    while (fgets(buffer, BUFSIZE, file)!=NULL) {
+        length = strlen(buffer); result->checksum+=(long)length;
+        if (length>0 && buffer[length-1]=='\n') { ++result->lines; }
+    }
+    fclose(file);
+    return 1;
+}
+
+static int readGetline(const char* filename, RESULT* result) {
+    FILE* file; char* line=NULL; size_t size=0; ssize_t length;
+    file = fopen(filename, "rb"); if (!file) { return 0; }
+    while ((length=getline(&line, &size, file))!=-1) { ++result->lines; result->checksum+=(long)length; }
+    free(line);
+    fclose(file);
+    return 1;
+}
+
+typedef struct READER { const char* name; READERFUNC read; } READER;
+
+static const READER theReaders[] = {
+    { "textfgetline",    readTextfgetline       },
+    { "textfgetline-rm", readTextfgetlineMapped },
+    { "textfgetline-64k",readTextfgetlineBlocks },
+    { "textfgetline-ra", readTextfgetlineAhead  },
+    { "textfgetline-utf8",readTextfgetlineValidate },
+    { "textfgetline_n",  readTextfgetline_n     },
+    { "textfgetlines",   readTextfgetlines      },
+    { "textfgets",       readTextfgets          },
+    { "fgets",           readFgets              },
+    { "getline",         readGetline            },
+    { NULL,              NULL                   }
+};
+
+
+/*=================================================================================================================*/
+#pragma mark - > MEASUREMENT
+
+static double currentSeconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec/1e9;
+}
+
+/**
+ * Runs a reader in a child process, so the peak memory of each reader is measured independently
+ * @param reader    The reader to run
+ * @param filename  The path to the file to read
+ * @param result    The structure where the measured values will be returned
+ * @returns TRUE on success, FALSE if the file can't be read
+ */
+static int runReader(const READER* reader, const char* filename, RESULT* result) {
+    int fds[2], status; pid_t pid; struct rusage usage; double start; int ok;
+    assert( reader!=NULL && filename!=NULL && result!=NULL );
+
+    if (pipe(fds)!=0) { return 0; }
+    fflush(stdout);
+    pid = fork();
+    if (pid<0) { close(fds[0]); close(fds[1]); return 0; }
+    if (pid==0) {
+        close(fds[0]);
+        memset(result, 0, sizeof(RESULT));
+        start = currentSeconds();
+        ok = reader->read(filename, result);
+        result->seconds = currentSeconds() - start;
+        getrusage(RUSAGE_SELF, &usage); result->peakRSS = usage.ru_maxrss;
+        if (ok) { ok = write(fds[1], result, sizeof(RESULT))==(ssize_t)sizeof(RESULT); }
+        close(fds[1]);
+        _exit(ok ? 0 : 1);
+    }
+    close(fds[1]);
+    ok = read(fds[0], result, sizeof(RESULT))==(ssize_t)sizeof(RESULT);
+    close(fds[0]);
+    waitpid(pid, &status, 0);
+    return ok && WIFEXITED(status) && WEXITSTATUS(status)==0;
+}
+
+/** Returns the short name of the encoding (the same used in the names of the generated files) */
+static const char* getEncodingName(TEXTF_ENCODING encoding) {
+    const CORPUS_ENCODING* item;
+    for (item=theEncodings; item->name; ++item) { if (item->encoding==encoding) { return item->name; } }
+    return "binary";
+}
+
+/** Returns the short name of the end-of-line (the same used in the names of the generated files) */
+static const char* getEolName(TEXTF_EOL eol) {
+    const CORPUS_EOL* item;
+    for (item=theEols; item->name; ++item) { if (item->eol==eol) { return item->name; } }
+    return "unknown";
+}
+
+/**
+ * Measures every reader with the provided file and prints one CSV row per reader
+ * @param filename  The path to the file to read
+ * @param repeat    The number of times each reader is run (the fastest run is reported)
+ */
+static void benchmarkFile(const char* filename, int repeat) {
+    TEXTFILE* textfile; const char *encoding, *eol; const READER* reader;
+    RESULT result, best; struct stat info; double megabytes; int i, ok;
+    assert( filename!=NULL && repeat>0 );
+
+    if (stat(filename, &info)!=0) { fprintf(stderr, "error: can't read %s\n", filename); return; }
+    textfile = textfopen(filename, "r");
+    if (!textfile) { fprintf(stderr, "error: can't open %s\n", filename); return; }
+    encoding = getEncodingName(textfile->encoding);
+    eol      = getEolName(textfile->eol);
+    textfclose(textfile);
+
+    megabytes = (double)info.st_size / (double)MEGABYTE;
+    for (reader=theReaders; reader->name; ++reader) {
+        ok = 1; memset(&best, 0, sizeof(best));
+        for (i=0; i<repeat && ok; ++i) {
+            ok = runReader(reader, filename, &result);
+            if (ok && (i==0 || result.seconds<best.seconds)) { best.seconds = result.seconds; best.lines = result.lines; }
+            if (ok && result.peakRSS>best.peakRSS)          { best.peakRSS = result.peakRSS; }
+        }
+        if (!ok) { fprintf(stderr, "error: %s failed reading %s\n", reader->name, filename); continue; }
+        if (best.seconds<=0) { best.seconds = 1e-9; }
+        printf("%s,%ld,%s,%s,%s,%ld,%.6f,%.2f,%.0f,%ld\n",
+               filename, (long)info.st_size, encoding, eol, reader->name, best.lines, best.seconds,
+               megabytes/best.seconds, (double)best.lines/best.seconds, best.peakRSS);
+        fflush(stdout);
+    }
+}
+
+
+/*=================================================================================================================*/
+#pragma mark - > MAIN
+
+#define VERSION   "0.1"
+#define COPYRIGHT "Copyright (c) 2020 Martin Rizzo"
+#define isOption(param,name1,name2) \
+    (strcmp(param,name1)==0 || strcmp(param,name2)==0)
+
+/**
+ * Application starting point
+ * @param argc  The number of elements in the 'argv' array
+ * @param argv  An array containing each command-line parameter (starting at argv[1])
+ */
+int main(int argc, char *argv[]) {
+    char **files; int fileCount, generatedCount=0;
+    const char *directory=NULL, *param; int i;
+    long size=8; int repeat=3;
+    int printHelpAndExit=0, printVersionAndExit=0;
+    const char *help[] = {
+        "USAGE: benchmark [options] file1.txt file2.txt ...","",
+        "  Measures the speed of 'textfgetline', 'textfgets', 'fgets' and 'getline' reading each file",
+        "  and prints the results in CSV format:",
+        "    file,size,encoding,eol,reader,lines,seconds,mb_per_s,lines_per_s,peak_rss_kb","",
+        "  OPTIONS:",
+        "    -g, --generate <dir>   generate a file for every encoding/eol/line-length in <dir> and measure them",
+        "    -s, --size <mb>        approximate size of each generated file in megabytes (default: 8)",
+        "    -n, --repeat <n>       run each reader <n> times and report the fastest one (default: 3)",
+        "    -h, --help             display this help and exit",
+        "    -v, --version          output version information and exit",
+        NULL
+    };
+
+    files = malloc((argc + 128) * sizeof(char*));
+
+    /* process all flags & options */
+    fileCount=0;
+    for (i=1; i<argc; ++i) { param=argv[i];
+        if ( param[0]!='-' ) { files[fileCount++]=(char*)param; }
+        else {
+            if      ( isOption(param,"-g","--generate") ) { ++i; directory=(i<argc ? argv[i] : NULL);   }
+            else if ( isOption(param,"-s","--size"    ) ) { ++i; size=(i<argc ? atol(argv[i]) : size);  }
+            else if ( isOption(param,"-n","--repeat"  ) ) { ++i; repeat=(i<argc ? atoi(argv[i]) : 1);   }
+            else if ( isOption(param,"-h","--help")     ) { printHelpAndExit=1;                         }
+            else if ( isOption(param,"-v","--version")  ) { printVersionAndExit=1;                      }
+        }
+    }
+    if (size<1)   { size=1;   }
+    if (repeat<1) { repeat=1; }
+
+    /* print help or version if requested */
+    if ( printHelpAndExit    ) { i=0; while (help[i]!=NULL) { printf("%s\n",help[i++]); } return 0; }
+    if ( printVersionAndExit ) { printf("BENCHMARK version %s\n%s\n", VERSION, COPYRIGHT); return 0; }
+
+    /* generate the corpus and measure all files */
+    if (directory) {
+        generatedCount = generateCorpus(directory, size*MEGABYTE, &files[fileCount]);
+        fileCount += generatedCount;
+    }
+    printf("file,size,encoding,eol,reader,lines,seconds,mb_per_s,lines_per_s,peak_rss_kb\n");
+    for (i=0; i<fileCount; ++i) {
+        benchmarkFile(files[i], repeat);
+    }
+    for (i=fileCount-generatedCount; i<fileCount; ++i) { free(files[i]); }
+    free(files);
+    return 0;
+}
@@ -31,13 +31,34 @@
  */
 
 /* includes the 'textfile.h' library and its implementation */
+/* (the performance counters printed by --stats are collected only by 'lines-stats', built with LINES_STATS defined) */
 #define TEXTFILE_IMPLEMENTATION
+#if defined(LINES_STATS)
+#   define TEXTFILE_STATS
+#endif
 #include "../textfile.h"
 
 #include <assert.h>
 #include <stdio.h>
 #include <string.h>
 
+/* several files are processed at once on POSIX systems (define TEXTFILE_NO_THREADS to process them one by one) */
+#if defined(__unix__) || defined(__APPLE__)
+#   define LINES_WRITEV 1
+#   include <sys/uio.h>
+#   include <unistd.h>
+#   include <errno.h>
+#   if !defined(TEXTFILE_NO_THREADS)
+#       define LINES_THREADS 1
+#       include <pthread.h>
+#   endif
+#endif
+
+#define OUT_STDOUT    1           /* < file descriptor of the standard output                                  */
+#define OUT_STDERR    2           /* < file descriptor of the standard error                                   */
+#define OUT_FLUSHSIZE (64*1024)   /* < size of the output buffer that triggers a write                         */
+#define OUT_MAXIOV    64          /* < maximum number of buffers written by each 'writev' call                 */
+
 /*=================================================================================================================*/
 #pragma mark - > HELPER FUNCTIONS
 
@@ -45,15 +66,16 @@
  * Returns TRUE if the line sould be printed
  * @param lineNumber    the line number of the line to evaluate
  * @param line          the text contained in the line
+ * @param length        the length of the line in bytes
  * @param firstLine     number of the first line to prinet (0 = print from the begin of the file)
  * @param lastLine      number of the last line to print (0 = print until the end of the file)
- * @param textToFind    print only lines containing this text (NULL = print all lines)
+ * @param search        print only lines containing any of the searched words (NULL = print all lines)
  */
-#define shouldPrint(lineNumber, line, firstLine, lastLine, textToFind) (\
-    (line!=NULL)                                &&                      \
-    (firstLine<=0     || firstLine<=lineNumber) &&                      \
-    (lastLine <=0     || lineNumber<=lastLine)  &&                      \
-    (textToFind==NULL || strstr(line,textToFind)!=NULL)                 \
+#define shouldPrint(lineNumber, line, length, firstLine, lastLine, search) (     \
+    (line!=NULL)                                &&                              \
+    (firstLine<=0     || firstLine<=lineNumber) &&                              \
+    (lastLine <=0     || lineNumber<=lastLine)  &&                              \
+    (search==NULL     || textfsearch_find(search,line,length,NULL)!=NULL)       \
 )
 
 /**
@@ -79,15 +101,142 @@ static void readRange(int* out_firstLine, int* out_lastLine, int argc, char *arg
 }
 
 
+/*=================================================================================================================*/
+#pragma mark - > OUTPUT BUFFERS
+
+/** Text printed for a file, it's accumulated in memory and written with a few large writes */
+typedef struct OUTBUF {
+    char*   data;
+    size_t  size;
+    size_t  capacity;
+    size_t  flushSize;                  /* < size that triggers a call to 'flush'                        */
+    void  (*flush)(struct OUTBUF* out); /* < writes the data accumulated (NULL = keep it all in memory)  */
+    void*   owner;                      /* < object that the 'flush' function writes the data for        */
+} OUTBUF;
+
+/**
+ * Initializes an empty output buffer
+ * @param out    Pointer to the output buffer to initialize
+ * @param flush  Function that writes the data when the buffer is large enough (NULL = keep it all in memory)
+ * @param owner  Pointer available to the 'flush' function in 'out->owner'
+ */
+static void initOutput(OUTBUF* out, void (*flush)(OUTBUF* out), void* owner) {
+    assert( out!=NULL );
+    out->data      = NULL;
+    out->size      = out->capacity = 0;
+    out->flushSize = OUT_FLUSHSIZE;
+    out->flush     = flush;
+    out->owner     = owner;
+}
+
+/**
+ * Releases the memory used by an output buffer
+ */
+static void freeOutput(OUTBUF* out) {
+    assert( out!=NULL );
+    free(out->data);
+    out->data = NULL; out->size = out->capacity = 0;
+}
+
+/**
+ * Adds text to the output buffer (the buffer is flushed when it's large enough)
+ * @param out     Pointer to the output buffer
+ * @param text    The text to add (it doesn't need to be null-terminated)
+ * @param length  The length of the text in bytes
+ */
+static void outWrite(OUTBUF* out, const char* text, size_t length) {
+    char* data; size_t capacity;
+    assert( out!=NULL && text!=NULL );
+    if (out->size+length>out->capacity) {
+        capacity = out->capacity;
+        while (out->size+length>capacity) { capacity = capacity ? 2*capacity : 4096; }
+        /* (without memory the output can't be kept in order, the program ends writing what was accumulated) */
+        data = realloc(out->data, capacity);
+        if (!data) {
+            if (out->flush) { out->flush(out); }
+            fprintf(stderr, "lines: out of memory\n"); exit(1);
+        }
+        out->data = data; out->capacity = capacity;
+    }
+    memcpy(&out->data[out->size], text, length);
+    out->size += length;
+    if (out->size>=out->flushSize && out->flush) { out->flush(out); }
+}
+
+#define outString(out,string) outWrite(out,string,strlen(string))
+
+/**
+ * Adds a number to the output buffer, right-aligned in a field of the provided width (like printf's "%*ld")
+ */
+static void outNumber(OUTBUF* out, long number, int width) {
+    char digits[32]; char* ptr = &digits[sizeof(digits)]; unsigned long value;
+    assert( out!=NULL && width<(int)sizeof(digits) );
+    
+    value = number<0 ? 0ul-(unsigned long)number : (unsigned long)number;
+    do { *--ptr = (char)('0' + value%10); value /= 10; } while (value>0);
+    if (number<0) { *--ptr = '-'; }
+    while (ptr>&digits[sizeof(digits)-width]) { *--ptr = ' '; }
+    outWrite(out, ptr, (size_t)(&digits[sizeof(digits)]-ptr));
+}
+
+/**
+ * Writes the data of several output buffers to a file descriptor (with 'writev' when available) and empties them
+ * @param fd     The file descriptor to write to (OUT_STDOUT or OUT_STDERR)
+ * @param outs   Array of pointers to the output buffers to write, in order
+ * @param count  The number of elements in the 'outs' array
+ */
+static void writeOutputs(int fd, OUTBUF* const* outs, int count) {
+    int i;
+#if defined(LINES_WRITEV)
+    struct iovec iov[OUT_MAXIOV]; ssize_t written; int n, first;
+    for (i=0; i<count; ) {
+        for (n=0; n<OUT_MAXIOV && i<count; ++i) {
+            if (outs[i]->size>0) { iov[n].iov_base = outs[i]->data; iov[n].iov_len = outs[i]->size; ++n; }
+        }
+        /* (the pipes can accept only a part of the data in each call) */
+        first=0; while (first<n) {
+            written = writev(fd, &iov[first], n-first);
+            if (written<0) { if (errno==EINTR) { continue; } break; }
+            while (first<n && (size_t)written>=iov[first].iov_len) { written -= (ssize_t)iov[first].iov_len; ++first; }
+            if (first<n) { iov[first].iov_base = (char*)iov[first].iov_base + written; iov[first].iov_len -= (size_t)written; }
+        }
+    }
+#else
+    for (i=0; i<count; ++i) { fwrite(outs[i]->data, sizeof(char), outs[i]->size, fd==OUT_STDERR ? stderr : stdout); }
+    fflush(fd==OUT_STDERR ? stderr : stdout);
+#endif
+    for (i=0; i<count; ++i) { outs[i]->size = 0; }
+}
+
+/**
+ * Writes the data of the output buffer to the standard output (used as 'flush' function)
+ */
+static void flushStdout(OUTBUF* out) { writeOutputs(OUT_STDOUT, &out, 1); }
+
+/**
+ * Writes the data of the output buffer to the standard error (used as 'flush' function)
+ */
+static void flushStderr(OUTBUF* out) { writeOutputs(OUT_STDERR, &out, 1); }
+
+/**
+ * Writes the data accumulated in the output buffer if possible (files processed in parallel wait for their turn)
+ */
+static void flushOutput(OUTBUF* out) {
+    assert( out!=NULL );
+    if (out->size>0 && out->flush) { out->flush(out); }
+}
+
+
 /*=================================================================================================================*/
 #pragma mark - > PRINTING
 
 /**
  * Prints the type of encoding used in the provided text file
  * @param textfile  The text file to examine (it should be already open with 'textfopen')
+ * @param out       The output buffer where the text is printed
  */
-static void printEncoding(TEXTFILE* textfile) {
-    const char *encoding, *eol;
+static void printEncoding(TEXTFILE* textfile, OUTBUF* out) {
+    const char *encoding="-", *eol="-";
     
     assert( textfile!=NULL );
     
@@ -98,6 +247,9 @@ static void printEncoding(TEXTFILE* textfile) {
         case TEXTF_ENCODING_UTF16_BE:      encoding = "UTF-16 BE"; break;
         case TEXTF_ENCODING_UTF16_LE_BOM:  encoding = "UTF-16 LE with BOM"; break;
         case TEXTF_ENCODING_UTF16_BE_BOM:  encoding = "UTF-16 BE with BOM"; break;
+        case TEXTF_ENCODING_WINDOWS1252:   encoding = "Windows-1252"; break;
+        case TEXTF_ENCODING_ISO8859_1:     encoding = "ISO-8859-1"; break;
+        case TEXTF_ENCODING_ISO8859_15:    encoding = "ISO-8859-15"; break;
         case TEXTF_ENCODING_BINARY:        encoding = "Binary"; break;
     }
     switch (textfile->eol) {
@@ -107,46 +259,384 @@ static void printEncoding(TEXTFILE* textfile) {
         case TEXTF_EOL_ACORNBBC:    eol = "Acorn BBC"; break;
         case TEXTF_EOL_UNKNOWN:     eol = "-"; break;
     }
-    printf("%s : %s\n", encoding, eol);
+    outString(out, encoding); outString(out, " : "); outString(out, eol); outWrite(out, "\n", 1);
+}
+
+/**
+ * Prints the performance counters collected while reading the provided text file
+ * @param textfile  The text file already read
+ * @param err       The output buffer where the counters are printed (it's written to the standard error)
+ */
+static void printStats(TEXTFILE* textfile, OUTBUF* err) {
+    TEXTF_STATS stats; char text[256];
+    assert( textfile!=NULL && err!=NULL );
+    
+    if (textfstats(textfile, &stats)!=0) { outString(err, "  << no performance counters, use 'lines-stats' >>\n"); return; }
+    sprintf(text, "  bytes read     : %ld (%ld refills, %ld bytes moved)\n", stats.bytesRead, stats.refills, stats.bytesMoved);
+    outString(err, text);
+    sprintf(text, "  buffer         : %ld bytes peak (%ld growths)\n", stats.peakBufferSize, stats.bufferGrowths);
+    outString(err, text);
+    sprintf(text, "  lines          : %ld (longest %ld bytes)\n", stats.lineCount, stats.longestLine);
+    outString(err, text);
+    sprintf(text, "  detection time : %.6f s\n  refill time    : %.6f s\n  scan time      : %.6f s\n",
+            stats.detectTime, stats.refillTime, stats.scanTime);
+    outString(err, text);
+}
+
+/**
+ * Counts the lines of the provided text file and prints them with the number of end-of-lines of each style
+ * @param textfile  The text file to count (it should be already open with 'textfopen')
+ * @param out       The output buffer where the counts are printed
+ */
+static void printLineCount(TEXTFILE* textfile, OUTBUF* out) {
+    TEXTF_EOLCOUNTS counts; long lines;
+    assert( textfile!=NULL && out!=NULL );
+    
+    lines = textfcountlines(textfile, &counts);
+    outString(out, "  lines   : "); outNumber(out, lines, 0); outWrite(out, "\n", 1);
+    outString(out, "  Windows : "); outNumber(out, counts.crlf, 0); outString(out, " (\\r\\n)\n");
+    outString(out, "  Unix    : "); outNumber(out, counts.lf,   0); outString(out, " (\\n)\n");
+    outString(out, "  Mac     : "); outNumber(out, counts.cr,   0); outString(out, " (\\r)\n");
+    outString(out, "  Acorn   : "); outNumber(out, counts.lfcr, 0); outString(out, " (\\n\\r)\n");
+}
+
+/** Conditions used by the 'textfparallel' callbacks to select and print the lines */
+typedef struct LINEFILTER {
+    OUTBUF*             out;
+    int                 printNumbers;
+    int                 firstLine;
+    int                 lastLine;
+    const TEXTF_SEARCH* search;
+} LINEFILTER;
+
+/**
+ * Returns TRUE if the line should be printed (called concurrently by 'textfparallel')
+ */
+static int filterLine(void* lineFilter, const char* line, size_t length, long lineNumber) {
+    const LINEFILTER* filter = (const LINEFILTER*)lineFilter;
+    return shouldPrint(lineNumber,line,length,filter->firstLine,filter->lastLine,filter->search);
+}
+
+/**
+ * Prints a line selected by 'filterLine' (called by 'textfparallel' in file order)
+ */
+static int printLine(void* lineFilter, const char* line, size_t length, long lineNumber) {
+    const LINEFILTER* filter = (const LINEFILTER*)lineFilter;
+    if (filter->printNumbers) { outNumber(filter->out, lineNumber, 3); outWrite(filter->out, "| ", 2); }
+    else                      { outWrite(filter->out, "| ", 2);                                        }
+    outWrite(filter->out, line, length); outWrite(filter->out, "\n", 1);
+    return 1;
+}
+
+/**
+ * Prints the last lines of a file that can't be read backward (pipes, terminals, ...)
+ * (the whole file is read keeping a copy of the last lines, so their absolute numbers are known)
+ * @param textfile   The text file to print (it should be already open with 'textfopen')
+ * @param filter     The conditions used to select and print the lines
+ * @param lineCount  The number of lines to print
+ */
+static void printLastLines(TEXTFILE* textfile, LINEFILTER* filter, int lineCount) {
+    char** lines; size_t* lengths; const char* line; size_t length; long count=0, i;
+    assert( textfile!=NULL && filter!=NULL && lineCount>0 );
+    
+    lines   = calloc(lineCount, sizeof(char*));
+    lengths = calloc(lineCount, sizeof(size_t));
+    if (!lines || !lengths) { free(lines); free(lengths); outString(filter->out, "  << out of memory >>\n"); return; }
+    while ((line=textfgetline_n(textfile, &length))!=NULL) {
+        i = count++ % lineCount;
+        free(lines[i]);
+        lines[i] = malloc(length+1);
+        if (!lines[i]) { count=-1; break; }
+        memcpy(lines[i], line, length); lengths[i] = length;
+    }
+    if (count<0) { outString(filter->out, "  << out of memory >>\n"); count=0; }
+    for (i=(count>lineCount ? count-lineCount : 0); i<count; ++i) {
+        line = lines[i%lineCount]; length = lengths[i%lineCount];
+        if (filter->search && !textfsearch_find(filter->search, line, length, NULL)) { continue; }
+        printLine(filter, line, length, i+1);
+    }
+    for (i=0; i<lineCount; ++i) { free(lines[i]); }
+    free(lengths);
+    free(lines);
+}
+
+/**
+ * Returns the value to add to 'textfile->lineNumber' to number the lines from 1 after a call to 'textfseektail'
+ * (the tail is numbered from the end, -1 = last line, so the lines of the whole file are counted and the read position
+ * is moved back to the tail)
+ * @param textfile  The text file, its read position must be at the beginning of the tail
+ * @param start     The position of the beginning of the file, returned by 'textftell' before moving to the tail
+ * @returns         The value to add to the line numbers or -1 if the lines of the file can't be counted
+ */
+static long tailNumberOffset(TEXTFILE* textfile, const TEXTF_POS* start) {
+    TEXTF_POS tail; long total;
+    assert( textfile!=NULL && start!=NULL );
+    
+    if (textfile->lineNumber>=0) { return 0; }
+    if (textftell(textfile, &tail)!=0 || textfseek(textfile, start)!=0) { return -1; }
+    total = textfcountlines(textfile, NULL);
+    if (textfseek(textfile, &tail)!=0) { return -1; }
+    return total + 1;
+}
+
+/**
+ * Moves the read position to the last lines of a file, the lines that can't be reached backward are printed here
+ * @param textfile   The text file to print (it should be already open with 'textfopen')
+ * @param filter     The conditions used to select and print the lines (the numbers are removed if they're unknown)
+ * @param lineCount  The number of lines to print
+ * @returns          The value to add to 'textfile->lineNumber' to print the number of the next lines
+ */
+static long seekTail(TEXTFILE* textfile, LINEFILTER* filter, int lineCount) {
+    TEXTF_POS start; long offset=0;
+    assert( textfile!=NULL && filter!=NULL && lineCount>0 );
+    
+    if (textftell(textfile, &start)!=0 || textfseektail(textfile, lineCount)!=0) {
+        printLastLines(textfile, filter, lineCount);
+    }
+    else if (filter->printNumbers && (offset=tailNumberOffset(textfile, &start))<0) {
+        filter->printNumbers = 0; offset = 0;
+    }
+    return offset;
 }
 
 /**
  * Reads a file and prints all lines of text that matches the provided condition
- * @param filename      The path to the file to print
+ * @param filename      The path to the file to print ("-" = standard input)
  * @param printNumbers  TRUE if line numbers must be printed in each line of text
  * @param firstLine     The number of the first line to prinet (0 = print from the begin of the file)
  * @param lastLine      The number of the last line to print (0 = print until the end of the file)
- * @param textToFind    The text that the line must contain to be printed (NULL = print all lines)
+ * @param search        The words that the line must contain to be printed (NULL = print all lines)
+ * @param jobs          The number of threads used to search the text (1 = search sequentially)
+ * @param tailCount     The number of lines to print from the end of the file (0 = print from the begin of the file)
+ * @param follow        TRUE to keep printing the lines appended to the file (it never returns unless the file is a pipe)
+ * @param countLines    TRUE to print only the number of lines (and of end-of-lines of each style) instead of the lines
+ * @param printCounters TRUE to print the performance counters after reading the file
+ * @param out           The output buffer where the lines are printed
+ * @param err           The output buffer where the performance counters are printed
  */
-static void printLinesOfText(const char* filename, int printNumbers,
-                             int firstLine, int lastLine, const char* textToFind) {
-    TEXTFILE* textfile; int lineNumber; const char* line;
+static void printLinesOfText(const char* filename, int printNumbers, int firstLine, int lastLine,
+                             const TEXTF_SEARCH* search, int jobs, int tailCount, int follow, int countLines,
+                             int printCounters, OUTBUF* out, OUTBUF* err) {
+    TEXTFILE* textfile; int lineNumber; const char* line; size_t length;
+    LINEFILTER filter; long numberOffset=0;
     assert( filename!=NULL );
     
-    textfile = textfopen(filename, "r");
+    textfile = strcmp(filename,"-")==0 ? textfopen_stream(stdin) : textfopen(filename, follow ? "rf" : (jobs>1 || countLines) ? "rm" : "r");
     if (textfile==NULL) { return; }
     
-    printf("%s : ",filename);
-    printEncoding(textfile);
-    if (textfissupported(textfile)) {
-        lineNumber=1; do
-        {
-            line = textfgetline(textfile);
-            if ( shouldPrint(lineNumber,line,firstLine,lastLine,textToFind) ) {
-                if (printNumbers) { printf("%3d| %s\n", lineNumber, line); }
-                else              { printf("| %s\n", line);                }
+    outString(out, filename); outString(out, " : ");
+    printEncoding(textfile, out);
+    filter.out          = out;
+    filter.printNumbers = printNumbers;
+    filter.firstLine    = firstLine;
+    filter.lastLine     = lastLine;
+    filter.search       = search;
+    if (textfissupported(textfile) && countLines) {
+        /* the end-of-lines are counted over the whole data, the lines aren't read one by one */
+        printLineCount(textfile, out);
+    }
+    else if (textfissupported(textfile) && follow) {
+        /* print the lines as they are appended to the file, waiting for them when the end of the file is reached */
+        if (tailCount>0) { numberOffset = seekTail(textfile, &filter, tailCount); }
+        do {
+            while ((line=textfgetline_n(textfile, &length))!=NULL) {
+                if (search==NULL || textfsearch_find(search, line, length, NULL)) {
+                    printLine(&filter, line, length, textfile->lineNumber + numberOffset);
+                }
             }
-            ++lineNumber;
+            flushOutput(out);
+        }
+        while (textfwait(textfile, -1)>0);
+    }
+    else if (textfissupported(textfile) && tailCount>0) {
+        /* the file is scanned backward from its end (or read whole keeping the last lines if it can't be) */
+        numberOffset = seekTail(textfile, &filter, tailCount);
+        while ((line=textfgetline_n(textfile, &length))!=NULL) {
+            if (search==NULL || textfsearch_find(search, line, length, NULL)) {
+                printLine(&filter, line, length, textfile->lineNumber + numberOffset);
+            }
+        }
+    }
+    else if (textfissupported(textfile) && jobs>1 && search!=NULL) {
+        textfparallel(textfile, jobs, TEXTF_ORDERED, filterLine, printLine, &filter);
+    }
+    else if (textfissupported(textfile) && search!=NULL) {
+        /* the whole buffer is searched at once and only the lines containing the words are returned */
+        /* (nothing is printed when the range starts after the end of the file)                         */
+        if (firstLine<=1 || textfseekline(textfile, firstLine)==0) {
+            while ( (line=textfgetmatch(textfile, search, &length, NULL))!=NULL &&
+                    (lastLine<=0 || textfile->lineNumber<=lastLine) ) {
+                printLine(&filter, line, length, textfile->lineNumber);
+            }
+        }
+    }
+    else if (textfissupported(textfile)) {
+        /* jump directly to the first line of the range (using the line index) */
+        /* (nothing is printed when the range starts after the end of the file) */
+        lineNumber = firstLine>1 ? firstLine : 1;
+        if (firstLine<=1 || textfseekline(textfile, firstLine)==0) {
+            do {
+                line = textfgetline_n(textfile, &length);
+                if ( shouldPrint(lineNumber,line,length,firstLine,lastLine,search) ) {
+                    printLine(&filter, line, length, lineNumber);
+                }
+                ++lineNumber;
+            }
+            while (line!=NULL && (lastLine<=0 || lineNumber<=lastLine));
         }
-        while (line!=NULL);
     }
     else {
-        printf("  << not supported >>\n");
+        outString(out, "  << not supported >>\n");
     }
+    if (printCounters) { printStats(textfile, err); }
     textfclose(textfile);
 }
 
 
+/*=================================================================================================================*/
+#pragma mark - > PARALLEL FILES
+
+#if defined(LINES_THREADS)
+
+/** A file processed by the pool, its output is kept in memory until the output of the previous files is written */
+typedef struct FILEJOB {
+    const char*       filename;
+    OUTBUF            out;
+    OUTBUF            err;
+    int               index;
+    int               isDone;
+    struct FILEPOOL*  pool;
+} FILEJOB;
+
+/** Pool of threads that process several files at once (the output is written in the order of the files) */
+typedef struct FILEPOOL {
+    FILEJOB*            jobs;
+    int                 jobCount;
+    int                 nextJob;    /* < index of the next file to process                                  */
+    int                 nextWrite;  /* < index of the next file to write, the previous ones were written    */
+    pthread_mutex_t     mutex;
+    int                 printNumbers;
+    int                 firstLine;
+    int                 lastLine;
+    const TEXTF_SEARCH* search;
+    int                 tailCount;
+    int                 countLines;
+    int                 printCounters;
+} FILEPOOL;
+
+/**
+ * Writes the output of a file being processed only if all the previous files were written (used as 'flush' function)
+ * (otherwise the output keeps growing in memory and it's checked again when it grows OUT_FLUSHSIZE bytes more)
+ */
+static void flushJob(OUTBUF* out) {
+    FILEJOB* job = (FILEJOB*)out->owner; int isNext;
+    assert( job!=NULL );
+    
+    pthread_mutex_lock(&job->pool->mutex);
+    isNext = (job->pool->nextWrite==job->index);
+    pthread_mutex_unlock(&job->pool->mutex);
+    /* (nothing else is written until this file is done, so the data can be written without the lock) */
+    if (isNext) { writeOutputs(OUT_STDOUT, &out, 1); out->flushSize = OUT_FLUSHSIZE; }
+    else        { out->flushSize = out->size + OUT_FLUSHSIZE;                         }
+}
+
+/**
+ * Writes the output of all the files that are done and follow the last file written (the mutex must be locked)
+ * (the output of consecutive files is written with a single 'writev' call)
+ */
+static void writeDoneJobs(FILEPOOL* pool) {
+    OUTBUF* outs[OUT_MAXIOV]; FILEJOB* job; int count=0;
+    assert( pool!=NULL );
+    
+    while (pool->nextWrite<pool->jobCount && pool->jobs[pool->nextWrite].isDone) {
+        job = &pool->jobs[pool->nextWrite++];
+        outs[count++] = &job->out;
+        if (count==OUT_MAXIOV || job->err.size>0) {
+            writeOutputs(OUT_STDOUT, outs, count);
+            while (count>0) { freeOutput(outs[--count]); }
+        }
+        if (job->err.size>0) { flushStderr(&job->err); }
+        freeOutput(&job->err);
+    }
+    if (count==0) { return; }
+    writeOutputs(OUT_STDOUT, outs, count);
+    while (count>0) { freeOutput(outs[--count]); }
+}
+
+/**
+ * Processes files until all of them are taken (this function is executed by each thread of the pool)
+ */
+static void* processFiles(void* pool_) {
+    FILEPOOL* pool = (FILEPOOL*)pool_; FILEJOB* job; int index;
+    assert( pool!=NULL );
+    
+    for (;;) {
+        pthread_mutex_lock(&pool->mutex);
+        index = pool->nextJob++;
+        pthread_mutex_unlock(&pool->mutex);
+        if (index>=pool->jobCount) { break; }
+        
+        job = &pool->jobs[index];
+        printLinesOfText(job->filename, pool->printNumbers, pool->firstLine, pool->lastLine, pool->search,
+                         1, pool->tailCount, 0, pool->countLines, pool->printCounters, &job->out, &job->err);
+        outWrite(&job->out, "\n", 1);
+        
+        pthread_mutex_lock(&pool->mutex);
+        job->isDone = 1;
+        writeDoneJobs(pool);
+        pthread_mutex_unlock(&pool->mutex);
+    }
+    return NULL;
+}
+
+/**
+ * Prints several files at once using a pool of threads, the output is the same than printing them one by one
+ * @param files      Array with the paths to the files to print
+ * @param fileCount  The number of elements in the 'files' array
+ * @param jobs       The number of threads to use (including the calling thread)
+ * (the rest of parameters are the same than in 'printLinesOfText')
+ */
+static void printFilesInParallel(const char** files, int fileCount, int jobs, int printNumbers, int firstLine,
+                                 int lastLine, const TEXTF_SEARCH* search, int tailCount, int countLines,
+                                 int printCounters) {
+    FILEPOOL pool; pthread_t* threads; int i;
+    assert( files!=NULL && jobs>1 );
+    
+    pool.jobs          = malloc(fileCount * sizeof(FILEJOB));
+    pool.jobCount      = fileCount;
+    pool.nextJob       = 0;
+    pool.nextWrite     = 0;
+    pool.printNumbers  = printNumbers;
+    pool.firstLine     = firstLine;
+    pool.lastLine      = lastLine;
+    pool.search        = search;
+    pool.tailCount     = tailCount;
+    pool.countLines    = countLines;
+    pool.printCounters = printCounters;
+    pthread_mutex_init(&pool.mutex, NULL);
+    for (i=0; i<fileCount; ++i) {
+        pool.jobs[i].filename = files[i];
+        pool.jobs[i].index    = i;
+        pool.jobs[i].isDone   = 0;
+        pool.jobs[i].pool     = &pool;
+        initOutput(&pool.jobs[i].out, flushJob, &pool.jobs[i]);
+        initOutput(&pool.jobs[i].err, NULL, NULL);
+    }
+    if (jobs>fileCount) { jobs = fileCount; }
+    threads = malloc(jobs * sizeof(pthread_t));
+    for (i=1; i<jobs; ++i) {
+        if (pthread_create(&threads[i], NULL, processFiles, &pool)!=0) { break; }
+    }
+    processFiles(&pool);
+    while (--i>0) { pthread_join(threads[i], NULL); }
+    pthread_mutex_destroy(&pool.mutex);
+    free(threads);
+    free(pool.jobs);
+}
+
+#endif /* if defined(LINES_THREADS) */
+
+
 /*=================================================================================================================*/
 #pragma mark - > MAIN
 
@@ -161,31 +651,49 @@ static void printLinesOfText(const char* filename, int printNumbers,
  * @param argv  An array containing each command-line parameter (starting at argv[1])
  */
 int main(int argc, char *argv[]) {
-    const char **files; int fileCount;
-    const char *textToFind=NULL, *param; int i;
-    int firstLine=0, lastLine=0, printNumbers=0;
+    const char **files, **words; int fileCount, wordCount;
+    const char *param; int i, first, stdinCount; TEXTF_SEARCH* search=NULL; OUTBUF out, err;
+    int firstLine=0, lastLine=0, printNumbers=0, jobs=1, searchFlags=0, tailCount=0, follow=0, countLines=0;
+    int printCounters=0;
     int printHelpAndExit=0, printVersionAndExit=0;
     const char *help[] = {
         "USAGE: lines [options] file1.txt file2.txt ...","",
+        "  Use '-' as file name to read the standard input.","",
         "  OPTIONS:",
-        "    -n, --number           number the lines, starting at 1"
+        "    -n, --number           number the lines, starting at 1",
         "    -r, --ranges <a>:<b>   print only lines in the provided range, ex: --range 4:16",
         "    -s, --search <word>    print only lines that contain the provided word, ex: --search dog",
+        "                           (can be repeated to print the lines containing any of the words)",
+        "    -i, --ignore-case      ignore the case of the ASCII letters when searching",
+        "    -j, --jobs <n>         search using <n> threads, ex: --search dog --jobs 8",
+        "                           (with several files, <n> files are read at once)",
+        "    -t, --tail <n>         print only the last <n> lines, ex: --tail 10",
+        "    -f, --follow           keep printing the lines appended to the last file, ex: --follow --tail 10",
+        "    -c, --count            print only the number of lines and of end-of-lines of each style",
+        "        --stats            print the performance counters of each file (to the standard error)",
+        "                           (they are collected only by 'lines-stats', a build for profiling)",
         "    -h, --help             display this help and exit",
         "    -v, --version          output version information and exit",
         NULL
     };
     
     files = malloc(argc * sizeof(char*));
+    words = malloc(argc * sizeof(char*));
 
     /* process all flags & options */
-    fileCount=0;
+    fileCount=0; wordCount=0;
     for (i=1; i<argc; ++i) { param=argv[i];
-        if ( param[0]!='-' ) { files[fileCount++]=param; }
+        if ( param[0]!='-' || param[1]=='\0' ) { files[fileCount++]=param; }
         else {
             if      ( isOption(param,"-n","--number" ) ) { printNumbers=1;                               }
             else if ( isOption(param,"-r","--range"  ) ) { readRange(&firstLine,&lastLine,argc,argv,&i); }
-            else if ( isOption(param,"-s","--search" ) ) { ++i; textToFind=(i<argc ? argv[i] :  NULL);   }
+            else if ( isOption(param,"-s","--search" ) ) { ++i; if (i<argc) { words[wordCount++]=argv[i]; } }
+            else if ( isOption(param,"-i","--ignore-case") ) { searchFlags=TEXTF_SEARCH_IGNORECASE;      }
+            else if ( isOption(param,"-j","--jobs"   ) ) { ++i; jobs=(i<argc ? atoi(argv[i]) : 1);       }
+            else if ( isOption(param,"-t","--tail"   ) ) { ++i; tailCount=(i<argc ? atoi(argv[i]) : 0);  }
+            else if ( isOption(param,"-f","--follow" ) ) { follow=1;                                     }
+            else if ( isOption(param,"-c","--count"  ) ) { countLines=1;                                 }
+            else if ( strcmp(param,"--stats")==0       ) { printCounters=1;                              }
             else if ( isOption(param,"-h","--help")    ) { printHelpAndExit=1;                           }
             else if ( isOption(param,"-v","--version") ) { printVersionAndExit=1;                        }
         }
@@ -195,11 +703,40 @@ int main(int argc, char *argv[]) {
     if ( printHelpAndExit    ) { i=0; while (help[i]!=NULL) { printf("%s\n",help[i++]); } return 0; }
     if ( printVersionAndExit ) { printf("LINES version %s\n%s\n", VERSION, COPYRIGHT);    return 0; }
     
-    /* print all requested files */
-    for (i=0; i<fileCount; ++i) {
-        printLinesOfText(files[i],printNumbers,firstLine,lastLine,textToFind);
-        printf("\n");
+    /* the lines are counted up to the current end of the files (they aren't followed) */
+    if (countLines) { follow=0; }
+    
+    /* prepare the search of all the provided words at once */
+    if (wordCount>0) {
+        search = textfsearch_new(words, wordCount, searchFlags);
+        if (!search) { fprintf(stderr, "lines: the searched words can't contain end-of-line characters\n"); return 1; }
+    }
+    
+    /* print all requested files (several files are read at once by a pool of threads, except the followed file) */
+    first=0;
+#if defined(LINES_THREADS)
+    for (i=0, stdinCount=0; i<fileCount; ++i) { if (strcmp(files[i],"-")==0) { ++stdinCount; } }
+    if (jobs>1 && (fileCount-follow)>1 && stdinCount<=1) {
+        printFilesInParallel(files, fileCount-follow, jobs, printNumbers, firstLine, lastLine, search, tailCount,
+                             countLines, printCounters);
+        first = fileCount-follow;
+    }
+#else
+    (void)stdinCount;
+#endif
+    initOutput(&out, flushStdout, NULL);
+    initOutput(&err, flushStderr, NULL);
+    for (i=first; i<fileCount; ++i) {
+        printLinesOfText(files[i],printNumbers,firstLine,lastLine,search,jobs,tailCount,follow && i==fileCount-1,
+                         countLines,printCounters,&out,&err);
+        outWrite(&out, "\n", 1);
+        flushOutput(&out);
+        flushOutput(&err);
     }
+    freeOutput(&out);
+    freeOutput(&err);
+    textfsearch_free(search);
+    free(words);
     free(files);
     return 0;
 }
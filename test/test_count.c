@@ -0,0 +1,149 @@
+/**
+ * @file       test_count.c
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  Checks textfcountlines: the number of lines and of end-of-lines of each
+ *  style are the ones found reading the lines one by one
+ * -------------------------------------------------------------------------
+ */
+
+/* includes the 'textfile.h' library and its implementation */
+#define TEXTFILE_IMPLEMENTATION
+#include "../textfile.h"
+#include "testing.h"
+
+#define MAX_TEXT 8192
+
+/**
+ * Counts the end-of-lines of a text following the rules of the library (reference implementation)
+ * @returns the number of lines
+ */
+static long countEols(const unsigned char* text, size_t size, size_t unitSize, TEXTF_EOLCOUNTS* counts) {
+    size_t i; int c, next;
+    memset(counts, 0, sizeof(TEXTF_EOLCOUNTS));
+    for (i=0; i<size; i+=unitSize) {
+        c    = text[i];
+        next = (i+unitSize)<size ? text[i+unitSize] : 0;
+        if      (c=='\r' && next=='\n') { ++counts->crlf; i+=unitSize; }
+        else if (c=='\n' && next=='\r') { ++counts->lfcr; i+=unitSize; }
+        else if (c=='\r')               { ++counts->cr;                }
+        else if (c=='\n')               { ++counts->lf;                }
+    }
+    return counts->cr + counts->crlf + counts->lf + counts->lfcr + 1;
+}
+
+/**
+ * Returns the offset of the beginning of a line (the lines are numbered from 0)
+ */
+static size_t lineOffset(const unsigned char* text, size_t size, size_t unitSize, long line) {
+    size_t i=0;
+    while (line>0 && i<size) {
+        if (text[i]=='\r' || text[i]=='\n') {
+            if ((i+unitSize)<size && (text[i+unitSize]=='\r' || text[i+unitSize]=='\n') && text[i+unitSize]!=text[i]) {
+                i += unitSize;
+            }
+            --line;
+        }
+        i += unitSize;
+    }
+    return i;
+}
+
+/**
+ * Counts the lines of a file after skipping some of them and compares the counts with the reference
+ */
+static void checkCount(TEXTFILE* textfile, const unsigned char* text, size_t size, size_t unitSize, long skip) {
+    TEXTF_EOLCOUNTS counts, expected; long lines, totalLines, expectedLines, i; size_t length, offset;
+    if (!CHECK(textfile!=NULL)) { return; }
+    for (i=0; i<skip && textfgetline_n(textfile, &length)!=NULL; ++i) { }
+    totalLines = countEols(text, size, unitSize, &expected);
+    if (skip>totalLines) { skip = totalLines; }
+    offset        = lineOffset(text, size, unitSize, skip);
+    expectedLines = skip<totalLines ? countEols(&text[offset], size-offset, unitSize, &expected) : 0;
+    if (expectedLines==0) { memset(&expected, 0, sizeof(expected)); }
+    lines = textfcountlines(textfile, &counts);
+    CHECK_LONG(lines, expectedLines);
+    CHECK_LONG(counts.cr,   expected.cr);
+    CHECK_LONG(counts.crlf, expected.crlf);
+    CHECK_LONG(counts.lf,   expected.lf);
+    CHECK_LONG(counts.lfcr, expected.lfcr);
+    CHECK_LONG(textfile->lineNumber, skip+expectedLines);
+    CHECK(textfgetline_n(textfile, &length)==NULL);
+    CHECK_LONG(textfcountlines(textfile, NULL), 0);
+    textfclose(textfile);
+}
+
+/**
+ * Writes a text with random lengths and end-of-lines (Windows-1252 when 'isLegacy' is TRUE)
+ * @returns the size of the text in bytes
+ */
+static size_t randomText(unsigned char* text, size_t maxSize, unsigned long seed, int isLegacy) {
+    static const char* const eols[] = { "\n", "\r\n", "\r", "\n\r", "\n\n", "\r\r", "\r\n\r" };
+    size_t size=0; int length;
+    while (size<(maxSize-64)) {
+        seed   = seed*1103515245ul + 12345ul;
+        length = (int)((seed>>16) % 48);
+        while (length-->0) {
+            seed = seed*1103515245ul + 12345ul;
+            text[size++] = (unsigned char)(isLegacy && (seed>>16)%13==0 ? 0x93 : 'a' + (seed>>16)%26);
+        }
+        seed = seed*1103515245ul + 12345ul;
+        strcpy((char*)&text[size], eols[(seed>>16)%7]); size += strlen((char*)&text[size]);
+    }
+    return size;
+}
+
+int main(void) {
+    static const long skips[] = { 0, 1, 5, 1000000 };
+    static unsigned char text[MAX_TEXT], utf16[2*MAX_TEXT+2];
+    char path[256]; TEXTF_OPTIONS options; TEXTF_EOLCOUNTS counts; TEXTFILE* textfile;
+    size_t size, i; unsigned long seed; int isLegacy, s;
+
+    /* each end-of-line style is counted apart, a file without end-of-lines has one line */
+    textfile = textfopen_mem("a\rb\rc", 5);
+    CHECK_LONG(textfcountlines(textfile, &counts), 3); CHECK_LONG(counts.cr, 2);   textfclose(textfile);
+    textfile = textfopen_mem("a\r\nb\r\n", 6);
+    CHECK_LONG(textfcountlines(textfile, &counts), 3); CHECK_LONG(counts.crlf, 2); textfclose(textfile);
+    textfile = textfopen_mem("a\nb\nc", 5);
+    CHECK_LONG(textfcountlines(textfile, &counts), 3); CHECK_LONG(counts.lf, 2);   textfclose(textfile);
+    textfile = textfopen_mem("a\n\rb\n\r", 6);
+    CHECK_LONG(textfcountlines(textfile, &counts), 3); CHECK_LONG(counts.lfcr, 2); textfclose(textfile);
+    textfile = textfopen_mem("abc", 3);
+    CHECK_LONG(textfcountlines(textfile, &counts), 1); CHECK_LONG(counts.cr+counts.crlf+counts.lf+counts.lfcr, 0);
+    textfclose(textfile);
+
+    for (seed=1; seed<=12; ++seed) {
+        for (isLegacy=0; isLegacy<=1; ++isLegacy) {
+            size = randomText(text, (seed*997)%MAX_TEXT + 64, seed, isLegacy);
+            testWriteFile(path, "count.txt", text, size);
+            for (s=0; s<(int)(sizeof(skips)/sizeof(skips[0])); ++s) {
+                /* the fast paths: mapped file, buffered file and text in memory */
+                checkCount(textfopen(path, "rm"), text, size, 1, skips[s]);
+                memset(&options, 0, sizeof(options));
+                options.blockSize = 16;
+                checkCount(textfopen_ex(path, "r", &options), text, size, 1, skips[s]);
+                checkCount(textfopen_mem(text, size), text, size, 1, skips[s]);
+                /* the slow path (the lines are read one by one while they are validated) */
+                if (!isLegacy) {
+                    memset(&options, 0, sizeof(options));
+                    options.validate = TEXTF_VALIDATE_REPORT;
+                    checkCount(textfopen_ex(path, "r", &options), text, size, 1, skips[s]);
+                }
+            }
+            /* the same text in UTF-16 LE (the end-of-lines are counted over the decoded text) */
+            if (!isLegacy) {
+                utf16[0] = 0xFF; utf16[1] = 0xFE;
+                for (i=0; i<size; ++i) { utf16[2+2*i] = text[i]; utf16[3+2*i] = 0; }
+                testWriteFile(path, "count16.txt", utf16, 2+2*size);
+                for (s=0; s<(int)(sizeof(skips)/sizeof(skips[0])); ++s) {
+                    checkCount(textfopen(path, "rm"), &utf16[2], 2*size, 2, skips[s]);
+                    checkCount(textfopen(path, "r"),  &utf16[2], 2*size, 2, skips[s]);
+                }
+            }
+        }
+    }
+    return testResult("count");
+}
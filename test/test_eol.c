@@ -0,0 +1,105 @@
+/**
+ * @file       test_eol.c
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  Checks the end-of-line scanner, specially the pairs "\r\n" and "\n\r"
+ *  split across two refills of the buffer
+ * -------------------------------------------------------------------------
+ */
+
+/* includes the 'textfile.h' library and its implementation */
+#define TEXTFILE_IMPLEMENTATION
+#include "../textfile.h"
+#include "testing.h"
+
+#define MAX_TEXT  1024
+#define MAX_LINES 256
+
+/** Texts mixing every end-of-line (the pairs are taken greedily from the left) */
+static const char* const texts[] = {
+    "one\r\ntwo\r\nthree\r\n",
+    "one\n\rtwo\n\rthree",
+    "one\r\r\ntwo\n\n\rthree\r\n\r\n",
+    "a long line that fills a whole SIMD block and more\r\nanother long line that fills a block\r\n\r\nend",
+    "\r\n\n\r\r\n\n\r\r\r\n\n",
+    "mixed\rold mac\nunix\r\nwindows\n\racorn\r\n"
+};
+
+/** Options used to read the texts, the small blocks place the pairs at every position of a refill */
+static const int blockSizes[]  = { 16, 16, 17, 0  };
+static const int bufferSizes[] = { 16, 64, 0,  16 };
+
+/**
+ * Splits a text in lines following the rules of the library (reference implementation)
+ * @returns the number of lines, the text of each line is returned in 'lines' and 'lengths'
+ */
+static int splitLines(const char* text, size_t size, const char** lines, size_t* lengths) {
+    const char *ptr=text, *end=text+size, *line=text; int count=0;
+    while (ptr<end) {
+        if (*ptr=='\r' || *ptr=='\n') {
+            lines[count] = line; lengths[count] = (size_t)(ptr-line); ++count;
+            if ((ptr+1)<end && (ptr[1]=='\r' || ptr[1]=='\n') && ptr[1]!=ptr[0]) { ++ptr; }
+            line = ++ptr;
+        }
+        else { ++ptr; }
+    }
+    lines[count] = line; lengths[count] = (size_t)(end-line); ++count;
+    return count;
+}
+
+/**
+ * Reads a file line by line and checks that the lines are the ones of the reference implementation
+ */
+static void checkLines(TEXTFILE* textfile, const char* text, size_t size) {
+    const char* expected[MAX_LINES]; size_t expectedLengths[MAX_LINES];
+    const char* line; size_t length; int count, i;
+
+    count = splitLines(text, size, expected, expectedLengths);
+    if (!CHECK(textfile!=NULL)) { return; }
+    for (i=0; i<count && (line=textfgetline_n(textfile, &length))!=NULL; ++i) {
+        if (!CHECK(length==expectedLengths[i] && memcmp(line, expected[i], length)==0)) {
+            fprintf(stderr, "  line %d of \"%.*s\"\n", i+1, (int)size, text);
+            break;
+        }
+    }
+    CHECK_LONG(i, count);
+    CHECK(textfgetline_n(textfile, &length)==NULL);
+    CHECK_LONG(textfile->lineNumber, count);
+}
+
+int main(void) {
+    char text[MAX_TEXT], path[256]; TEXTF_OPTIONS options; TEXTFILE* textfile;
+    size_t t, o, padding, size;
+
+    /* every text is moved (adding a prefix) so that each end-of-line lands at each position of a refill */
+    for (t=0; t<sizeof(texts)/sizeof(texts[0]); ++t) {
+        for (padding=0; padding<40; ++padding) {
+            memset(text, 'x', padding);
+            strcpy(&text[padding], texts[t]);
+            size = strlen(text);
+            for (o=0; o<sizeof(blockSizes)/sizeof(blockSizes[0]); ++o) {
+                memset(&options, 0, sizeof(options));
+                options.blockSize  = blockSizes[o];
+                options.bufferSize = bufferSizes[o];
+                textfile = textfopen_ex(testWriteFile(path, "eol.txt", text, size), "r", &options);
+                checkLines(textfile, text, size);
+                if (textfile) { textfclose(textfile); }
+            }
+            textfile = textfopen_mem(text, size);
+            checkLines(textfile, text, size);
+            if (textfile) { textfclose(textfile); }
+        }
+    }
+
+    /* the end-of-line format is the most frequent end-of-line at the beginning of the file */
+    textfile = textfopen_mem("a\r\nb\r\nc\n", 9);   CHECK_LONG(textfile->eol, TEXTF_EOL_WINDOWS);    textfclose(textfile);
+    textfile = textfopen_mem("a\nb\nc\r\n", 7);      CHECK_LONG(textfile->eol, TEXTF_EOL_UNIX);       textfclose(textfile);
+    textfile = textfopen_mem("a\rb\rc", 5);          CHECK_LONG(textfile->eol, TEXTF_EOL_CLASSICMAC); textfclose(textfile);
+    textfile = textfopen_mem("a\n\rb\n\rc", 7);      CHECK_LONG(textfile->eol, TEXTF_EOL_ACORNBBC);   textfclose(textfile);
+    textfile = textfopen_mem("abc", 3);              CHECK_LONG(textfile->eol, TEXTF_EOL_UNKNOWN);    textfclose(textfile);
+
+    return testResult("eol");
+}
@@ -0,0 +1,168 @@
+/**
+ * @file       test_follow.c
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  Checks the follow mode ("rf"): the lines appended in pieces are returned
+ *  once complete, textfwait reports the growth, the truncation and the
+ *  replacement of the file, and the files that can't be followed
+ * -------------------------------------------------------------------------
+ */
+
+/* pipe() and rename() of the followed file are POSIX extensions */
+#define _XOPEN_SOURCE 700
+
+/* includes the 'textfile.h' library and its implementation */
+#define TEXTFILE_IMPLEMENTATION
+#include "../textfile.h"
+#include "testing.h"
+
+#include <unistd.h>
+
+#define MAX_TEXT (16*1024)
+
+/**
+ * Appends data to the end of a file
+ */
+static void appendFile(const char* path, const void* data, size_t size) {
+    FILE* file = fopen(path, "ab");
+    if (!file) { fprintf(stderr, "can't write the file '%s'\n", path); exit(2); }
+    fwrite(data, 1, size, file);
+    fclose(file);
+}
+
+/**
+ * Reads the next line and checks its text and number (NULL = no complete line is available yet)
+ */
+static int checkNext(TEXTFILE* textfile, const char* expected, long lineNumber) {
+    const char* line; size_t length;
+    line = textfgetline_n(textfile, &length);
+    if (!expected) { return CHECK(line==NULL); }
+    return CHECK_TEXT(line, length, expected) && CHECK_LONG(textfile->lineNumber, lineNumber);
+}
+
+/**
+ * Appends a text in pieces of the provided size, reading the complete lines after each piece, and checks that they are
+ * the lines of the whole text (except the last one, that is still incomplete)
+ */
+static void checkPieces(const char* text, size_t size, size_t pieceSize, TEXTF_OPTIONS* options, int isUtf16) {
+    char path[256]; TEXTFILE *textfile, *expected; const char *line, *expectedLine; size_t length, expectedLength, pos;
+    testWriteFile(path, "follow.txt", text, isUtf16 ? 2 : 0);
+    textfile = textfopen_ex(path, "rf", options);
+    expected = textfopen_mem(text, size);
+    if (!CHECK(textfile!=NULL && expected!=NULL)) { textfclose(textfile); textfclose(expected); return; }
+    CHECK(textfile->isFollowing);
+    expectedLine = textfgetline_n(expected, &expectedLength);
+    for (pos=isUtf16 ? 2 : 0; pos<size; pos+=pieceSize) {
+        appendFile(path, &text[pos], (pos+pieceSize)<size ? pieceSize : size-pos);
+        CHECK_LONG(textfwait(textfile, 0), 1);
+        while ((line=textfgetline_n(textfile, &length))!=NULL) {
+            if (!CHECK(expectedLine!=NULL && length==expectedLength && memcmp(line, expectedLine, length)==0)) {
+                fprintf(stderr, "  line %ld (pieces of %d bytes)\n", expected->lineNumber, (int)pieceSize);
+                textfclose(textfile); textfclose(expected); return;
+            }
+            CHECK_LONG(textfile->lineNumber, expected->lineNumber);
+            expectedLine = textfgetline_n(expected, &expectedLength);
+        }
+        CHECK_LONG(textfwait(textfile, 0), 0);
+    }
+    /* (the last line doesn't have end-of-line, it isn't returned until the end-of-line arrives) */
+    if (CHECK(expectedLine!=NULL)) { CHECK(textfgetline_n(expected, &expectedLength)==NULL); }
+    textfclose(textfile);
+    textfclose(expected);
+}
+
+/**
+ * Writes a text with lines of random lengths and mixed end-of-lines (UTF-16 LE with BOM when 'isUtf16' is TRUE)
+ * @returns the size of the text in bytes
+ */
+static size_t randomText(char* text, size_t maxSize, unsigned long seed, int isUtf16) {
+    static const char* const eols[] = { "\n", "\r\n", "\n", "\r" };
+    size_t size=0, unit=isUtf16 ? 2 : 1, i; int length; const char* eol;
+    if (isUtf16) { text[size++] = '\xFF'; text[size++] = '\xFE'; }
+    while (size<(maxSize-300)) {
+        seed   = seed*1103515245ul + 12345ul;
+        length = (int)((seed>>16) % ((seed>>8)%8==0 ? 200 : 30));
+        while (length-->0) {
+            seed = seed*1103515245ul + 12345ul;
+            text[size] = (char)('a' + (seed>>16)%26); if (isUtf16) { text[size+1] = 0; } size += unit;
+        }
+        seed = seed*1103515245ul + 12345ul;
+        for (eol=eols[(seed>>16)%4], i=0; eol[i]; ++i) {
+            text[size] = eol[i]; if (isUtf16) { text[size+1] = 0; } size += unit;
+        }
+    }
+    /* the last line without end-of-line */
+    text[size] = 'z'; if (isUtf16) { text[size+1] = 0; } size += unit;
+    return size;
+}
+
+int main(void) {
+    static const size_t pieceSizes[] = { 1, 3, 16, 1000 };
+    static char text[MAX_TEXT];
+    char path[256], oldPath[256]; TEXTF_OPTIONS options; TEXTFILE* textfile; size_t size, p; int isUtf16, fds[2];
+
+    /* the lines are returned when their end-of-line arrives ("\r" waits for a possible "\n") */
+    testWriteFile(path, "follow.txt", "one\ntw", 6);
+    textfile = textfopen(path, "rf");
+    if (CHECK(textfile!=NULL && textfile->isFollowing)) {
+        checkNext(textfile, "one", 1);
+        checkNext(textfile, NULL, 0);
+        CHECK_LONG(textfwait(textfile, 0), 0);
+        CHECK_LONG(textfwait(textfile, 50), 0);
+        appendFile(path, "o\nthree\r", 8);
+        CHECK_LONG(textfwait(textfile, 0), 1);
+        checkNext(textfile, "two", 2);
+        checkNext(textfile, "three", 3);
+        checkNext(textfile, NULL, 0);
+        appendFile(path, "\nfour\n", 6);
+        CHECK_LONG(textfwait(textfile, -1), 1);
+        checkNext(textfile, "four", 4);
+        checkNext(textfile, NULL, 0);
+
+        /* truncated -> it's read again from its beginning */
+        testWriteFile(path, "follow.txt", "new\n", 4);
+        CHECK_LONG(textfwait(textfile, 0), 1);
+        checkNext(textfile, "new", 1);
+        checkNext(textfile, NULL, 0);
+
+        /* replaced by a new file -> the rest of the old file, its incomplete line and then the lines of the new one */
+        appendFile(path, "last", 4);
+        sprintf(oldPath, "%.200s.old", path);
+        CHECK(rename(path, oldPath)==0);
+        testWriteFile(path, "follow.txt", "first\n", 6);
+        CHECK_LONG(textfwait(textfile, 0), 1);
+        checkNext(textfile, NULL, 0);
+        CHECK_LONG(textfwait(textfile, 0), 1);
+        checkNext(textfile, "last", 2);
+        CHECK_LONG(textfwait(textfile, 0), 1);
+        checkNext(textfile, "first", 1);
+        checkNext(textfile, NULL, 0);
+        textfclose(textfile);
+        remove(oldPath);
+    }
+
+    /* the text appended in pieces of several sizes, with several block sizes, in UTF-8 and UTF-16 */
+    for (isUtf16=0; isUtf16<=1; ++isUtf16) {
+        size = randomText(text, MAX_TEXT, 13+isUtf16, isUtf16);
+        for (p=0; p<sizeof(pieceSizes)/sizeof(pieceSizes[0]); ++p) {
+            memset(&options, 0, sizeof(options));
+            checkPieces(text, size, pieceSizes[p], &options, isUtf16);
+            options.blockSize = 16;
+            checkPieces(text, size, pieceSizes[p], &options, isUtf16);
+        }
+    }
+
+    /* the files that can't be followed */
+    textfile = textfopen(path, "r");
+    if (CHECK(textfile!=NULL)) { CHECK_LONG(textfwait(textfile, 0), -1); textfclose(textfile); }
+    if (CHECK(pipe(fds)==0)) {
+        close(fds[1]);
+        textfile = textfdopen(fds[0], "rf");
+        if (CHECK(textfile!=NULL)) { CHECK(!textfile->isFollowing); CHECK_LONG(textfwait(textfile, 0), -1); }
+        textfclose(textfile);
+    }
+    return testResult("follow");
+}
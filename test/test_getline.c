@@ -0,0 +1,75 @@
+/**
+ * @file       test_getline.c
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  Checks the length returned by textfgetline_n (lines containing '\0' and
+ *  lines longer than the buffer), textfgetline and textfgets
+ * -------------------------------------------------------------------------
+ */
+
+/* includes the 'textfile.h' library and its implementation */
+#define TEXTFILE_IMPLEMENTATION
+#include "../textfile.h"
+#include "testing.h"
+
+#define LONG_LINE 5000
+
+/**
+ * Checks the lines of a text containing '\0' characters and a line longer than the initial buffer
+ */
+static void checkLengths(TEXTFILE* textfile, const char* longLine) {
+    const char* line; size_t length;
+    if (!CHECK(textfile!=NULL)) { return; }
+    line = textfgetline_n(textfile, &length);
+    CHECK(line!=NULL && length==5 && memcmp(line, "a\0b\0c", 5)==0);
+    line = textfgetline_n(textfile, &length);
+    CHECK(line!=NULL && length==0);
+    line = textfgetline_n(textfile, &length);
+    CHECK(line!=NULL && length==LONG_LINE && memcmp(line, longLine, LONG_LINE)==0);
+    line = textfgetline_n(textfile, &length);
+    CHECK(line!=NULL && length==1 && line[0]=='\0');
+    CHECK(textfgetline_n(textfile, &length)==NULL);
+    CHECK_LONG(textfile->lineNumber, 4);
+    textfclose(textfile);
+}
+
+int main(void) {
+    static char text[LONG_LINE+32], longLine[LONG_LINE];
+    char path[256], buffer[8]; TEXTFILE* textfile; char* line; size_t i, size=0;
+
+    for (i=0; i<LONG_LINE; ++i) { longLine[i] = (i%100==99) ? '\0' : (char)('a' + i%26); }
+    memcpy(&text[size], "a\0b\0c\r\n\n", 8);  size += 8;
+    memcpy(&text[size], longLine, LONG_LINE); size += LONG_LINE;
+    memcpy(&text[size], "\n\0", 2);           size += 2;
+    testWriteFile(path, "getline.txt", text, size);
+
+    /* the length of the lines doesn't depend on '\0' characters (in every mode) */
+    checkLengths(textfopen(path, "r"),  longLine);
+    checkLengths(textfopen(path, "rm"), longLine);
+    checkLengths(textfopen_mem(text, size), longLine);
+
+    /* textfgetline returns null-terminated lines */
+    textfile = textfopen(testWriteFile(path, "getline.txt", "one\r\ntwo\n\nthree", 15), "r");
+    if (CHECK(textfile!=NULL)) {
+        line = textfgetline(textfile); CHECK(line!=NULL && strcmp(line, "one")==0);
+        line = textfgetline(textfile); CHECK(line!=NULL && strcmp(line, "two")==0);
+        line = textfgetline(textfile); CHECK(line!=NULL && strcmp(line, "")==0);
+        line = textfgetline(textfile); CHECK(line!=NULL && strcmp(line, "three")==0);
+        CHECK(textfgetline(textfile)==NULL);
+        textfclose(textfile);
+    }
+
+    /* textfgets ends each line with '\n' and cuts the lines that don't fit in the buffer */
+    textfile = textfopen(testWriteFile(path, "getline.txt", "abcdefghij\r\nxy\rz", 16), "r");
+    if (CHECK(textfile!=NULL)) {
+        CHECK(textfgets(buffer, sizeof(buffer), textfile)==buffer && strcmp(buffer, "abcdef\n")==0);
+        CHECK(textfgets(buffer, sizeof(buffer), textfile)==buffer && strcmp(buffer, "xy\n")==0);
+        CHECK(textfgets(buffer, sizeof(buffer), textfile)==buffer && strcmp(buffer, "z\n")==0);
+        CHECK(textfgets(buffer, sizeof(buffer), textfile)==NULL);
+        textfclose(textfile);
+    }
+    return testResult("getline");
+}
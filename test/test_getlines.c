@@ -0,0 +1,120 @@
+/**
+ * @file       test_getlines.c
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  Checks textfgetlines: the batches contain the same lines returned by
+ *  textfgetline_n, and every line of a batch stays valid until the next
+ *  call (also with small buffers, long lines and validation)
+ * -------------------------------------------------------------------------
+ */
+
+/* includes the 'textfile.h' library and its implementation */
+#define TEXTFILE_IMPLEMENTATION
+#include "../textfile.h"
+#include "testing.h"
+
+#define MAX_TEXT  (16*1024)
+#define MAX_SPANS 64
+
+/**
+ * Reads a file in batches and compares every line of each batch with the lines read one by one
+ * @returns the largest batch returned
+ */
+static int checkBatches(TEXTFILE* textfile, TEXTFILE* expected, int max, const char* name) {
+    TEXTF_SPAN spans[MAX_SPANS]; const char* line; size_t length; int count, i, largest=0;
+    if (!CHECK(textfile!=NULL && expected!=NULL)) { textfclose(textfile); textfclose(expected); return 0; }
+    while ((count=textfgetlines(textfile, spans, max))>0) {
+        CHECK(count<=max);
+        if (count>largest) { largest = count; }
+        /* (the whole batch is compared after the call, so every span must still be valid) */
+        for (i=0; i<count; ++i) {
+            line = textfgetline_n(expected, &length);
+            if (!CHECK(line!=NULL && spans[i].length==length && memcmp(spans[i].line, line, length)==0)) {
+                fprintf(stderr, "  line %ld of '%s' (batches of %d)\n", expected->lineNumber, name, max);
+                textfclose(textfile); textfclose(expected); return largest;
+            }
+        }
+        CHECK_LONG(textfile->lineNumber, expected->lineNumber);
+    }
+    CHECK(textfgetline_n(expected, &length)==NULL);
+    CHECK(textfgetlines(textfile, spans, max)==0);
+    CHECK_LONG(textferror(textfile), textferror(expected));
+    textfclose(textfile);
+    textfclose(expected);
+    return largest;
+}
+
+/**
+ * Writes a text with random lengths, mixed end-of-lines and (optionally) invalid UTF-8 bytes
+ * (after the first kilobyte, so that the encoding is still detected as UTF-8)
+ * @returns the size of the text in bytes
+ */
+static size_t randomText(char* text, size_t maxSize, unsigned long seed, int isInvalid) {
+    static const char* const eols[] = { "\n", "\r\n", "\r", "\n\r", "\n\n" };
+    size_t size=0; int length;
+    while (size<(maxSize-300)) {
+        seed   = seed*1103515245ul + 12345ul;
+        length = (int)((seed>>16) % ((seed>>8)%8==0 ? 250 : 30));
+        while (length-->0) {
+            seed = seed*1103515245ul + 12345ul;
+            text[size++] = (char)(isInvalid && size>1024 && (seed>>16)%97==0 ? 0xFF : 'a' + (seed>>16)%26);
+        }
+        seed = seed*1103515245ul + 12345ul;
+        strcpy(&text[size], eols[(seed>>16)%5]); size += strlen(&text[size]);
+    }
+    return size;
+}
+
+int main(void) {
+    static const int maxs[] = { 1, 3, MAX_SPANS };
+    static char text[MAX_TEXT];
+    char path[256]; TEXTF_OPTIONS options; size_t size, m; int largest, isInvalid;
+
+    for (m=0; m<sizeof(maxs)/sizeof(maxs[0]); ++m) {
+        for (isInvalid=0; isInvalid<=1; ++isInvalid) {
+            size = randomText(text, MAX_TEXT, 3+m, isInvalid);
+            testWriteFile(path, "getlines.txt", text, size);
+
+            /* buffered (several block sizes), mapped and in memory */
+            /* (a batch takes all the lines in the buffer, the mapping of a UTF-8 file is a buffer with the whole file) */
+            memset(&options, 0, sizeof(options));
+            largest = checkBatches(textfopen_ex(path, "r", &options), textfopen_ex(path, "r", &options), maxs[m], path);
+            CHECK(largest>1 || maxs[m]==1);
+            options.blockSize = 16;
+            checkBatches(textfopen_ex(path, "r", &options), textfopen_ex(path, "r", &options), maxs[m], path);
+            options.blockSize = 100;
+            checkBatches(textfopen_ex(path, "r", &options), textfopen_ex(path, "r", &options), maxs[m], path);
+            largest = checkBatches(textfopen(path, "rm"), textfopen(path, "rm"), maxs[m], path);
+            CHECK(largest==maxs[m]);
+            checkBatches(textfopen_mem(text, size), textfopen_mem(text, size), maxs[m], path);
+
+            /* the long lines are split or truncated */
+            memset(&options, 0, sizeof(options));
+            options.maxBufferSize = 64;
+            options.overflow      = TEXTF_OVERFLOW_SPLIT;
+            checkBatches(textfopen_ex(path, "r", &options), textfopen_ex(path, "r", &options), maxs[m], path);
+            checkBatches(textfopen_ex(path, "rm", &options), textfopen_ex(path, "rm", &options), maxs[m], path);
+            options.overflow      = TEXTF_OVERFLOW_TRUNCATE;
+            checkBatches(textfopen_ex(path, "r", &options), textfopen_ex(path, "r", &options), maxs[m], path);
+            options.overflow      = TEXTF_OVERFLOW_ERROR;
+            checkBatches(textfopen_ex(path, "r", &options), textfopen_ex(path, "r", &options), maxs[m], path);
+
+            /* the lines with invalid UTF-8 are repaired or reported (or the reading stops) */
+            memset(&options, 0, sizeof(options));
+            options.validate = TEXTF_VALIDATE_REPLACE;
+            checkBatches(textfopen_ex(path, "r", &options), textfopen_ex(path, "r", &options), maxs[m], path);
+            options.validate = TEXTF_VALIDATE_REPORT;
+            checkBatches(textfopen_ex(path, "rm", &options), textfopen_ex(path, "rm", &options), maxs[m], path);
+            options.validate = TEXTF_VALIDATE_STOP;
+            checkBatches(textfopen_ex(path, "r", &options), textfopen_ex(path, "r", &options), maxs[m], path);
+        }
+    }
+    /* the UTF-16 fixtures are decoded in batches too */
+    checkBatches(textfopen("utf16le.txt", "r"), textfopen("utf16le.txt", "r"), MAX_SPANS, "utf16le.txt");
+    checkBatches(textfopen("utf16be-bom.txt", "rm"), textfopen("utf16be-bom.txt", "rm"), 3, "utf16be-bom.txt");
+
+    return testResult("getlines");
+}
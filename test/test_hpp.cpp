@@ -0,0 +1,91 @@
+/**
+ * @file       test_hpp.cpp
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  Checks the C++ interface 'textfile.hpp': the range of lines returns the
+ *  same lines and numbers than the C functions (across several batches)
+ *  and the ownership of the reader
+ * -------------------------------------------------------------------------
+ */
+
+/* the implementation of the library is compiled as C in 'bin/textfile.o' (see the Makefile) */
+#include "../textfile.hpp"
+#include "testing.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * Reads all the lines of a file with the C functions (the reference)
+ */
+static std::vector<std::string> readLines(const char* filename) {
+    std::vector<std::string> lines; const char* line; size_t length;
+    TEXTFILE* textfile = textfopen(filename, "r");
+    if (!CHECK(textfile!=NULL)) { return lines; }
+    while ((line=textfgetline_n(textfile, &length))!=NULL) { lines.emplace_back(line, length); }
+    textfclose(textfile);
+    return lines;
+}
+
+/**
+ * Checks that the range of lines returns the same lines (and numbers) than the C functions
+ */
+static void checkRange(const char* filename, const char* mode) {
+    std::vector<std::string> expected = readLines(filename);
+    textf::reader reader(filename, mode);
+    if (!CHECK(reader.is_open() && reader.is_supported())) { return; }
+    size_t i = 0;
+    auto lines = reader.lines();
+    for (auto it=lines.begin(); it!=lines.end(); ++it, ++i) {
+        if (!CHECK(i<expected.size() && *it==expected[i])) {
+            fprintf(stderr, "  line %d of '%s'\n", (int)(i+1), filename); return;
+        }
+        CHECK_LONG(it.line_number(), i+1);
+        CHECK_LONG(it->size(), expected[i].size());
+    }
+    CHECK_LONG(i, expected.size());
+    CHECK_LONG(reader.line_number(), expected.size());
+    CHECK(reader.lines().begin()==reader.lines().end());
+}
+
+int main() {
+    static const char* const fixtures[] = {
+        "utf8.txt", "utf8-bom.txt", "utf16le.txt", "utf16be.txt", "utf16le-bom.txt", "utf16be-bom.txt"
+    };
+    char path[256]; std::string text;
+
+    for (const char* fixture : fixtures) { checkRange(fixture, "r"); checkRange(fixture, "rm"); }
+
+    /* many more lines than a batch (the line numbers continue from one batch to the next) */
+    for (int i=0; i<(3*TEXTFILE_HPP_BATCH+7); ++i) { text += std::string((size_t)(i%13), 'a'+i%26) + (i%5 ? "\n" : "\r\n"); }
+    testWriteFile(path, "hpp.txt", text.data(), text.size());
+    checkRange(path, "r");
+    checkRange(path, "rm");
+
+    /* getline() and the ownership: moved, released and closed */
+    textf::reader first(path);
+    std::string_view line;
+    CHECK(first.getline(line) && line==std::string_view(text).substr(0, line.size()));
+    textf::reader second(std::move(first));
+    CHECK(!first.is_open() && second.is_open());
+    CHECK_LONG(second.line_number(), 1);
+    first = std::move(second);
+    CHECK(first.is_open() && !second.is_open());
+    TEXTFILE* textfile = first.release();
+    CHECK(!first.is_open() && textfile!=NULL);
+    textf::reader third(textfile);
+    CHECK(third.get()==textfile);
+    CHECK_LONG(third.close(), 0);
+    CHECK(!third.is_open() && !third.getline(line) && line.empty());
+
+    /* a file that doesn't exist: nothing is read and nothing fails */
+    textf::reader missing("bin/missing.txt");
+    CHECK(!missing.is_open() && !missing.is_supported());
+    CHECK(missing.lines().begin()==missing.lines().end());
+    CHECK_LONG(missing.seek_line(1), -1);
+
+    return testResult("hpp");
+}
@@ -0,0 +1,172 @@
+/**
+ * @file       test_index.c
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  Checks textfseekline and the sidecar file of the line index: it's only
+ *  written when requested, used while the file doesn't change, extended
+ *  when the file only grows, discarded when the file is modified or the
+ *  checkpoints are wrong, and replaced without writing through a link
+ * -------------------------------------------------------------------------
+ */
+
+/* symlink() and lstat() are POSIX extensions */
+#define _XOPEN_SOURCE 700
+
+/* includes the 'textfile.h' library and its implementation */
+#define TEXTFILE_IMPLEMENTATION
+#include "../textfile.h"
+#include "testing.h"
+
+#define MAX_TEXT (64*1024)
+
+static char          text[MAX_TEXT];
+static TEXTF_OPTIONS options;
+
+/**
+ * Writes a file where each line contains its number ('width' digits), starting at 'first'
+ * @returns the size of the text in bytes
+ */
+static size_t writeNumbers(char* path, long first, long count, int width) {
+    size_t size=0; long i;
+    for (i=0; i<count; ++i) { sprintf(&text[size], "%0*ld\n", width, first+i); size += strlen(&text[size]); }
+    testWriteFile(path, "index.txt", text, size);
+    return size;
+}
+
+/**
+ * Moves to a line and checks that it's the expected line (a number of 'width' digits)
+ */
+static void checkSeek(const char* path, long lineNumber, long expected, int width) {
+    TEXTFILE* textfile; char expectedText[32]; const char* line; size_t length;
+    textfile = textfopen_ex(path, "r", &options);
+    if (!CHECK(textfile!=NULL)) { return; }
+    sprintf(expectedText, "%0*ld", width, expected);
+    if (CHECK_LONG(textfseekline(textfile, lineNumber), 0)) {
+        line = textfgetline_n(textfile, &length);
+        CHECK_TEXT(line, length, expectedText);
+        CHECK_LONG(textfile->lineNumber, lineNumber);
+    }
+    textfclose(textfile);
+}
+
+/**
+ * Returns the value stored at the provided offset of the sidecar file (-1 if it doesn't exist)
+ */
+static long readIndexField(const char* path, int offset) {
+    char indexPath[300]; unsigned char bytes[8]; FILE* file; long value=-1;
+    sprintf(indexPath, "%s%s", path, TEXTFILE_INDEX_EXT);
+    file = fopen(indexPath, "rb");
+    if (!file) { return -1; }
+    if (fseek(file, offset, SEEK_SET)==0 && fread(bytes, 1, 8, file)==8) { value = textf__getlong(bytes); }
+    fclose(file);
+    return value;
+}
+
+/**
+ * Overwrites a checkpoint stored in the sidecar file (keeping its header)
+ */
+static void corruptIndexOffset(const char* path, long checkpoint, long value) {
+    char indexPath[300]; unsigned char bytes[8]; FILE* file;
+    sprintf(indexPath, "%s%s", path, TEXTFILE_INDEX_EXT);
+    file = fopen(indexPath, "r+b");
+    if (!file) { return; }
+    textf__putlong(bytes, value);
+    fseek(file, TEXTF__INDEX_HEADER*8 + checkpoint*8, SEEK_SET); fwrite(bytes, 1, 8, file);
+    fclose(file);
+}
+
+/**
+ * Seeks a line of a file whose sidecar file has a wrong checkpoint and checks that the sidecar file was discarded
+ */
+static void checkWrongOffset(const char* path, long checkpoint, long value) {
+    long offset = readIndexField(path, TEXTF__INDEX_HEADER*8 + checkpoint*8);
+    corruptIndexOffset(path, checkpoint, value);
+    checkSeek(path, checkpoint*TEXTFILE_INDEX_STEP + 1, checkpoint*TEXTFILE_INDEX_STEP + 1, 4);
+    /* (the index was built again, so the sidecar file was rewritten with the right offset) */
+    checkSeek(path, 6000, 6000, 4);
+    CHECK(offset>0);
+    CHECK_LONG(readIndexField(path, TEXTF__INDEX_HEADER*8 + checkpoint*8), offset);
+}
+
+int main(void) {
+    char path[256], indexPath[300], linkPath[300]; TEXTFILE* textfile; const char* line; size_t size, length;
+    struct stat st;
+
+    testWriteFile(path, "index.txt", "", 0);
+    sprintf(indexPath, "%s%s", path, TEXTFILE_INDEX_EXT);
+    remove(indexPath);
+
+    /* without the 'indexFile' option the index is kept only in memory */
+    memset(&options, 0, sizeof(options));
+    size = writeNumbers(path, 1, 6000, 4);
+    checkSeek(path, 5000, 5000, 4);
+    CHECK_LONG(readIndexField(path, 8), -1);
+
+    /* the first seek builds the index and stores it when the file is closed */
+    options.indexFile = 1;
+    checkSeek(path, 5000, 5000, 4);
+    CHECK_LONG(readIndexField(path, 8), (long)size);
+    CHECK(readIndexField(path, 56)>=4);
+    checkSeek(path, 1, 1, 4);
+    checkSeek(path, 2500, 2500, 4);
+    textfile = textfopen_ex(path, "r", &options);
+    CHECK_LONG(textfseekline(textfile, 6001), 0);   /* (the empty line after the last end-of-line) */
+    line = textfgetline_n(textfile, &length);
+    CHECK_TEXT(line, length, "");
+    CHECK(textfseekline(textfile, 6002)!=0);
+    textfclose(textfile);
+
+    /* the checkpoints that aren't increasing or that are beyond the end of the file -> the index is discarded */
+    checkWrongOffset(path, 2, 3);
+    checkWrongOffset(path, 3, readIndexField(path, TEXTF__INDEX_HEADER*8 + 2*8));
+    checkWrongOffset(path, 4, (long)size);
+    checkWrongOffset(path, 1, -5);
+
+    /* a sidecar file that is a link -> the link is replaced, the file it points to isn't written */
+    sprintf(linkPath, "%s.target", path);
+    testWriteFile(linkPath, "index.txt.target", "target", 6);
+    remove(indexPath);
+    CHECK(symlink("index.txt.target", indexPath)==0);
+    checkSeek(path, 4500, 4500, 4);
+    CHECK(lstat(indexPath, &st)==0 && S_ISREG(st.st_mode));
+    CHECK(stat(linkPath, &st)==0 && st.st_size==6);
+    CHECK_LONG(readIndexField(path, 8), (long)size);
+    remove(linkPath);
+
+    /* the file is modified keeping its size -> the index is discarded */
+    size = writeNumbers(path, 1, 3000, 9);
+    CHECK_LONG((long)size, 6000*5);
+    checkSeek(path, 2500, 2500, 9);
+    checkSeek(path, 1030, 1030, 9);
+    CHECK_LONG(readIndexField(path, 8), (long)size);
+
+    /* the file is replaced by a shorter one -> the index is discarded */
+    size = writeNumbers(path, 1, 1500, 3);
+    checkSeek(path, 1200, 1200, 3);
+    checkSeek(path, 1025, 1025, 3);
+    CHECK_LONG(readIndexField(path, 8), (long)size);
+
+    /* the file grows (same beginning) -> the index is kept and extended */
+    size = writeNumbers(path, 1, 1500, 3);
+    checkSeek(path, 1400, 1400, 3);
+    size = writeNumbers(path, 1, 9000, 3);
+    checkSeek(path, 1400, 1400, 3);
+    checkSeek(path, 8500, 8500, 3);
+    CHECK_LONG(readIndexField(path, 8), (long)size);
+    CHECK(readIndexField(path, 56)>=8);
+
+    /* the file grows but its beginning was modified -> the index is discarded */
+    size = writeNumbers(path, 2, 10000, 5);
+    CHECK((long)size>readIndexField(path, 8));
+    checkSeek(path, 1, 2, 5);
+    checkSeek(path, 9500, 9501, 5);
+
+    /* a damaged sidecar file is ignored */
+    testWriteFile(indexPath, "index.txt" TEXTFILE_INDEX_EXT, "not an index", 12);
+    checkSeek(path, 3000, 3001, 5);
+
+    return testResult("index");
+}
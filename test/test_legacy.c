@@ -0,0 +1,132 @@
+/**
+ * @file       test_legacy.c
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  Checks the single-byte encodings: Windows-1252 and ISO-8859-1 are told
+ *  apart from UTF-8, and every byte is converted to the right character
+ *  (also Windows-1252 and ISO-8859-15 selected with 'legacyEncoding')
+ * -------------------------------------------------------------------------
+ */
+
+/* includes the 'textfile.h' library and its implementation */
+#define TEXTFILE_IMPLEMENTATION
+#include "../textfile.h"
+#include "testing.h"
+
+#define MAX_TEXT 8192
+
+/** The characters of the bytes 0x80..0x9F in Windows-1252 (the 5 undefined bytes are kept as C1 controls) */
+static const unsigned int windows1252[32] = {
+    0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+    0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+    0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+    0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178
+};
+
+/** The characters of ISO-8859-15 that are different in ISO-8859-1 */
+static const unsigned int iso8859_15[][2] = {
+    { 0xA4, 0x20AC }, { 0xA6, 0x0160 }, { 0xA8, 0x0161 }, { 0xB4, 0x017D },
+    { 0xB8, 0x017E }, { 0xBC, 0x0152 }, { 0xBD, 0x0153 }, { 0xBE, 0x0178 }
+};
+
+/**
+ * Returns the unicode character of a byte in the provided encoding (reference implementation)
+ */
+static unsigned int toUnicode(int byte, TEXTF_ENCODING encoding) {
+    int i;
+    if (encoding==TEXTF_ENCODING_WINDOWS1252 && 0x80<=byte && byte<=0x9F) { return windows1252[byte-0x80]; }
+    if (encoding==TEXTF_ENCODING_ISO8859_15) {
+        for (i=0; i<8; ++i) { if (iso8859_15[i][0]==(unsigned int)byte) { return iso8859_15[i][1]; } }
+    }
+    return (unsigned int)byte;
+}
+
+/**
+ * Converts a text in a single-byte encoding to UTF-8 (reference implementation, UTF-8 is copied as it is)
+ * @returns the size of the UTF-8 text in bytes
+ */
+static size_t toUtf8(char* dest, const unsigned char* text, size_t size, TEXTF_ENCODING encoding) {
+    size_t i; unsigned char* out=(unsigned char*)dest; unsigned int code;
+    if (encoding==TEXTF_ENCODING_UTF8) { memcpy(dest, text, size); return size; }
+    for (i=0; i<size; ++i) {
+        code = toUnicode(text[i], encoding);
+        if      (code<0x80)  { *out++ = (unsigned char)code; }
+        else if (code<0x800) { *out++ = (unsigned char)(0xC0|(code>>6)); *out++ = (unsigned char)(0x80|(code&0x3F)); }
+        else {
+            *out++ = (unsigned char)(0xE0|(code>>12));
+            *out++ = (unsigned char)(0x80|((code>>6)&0x3F));
+            *out++ = (unsigned char)(0x80|(code&0x3F));
+        }
+    }
+    return (size_t)(out - (unsigned char*)dest);
+}
+
+/**
+ * Reads a file and checks its encoding and that its lines are the UTF-8 conversion of the original text
+ * (the text only uses "\n" as end-of-line)
+ */
+static void checkLines(TEXTFILE* textfile, const unsigned char* text, size_t size, TEXTF_ENCODING encoding) {
+    static char expected[3*MAX_TEXT]; const char* line; size_t length, start, end;
+    if (!CHECK(textfile!=NULL)) { return; }
+    CHECK_LONG(textfile->encoding, encoding);
+    for (start=0; start<=size; start=end+1) {
+        for (end=start; end<size && text[end]!='\n'; ++end) { }
+        length = toUtf8(expected, &text[start], end-start, encoding);
+        expected[length] = '\0';
+        line = textfgetline_n(textfile, &length);
+        if (!CHECK_TEXT(line, length, expected)) { break; }
+    }
+    CHECK(textfgetline_n(textfile, &length)==NULL);
+    textfclose(textfile);
+}
+
+/**
+ * Checks a text in every mode (buffered with several block sizes, mapped and in memory)
+ * @param legacyEncoding  The encoding selected in the options (TEXTF_ENCODING_UTF8 = detect it)
+ * @param encoding        The encoding expected
+ */
+static void checkModes(const unsigned char* text, size_t size, TEXTF_ENCODING legacyEncoding, TEXTF_ENCODING encoding) {
+    static const int blockSizes[] = { 0, 16, 17 };
+    char path[256]; TEXTF_OPTIONS options; int b;
+    testWriteFile(path, "legacy.txt", text, size);
+    memset(&options, 0, sizeof(options));
+    options.legacyEncoding = legacyEncoding;
+    for (b=0; b<(int)(sizeof(blockSizes)/sizeof(blockSizes[0])); ++b) {
+        options.blockSize = blockSizes[b];
+        checkLines(textfopen_ex(path, "r", &options), text, size, encoding);
+    }
+    options.blockSize = 0;
+    checkLines(textfopen_ex(path, "rm", &options), text, size, encoding);
+    checkLines(textfopen_mem_ex(text, size, &options), text, size, encoding);
+}
+
+int main(void) {
+    static unsigned char text[MAX_TEXT];
+    size_t size, i; int c;
+
+    /* every printable byte in lines of 16 bytes */
+    for (size=0, c=0x20; c<=0xFF; ++c) { text[size++] = (unsigned char)c; if (c%16==15) { text[size++] = '\n'; } }
+    checkModes(text, size, TEXTF_ENCODING_UTF8, TEXTF_ENCODING_WINDOWS1252);
+    checkModes(text, size, TEXTF_ENCODING_WINDOWS1252, TEXTF_ENCODING_WINDOWS1252);
+    checkModes(text, size, TEXTF_ENCODING_ISO8859_1, TEXTF_ENCODING_ISO8859_1);
+    checkModes(text, size, TEXTF_ENCODING_ISO8859_15, TEXTF_ENCODING_ISO8859_15);
+
+    /* without the bytes 0x80..0x9F the text is detected as ISO-8859-1 */
+    for (size=0, c=0xA0; c<=0xFF; ++c) { text[size++] = (unsigned char)c; if (c%16==15) { text[size++] = '\n'; } }
+    checkModes(text, size, TEXTF_ENCODING_UTF8, TEXTF_ENCODING_ISO8859_1);
+
+    /* valid UTF-8 isn't converted (even if 'legacyEncoding' is selected) */
+    memcpy(text, "caf\xC3\xA9\n\xE2\x82\xAC 10", 12);
+    checkModes(text, 12, TEXTF_ENCODING_ISO8859_15, TEXTF_ENCODING_UTF8);
+
+    /* long runs of ASCII (copied by the fast path) between the converted characters, cut by the refills */
+    for (size=0, i=0; size<(MAX_TEXT-8); ++i) {
+        text[size++] = (unsigned char)(i%37==36 ? 0x80 + i%32 : i%101==100 ? '\n' : 'a' + i%26);
+    }
+    checkModes(text, size, TEXTF_ENCODING_UTF8, TEXTF_ENCODING_WINDOWS1252);
+
+    return testResult("legacy");
+}
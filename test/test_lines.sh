@@ -0,0 +1,75 @@
+#!/bin/sh
+# -------------------------------------------------------------------------
+#  Checks that 'lines -j <n>' prints exactly the same output than 'lines'
+#  (several files read at once, or one file searched by several threads)
+#  and that 'lines -n -t <n>' prints the numbers of the whole file
+# -------------------------------------------------------------------------
+LINES=../examples/lines
+DIR=bin
+checks=0
+failures=0
+
+# writes a text with lines of different lengths and end-of-lines, some of them containing the word 'dog'
+writeText() {
+    awk -v seed="$2" 'BEGIN {
+        srand(seed);
+        for (i=1; i<=20000; ++i) {
+            line = "";
+            n = int(rand()*12);
+            for (w=0; w<n; ++w) { line = line (rand()<0.02 ? "dog " : "word" int(rand()*1000) " "); }
+            r = rand();
+            eol = r<0.6 ? "\n" : r<0.8 ? "\r\n" : r<0.9 ? "\r" : "\n\r";
+            printf "%s%s", line, eol;
+        }
+    }' > "$1"
+}
+
+# runs 'lines' with and without jobs and compares the output
+check() {
+    checks=$((checks+1))
+    "$LINES" "$@" > "$DIR/lines-seq.out" 2>&1
+    for jobs in 2 4 8; do
+        "$LINES" -j $jobs "$@" > "$DIR/lines-par.out" 2>&1
+        if ! cmp -s "$DIR/lines-seq.out" "$DIR/lines-par.out"; then
+            failures=$((failures+1))
+            echo "lines -j $jobs $*: the output is different than the sequential output" >&2
+            return
+        fi
+    done
+}
+
+# runs 'lines -n -t <n>' on a file and on a pipe, and compares the output with the last lines of 'lines -n'
+checkTail() {
+    checks=$((checks+1))
+    "$LINES" -n "$2" | tail -n $(($1+1)) > "$DIR/lines-seq.out"
+    "$LINES" -n -t "$1" "$2" | tail -n +2 > "$DIR/lines-tail.out"
+    cat "$2" | "$LINES" -n -t "$1" - | tail -n +2 > "$DIR/lines-pipe.out"
+    if ! cmp -s "$DIR/lines-seq.out" "$DIR/lines-tail.out" || ! cmp -s "$DIR/lines-seq.out" "$DIR/lines-pipe.out"; then
+        failures=$((failures+1))
+        echo "lines -n -t $1 $2: the numbers are different than the numbers of the whole file" >&2
+    fi
+}
+
+mkdir -p "$DIR"
+writeText "$DIR/lines-a.txt" 1
+writeText "$DIR/lines-b.txt" 2
+writeText "$DIR/lines-c.txt" 3
+FILES="$DIR/lines-a.txt utf8.txt $DIR/lines-b.txt utf16le.txt utf16be-bom.txt binary.txt $DIR/lines-c.txt"
+
+check $FILES
+check -n $FILES
+check -s dog $FILES
+check -n -s dog -s word12 $FILES
+check -n -i -s DOG $FILES
+check -r 100:200 $FILES
+check -n -r 5000:5010 -s dog $FILES
+check -n -t 7 $FILES
+check -c $FILES
+check -n -s dog "$DIR/lines-a.txt"
+check -n -s dog utf16le.txt
+check -n -s dog -r 1000:3000 "$DIR/lines-b.txt"
+checkTail 7 "$DIR/lines-a.txt"
+checkTail 3 utf16le.txt
+
+printf "%-16s %d checks, %d failed\n" "lines" $checks $failures
+[ $failures -eq 0 ]
@@ -0,0 +1,82 @@
+/**
+ * @file       test_mmap.c
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  Checks the "rm" mode: the mapped files return the same lines than the
+ *  buffered files, pointing directly into the mapping
+ * -------------------------------------------------------------------------
+ */
+
+/* includes the 'textfile.h' library and its implementation */
+#define TEXTFILE_IMPLEMENTATION
+#include "../textfile.h"
+#include "testing.h"
+
+#define MAX_TEXT (8*1024)
+
+static const char* const fixtures[] = {
+    "utf8.txt", "utf8-bom.txt", "utf16le.txt", "utf16be.txt", "utf16le-bom.txt", "utf16be-bom.txt", "binary.txt"
+};
+
+/**
+ * Reads a file in "rm" and "r" modes and checks that both return the same lines
+ */
+static void checkSameLines(const char* path) {
+    TEXTFILE *mapped, *buffered; const char *line, *expected; size_t length, expectedLength;
+
+    mapped   = textfopen(path, "rm");
+    buffered = textfopen(path, "r");
+    if (!CHECK(mapped!=NULL && buffered!=NULL)) { return; }
+    CHECK_LONG(mapped->encoding, buffered->encoding);
+    CHECK_LONG(mapped->eol,      buffered->eol);
+    do {
+        expected = textfgetline_n(buffered, &expectedLength);
+        line     = textfgetline_n(mapped,   &length);
+        if (!CHECK(expected==NULL ? line==NULL : (line!=NULL && length==expectedLength &&
+                                                   memcmp(line, expected, length)==0))) {
+            fprintf(stderr, "  line %ld of '%s'\n", buffered->lineNumber, path);
+            break;
+        }
+    } while (expected!=NULL);
+    CHECK_LONG(mapped->lineNumber, buffered->lineNumber);
+    textfclose(mapped);
+    textfclose(buffered);
+}
+
+int main(void) {
+    static const size_t sizes[] = { 0, 1, 4095, 4096, 4097, MAX_TEXT };
+    static char text[MAX_TEXT+1];
+    char path[256]; TEXTFILE* textfile; const char* line; char* copy; size_t f, s, i, length;
+
+    for (f=0; f<sizeof(fixtures)/sizeof(fixtures[0]); ++f) { checkSameLines(fixtures[f]); }
+
+    /* files whose last line ends exactly at the end of a page (without end-of-line) */
+    for (i=0; i<MAX_TEXT; ++i) { text[i] = (i%61==60) ? '\n' : (i%97==96) ? '\r' : (char)('a' + i%26); }
+    for (s=0; s<sizeof(sizes)/sizeof(sizes[0]); ++s) {
+        checkSameLines(testWriteFile(path, "mmap.txt", text, sizes[s]));
+    }
+
+    /* the lines of a mapped UTF-8 file point into the mapping (nothing is copied) */
+    textfile = textfopen("utf8.txt", "rm");
+    if (CHECK(textfile!=NULL && textfile->mapping!=NULL)) {
+        while ((line=textfgetline_n(textfile, &length))!=NULL) {
+            CHECK(line>=textfile->mapping && (line+length)<=(textfile->mapping+textfile->mappingSize));
+        }
+        textfclose(textfile);
+    }
+
+    /* textfgetline copies the lines of a mapped file to null-terminate them (the mapping is read-only) */
+    textfile = textfopen(testWriteFile(path, "mmap.txt", "first\nsecond", 12), "rm");
+    if (CHECK(textfile!=NULL)) {
+        copy = textfgetline(textfile);
+        CHECK(copy!=NULL && strcmp(copy, "first")==0);
+        copy = textfgetline(textfile);
+        CHECK(copy!=NULL && strcmp(copy, "second")==0);
+        CHECK(textfgetline(textfile)==NULL);
+        textfclose(textfile);
+    }
+    return testResult("mmap");
+}
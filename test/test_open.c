@@ -0,0 +1,143 @@
+/**
+ * @file       test_open.c
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  Checks textfopen_mem, textfdopen and textfopen_stream (and their _ex
+ *  variants): they return the same lines than textfopen, reading from the
+ *  current position of the descriptor or the stream
+ * -------------------------------------------------------------------------
+ */
+
+/* pipe() and open() are POSIX extensions */
+#define _XOPEN_SOURCE 700
+
+/* includes the 'textfile.h' library and its implementation */
+#define TEXTFILE_IMPLEMENTATION
+#include "../textfile.h"
+#include "testing.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#define MAX_TEXT 4096
+
+static const char* const fixtures[] = {
+    "utf8.txt", "utf8-bom.txt", "utf16le.txt", "utf16be.txt", "utf16le-bom.txt", "utf16be-bom.txt"
+};
+
+/**
+ * Checks that two TEXTFILE objects return the same lines (both objects are closed)
+ */
+static void checkSameLines(TEXTFILE* textfile, TEXTFILE* expected, const char* name) {
+    const char *line, *expectedLine; size_t length, expectedLength;
+    if (!CHECK(textfile!=NULL && expected!=NULL)) { textfclose(textfile); textfclose(expected); return; }
+    CHECK_LONG(textfile->encoding, expected->encoding);
+    CHECK_LONG(textfile->eol,      expected->eol);
+    do {
+        expectedLine = textfgetline_n(expected, &expectedLength);
+        line         = textfgetline_n(textfile, &length);
+        if (!CHECK(expectedLine==NULL ? line==NULL : (line!=NULL && length==expectedLength &&
+                                                       memcmp(line, expectedLine, length)==0))) {
+            fprintf(stderr, "  line %ld of '%s'\n", expected->lineNumber, name);
+            break;
+        }
+    } while (expectedLine!=NULL);
+    textfclose(textfile);
+    textfclose(expected);
+}
+
+/**
+ * Loads a whole file in memory
+ * @returns the size of the file in bytes
+ */
+static size_t loadFile(char* text, const char* path) {
+    FILE* file; size_t size=0;
+    file = fopen(path, "rb");
+    if (file) { size = fread(text, 1, MAX_TEXT, file); fclose(file); }
+    return size;
+}
+
+/** Allocator that always fails */
+static void* failingMalloc(void* allocatorData, size_t size) { (void)allocatorData; (void)size; return NULL; }
+static void  failingFree(void* allocatorData, void* ptr)     { (void)allocatorData; free(ptr); }
+
+int main(void) {
+    static char text[MAX_TEXT];
+    char path[256]; TEXTF_OPTIONS options; TEXTFILE* textfile; const char* line; FILE* stream;
+    size_t f, size, length; int fd, fds[2];
+
+    memset(&options, 0, sizeof(options));
+    options.blockSize = 16;
+
+    for (f=0; f<sizeof(fixtures)/sizeof(fixtures[0]); ++f) {
+        size = loadFile(text, fixtures[f]);
+        CHECK(size>0);
+        /* the text in memory, the descriptor and the stream detect the same encoding and end-of-line than the file */
+        checkSameLines(textfopen_mem(text, size), textfopen(fixtures[f], "r"), fixtures[f]);
+        checkSameLines(textfopen_mem_ex(text, size, &options), textfopen(fixtures[f], "r"), fixtures[f]);
+        checkSameLines(textfdopen(open(fixtures[f], O_RDONLY), "r"),  textfopen(fixtures[f], "r"), fixtures[f]);
+        checkSameLines(textfdopen(open(fixtures[f], O_RDONLY), "rm"), textfopen(fixtures[f], "r"), fixtures[f]);
+        checkSameLines(textfdopen_ex(open(fixtures[f], O_RDONLY), "r", &options), textfopen(fixtures[f], "r"), fixtures[f]);
+        stream = fopen(fixtures[f], "rb");
+        checkSameLines(textfopen_stream(stream), textfopen(fixtures[f], "r"), fixtures[f]);
+        fclose(stream);
+        stream = fopen(fixtures[f], "rb");
+        checkSameLines(textfopen_stream_ex(stream, &options), textfopen(fixtures[f], "r"), fixtures[f]);
+        fclose(stream);
+    }
+
+    /* the lines of a text in memory point into the text (nothing is copied) */
+    size = loadFile(text, "utf8.txt");
+    textfile = textfopen_mem(text, size);
+    if (CHECK(textfile!=NULL)) {
+        while ((line=textfgetline_n(textfile, &length))!=NULL) { CHECK(line>=text && (line+length)<=(text+size)); }
+        textfclose(textfile);
+    }
+    checkSameLines(textfopen_mem(NULL, 0), textfopen(testWriteFile(path, "open.txt", "", 0), "r"), "(empty)");
+
+    /* the descriptor is read from its current position and closed by textfclose (also when it's mapped) */
+    testWriteFile(path, "open.txt", "skipped\nfirst\nsecond\n", 21);
+    fd = open(path, O_RDONLY);
+    CHECK(read(fd, text, 8)==8);
+    checkSameLines(textfdopen(fd, "rm"), textfopen_mem("first\nsecond\n", 13), "(descriptor)");
+    CHECK(close(fd)!=0);
+    fd = open(path, O_RDONLY);
+    textfile = textfdopen(fd, "rm");
+    CHECK(textfile!=NULL && textfile->mapping!=NULL);
+    textfclose(textfile);
+    CHECK(close(fd)!=0);
+
+    /* a pipe is read like any other descriptor ("rm" falls back to reading it) */
+    if (CHECK(pipe(fds)==0)) {
+        CHECK(write(fds[1], "one\r\ntwo\r\nthree", 15)==15);
+        close(fds[1]);
+        checkSameLines(textfdopen(fds[0], "rm"), textfopen_mem("one\r\ntwo\r\nthree", 15), "(pipe)");
+    }
+
+    /* the stream is read from its current position and it's not closed by textfclose */
+    stream = fopen(path, "rb");
+    if (CHECK(stream!=NULL)) {
+        CHECK(fgets(text, 9, stream)!=NULL && strcmp(text, "skipped\n")==0);
+        checkSameLines(textfopen_stream(stream), textfopen_mem("first\nsecond\n", 13), "(stream)");
+        CHECK(fgetc(stream)==EOF);
+        CHECK(fclose(stream)==0);
+    }
+
+    /* the openers return NULL when the TEXTFILE object can't be allocated (and the descriptor isn't closed) */
+    memset(&options, 0, sizeof(options));
+    options.mallocFunc = failingMalloc;
+    options.freeFunc   = failingFree;
+    CHECK(textfopen_ex(path, "r", &options)==NULL);
+    CHECK(textfopen_mem_ex(text, size, &options)==NULL);
+    fd = open(path, O_RDONLY);
+    CHECK(textfdopen_ex(fd, "r", &options)==NULL);
+    CHECK(close(fd)==0);
+    stream = fopen(path, "rb");
+    CHECK(textfopen_stream_ex(stream, &options)==NULL);
+    fclose(stream);
+
+    return testResult("open");
+}
@@ -0,0 +1,194 @@
+/**
+ * @file       test_options.c
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  Checks the options of textfopen_ex: the overflow policies of the lines
+ *  longer than the maximum buffer size and the allocator hooks (every block
+ *  allocated is released, also when the allocator fails)
+ * -------------------------------------------------------------------------
+ */
+
+/* includes the 'textfile.h' library and its implementation */
+#define TEXTFILE_IMPLEMENTATION
+#include "../textfile.h"
+#include "testing.h"
+
+#define LONG_LINE 1000
+
+/** Counts the blocks allocated through the hooks, failing when 'limit' allocations are reached (-1 = no limit) */
+typedef struct Allocator {
+    long allocations;
+    long blocks;
+    long limit;
+} Allocator;
+
+static void* countingMalloc(void* allocatorData, size_t size) {
+    Allocator* allocator = (Allocator*)allocatorData; void* ptr;
+    if (allocator->limit>=0 && allocator->allocations>=allocator->limit) { return NULL; }
+    ptr = malloc(size);
+    if (ptr) { ++allocator->allocations; ++allocator->blocks; }
+    return ptr;
+}
+
+static void countingFree(void* allocatorData, void* ptr) {
+    Allocator* allocator = (Allocator*)allocatorData;
+    if (ptr) { --allocator->blocks; }
+    free(ptr);
+}
+
+/**
+ * Reads a file with the allocator hooks and checks that every block is released when the file is closed
+ * @param limit  Number of allocations before the allocator starts to fail (-1 = no limit)
+ * @returns      The number of allocations made
+ */
+static long checkAllocator(const char* path, const char* mode, TEXTF_OPTIONS* options, long limit) {
+    Allocator allocator; TEXTFILE* textfile; const char* line; size_t length;
+    allocator.allocations = allocator.blocks = 0; allocator.limit = limit;
+    options->mallocFunc    = countingMalloc;
+    options->freeFunc      = countingFree;
+    options->allocatorData = &allocator;
+    textfile = textfopen_ex(path, mode, options);
+    if (textfile) {
+        CHECK(textfgetline(textfile)!=NULL || limit>=0);
+        while ((line=textfgetline_n(textfile, &length))!=NULL) { }
+        textfclose(textfile);
+    }
+    else { CHECK(limit>=0); }
+    CHECK_LONG(allocator.blocks, 0);
+    return allocator.allocations;
+}
+
+/**
+ * Reads a long line with TEXTF_OVERFLOW_SPLIT and checks that the pieces fit and don't split UTF-8 characters
+ */
+static void checkSplit(TEXTFILE* textfile, const char* longLine) {
+    const char* line; size_t length, total=0; long maxLength;
+    if (!CHECK(textfile!=NULL)) { return; }
+    maxLength = textfile->maxLineLength;
+    CHECK(maxLength>0);
+    while ((line=textfgetline_n(textfile, &length))!=NULL && total<LONG_LINE) {
+        CHECK(length>0 && (long)length<=maxLength);
+        CHECK((line[0]&0xC0)!=0x80);
+        CHECK(memcmp(line, &longLine[total], length)==0);
+        total += length;
+    }
+    CHECK_LONG(total, LONG_LINE);
+    CHECK_TEXT(line, length, "last");
+    CHECK(textfgetline_n(textfile, &length)==NULL);
+    CHECK_LONG(textferror(textfile), TEXTF_ERROR_NONE);
+    textfclose(textfile);
+}
+
+int main(void) {
+    static const char* const modes[] = { "r", "rm" };
+    static char text[LONG_LINE+32], longLine[LONG_LINE];
+    char path[256], invalidPath[256]; TEXTF_OPTIONS options; Allocator allocator; TEXTFILE* textfile; const char* line;
+    size_t i, size, length; long allocations, limit; int m;
+
+    /* a long line of two-byte UTF-8 characters ("\xC3\xA9") with an ASCII character every 7 bytes */
+    for (i=0; i<LONG_LINE; ) {
+        if (i%7==6 || i+1==LONG_LINE) { longLine[i++] = 'x'; }
+        else { longLine[i++] = '\xC3'; longLine[i++] = '\xA9'; }
+    }
+    size = 0;
+    memcpy(&text[size], "first\n", 6);        size += 6;
+    memcpy(&text[size], longLine, LONG_LINE); size += LONG_LINE;
+    memcpy(&text[size], "\nlast", 5);         size += 5;
+    testWriteFile(path, "options.txt", text, size);
+
+    for (m=0; m<(int)(sizeof(modes)/sizeof(modes[0])); ++m) {
+        /* TEXTF_OVERFLOW_SPLIT returns the whole line in pieces */
+        memset(&options, 0, sizeof(options));
+        options.maxBufferSize = 64;
+        options.overflow      = TEXTF_OVERFLOW_SPLIT;
+        textfile = textfopen_ex(path, modes[m], &options);
+        if (CHECK(textfile!=NULL)) {
+            line = textfgetline_n(textfile, &length);
+            CHECK_TEXT(line, length, "first");
+            checkSplit(textfile, longLine);
+        }
+        /* TEXTF_OVERFLOW_TRUNCATE returns the first piece and skips the rest */
+        options.overflow = TEXTF_OVERFLOW_TRUNCATE;
+        textfile = textfopen_ex(path, modes[m], &options);
+        if (CHECK(textfile!=NULL)) {
+            line = textfgetline_n(textfile, &length);
+            CHECK_TEXT(line, length, "first");
+            line = textfgetline_n(textfile, &length);
+            CHECK(line!=NULL && length>0 && (long)length<=textfile->maxLineLength && memcmp(line, longLine, length)==0);
+            line = textfgetline_n(textfile, &length);
+            CHECK_TEXT(line, length, "last");
+            CHECK_LONG(textfile->lineNumber, 3);
+            CHECK_LONG(textferror(textfile), TEXTF_ERROR_NONE);
+            textfclose(textfile);
+        }
+        /* TEXTF_OVERFLOW_ERROR stops the reading at the long line */
+        options.overflow = TEXTF_OVERFLOW_ERROR;
+        textfile = textfopen_ex(path, modes[m], &options);
+        if (CHECK(textfile!=NULL)) {
+            line = textfgetline_n(textfile, &length);
+            CHECK_TEXT(line, length, "first");
+            CHECK(textfgetline_n(textfile, &length)==NULL);
+            CHECK_LONG(textferror(textfile), TEXTF_ERROR_LINE_TOO_LONG);
+            CHECK(textfgetline_n(textfile, &length)==NULL);
+            textfclose(textfile);
+        }
+        /* without a maximum size the long line is returned complete */
+        memset(&options, 0, sizeof(options));
+        options.bufferSize = 16;
+        textfile = textfopen_ex(path, modes[m], &options);
+        if (CHECK(textfile!=NULL)) {
+            textfgetline_n(textfile, &length);
+            line = textfgetline_n(textfile, &length);
+            CHECK(line!=NULL && length==LONG_LINE && memcmp(line, longLine, LONG_LINE)==0);
+            textfclose(textfile);
+        }
+    }
+
+    /* every block allocated through the hooks is released (buffered, read-ahead, mapped, UTF-16 and validated) */
+    testWriteFile(invalidPath, "invalid.txt", "valid\ninv\xC3lid\n\x80\x80\n", 16);
+    memset(&options, 0, sizeof(options));
+    options.bufferSize = 16;
+    CHECK(checkAllocator(path, "r", &options, -1)>0);
+    options.readAhead = 2;
+    CHECK(checkAllocator(path, "r", &options, -1)>0);
+    memset(&options, 0, sizeof(options));
+    CHECK(checkAllocator(path, "rm", &options, -1)>0);
+    CHECK(checkAllocator("utf16le.txt", "r", &options, -1)>0);
+    CHECK(checkAllocator("utf16be-bom.txt", "rm", &options, -1)>0);
+    options.validate = TEXTF_VALIDATE_REPLACE;
+    CHECK(checkAllocator(invalidPath, "r", &options, -1)>0);
+
+    /* the allocator fails at each allocation -> nothing crashes and nothing is leaked */
+    allocations = checkAllocator(invalidPath, "r", &options, -1);
+    for (limit=0; limit<allocations; ++limit) { checkAllocator(invalidPath, "r", &options, limit); }
+    memset(&options, 0, sizeof(options));
+    allocations = checkAllocator("utf16le.txt", "rm", &options, -1);
+    for (limit=0; limit<allocations; ++limit) { checkAllocator("utf16le.txt", "rm", &options, limit); }
+    options.bufferSize = 16;
+    options.readAhead  = 2;
+    allocations = checkAllocator(path, "r", &options, -1);
+    for (limit=0; limit<allocations; ++limit) { checkAllocator(path, "r", &options, limit); }
+
+    /* the buffer can't grow to fit the long line -> the reading stops and the error is reported */
+    memset(&options, 0, sizeof(options));
+    options.bufferSize    = 16;
+    options.mallocFunc    = countingMalloc;
+    options.freeFunc      = countingFree;
+    options.allocatorData = &allocator;
+    allocator.allocations = allocator.blocks = 0; allocator.limit = 2; /* (the TEXTFILE object and its filename) */
+    textfile = textfopen_ex(path, "r", &options);
+    if (CHECK(textfile!=NULL)) {
+        line = textfgetline_n(textfile, &length);
+        CHECK_TEXT(line, length, "first");
+        CHECK(textfgetline_n(textfile, &length)==NULL);
+        CHECK_LONG(textferror(textfile), TEXTF_ERROR_OUT_OF_MEMORY);
+        CHECK(textfgetline_n(textfile, &length)==NULL);
+        textfclose(textfile);
+    }
+    CHECK_LONG(allocator.blocks, 0);
+
+    return testResult("options");
+}
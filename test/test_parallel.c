@@ -0,0 +1,214 @@
+/**
+ * @file       test_parallel.c
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  Checks that textfparallel delivers the same lines and numbers than the
+ *  sequential read (from the beginning or from the middle of the file,
+ *  also from a position restored by textfseek between '\r' and '\n')
+ * -------------------------------------------------------------------------
+ */
+
+/* includes the 'textfile.h' library and its implementation */
+#define TEXTFILE_IMPLEMENTATION
+#include "../textfile.h"
+#include "testing.h"
+
+#define TEXT_LINES 20000
+
+/** The lines of a file read sequentially, and the lines delivered by textfparallel */
+typedef struct LINES {
+    char**  lines;
+    size_t* lengths;
+    int*    delivered;  /* < number of times each line was delivered               */
+    long    firstLine;  /* < number of the line before the first line of the array */
+    long    count;
+    long    errors;     /* < lines delivered with a wrong number or text           */
+    long    lastNumber; /* < number of the last line delivered                     */
+    int     isOrdered;
+    long    stopAt;     /* < number of the line where the delivery is stopped (0 = never) */
+} LINES;
+
+static const char* const fixtures[] = { "utf8.txt", "utf16le.txt", "utf16be-bom.txt" };
+
+/**
+ * Writes a text with lines of random length and random end-of-lines (it can be UTF-8, Windows-1252 or UTF-16 BE)
+ */
+static void writeRandomText(char* path, const char* name, int isLegacy, int isUtf16) {
+    static const char* const eols[] = { "\n", "\r\n", "\r", "\n\r" };
+    char* text; size_t size=0, i16; unsigned long seed=12345; int i, length;
+    text = malloc(2*TEXT_LINES*256+2);
+    for (i=0; i<TEXT_LINES; ++i) {
+        seed = seed*1103515245ul + 12345ul;
+        length = (int)((seed>>16) % (i%100==0 ? 250 : 40));
+        while (length-->0) {
+            seed = seed*1103515245ul + 12345ul;
+            text[size++] = isLegacy && (seed>>16)%17==0 ? (char)0x93 : (char)('a' + (seed>>16)%26);
+        }
+        seed = seed*1103515245ul + 12345ul;
+        strcpy(&text[size], eols[(seed>>16)%4]); size += strlen(&text[size]);
+    }
+    /* (the ASCII text is expanded to UTF-16 BE from its end, with the BOM at the beginning) */
+    if (isUtf16) {
+        for (i16=size; i16>0; --i16) { text[2*i16] = 0; text[2*i16+1] = text[i16-1]; }
+        text[0] = (char)0xFE; text[1] = (char)0xFF; size = 2*size+2;
+    }
+    testWriteFile(path, name, text, size);
+    free(text);
+}
+
+/**
+ * Reads the remaining lines of a file sequentially
+ */
+static void readLines(LINES* lines, TEXTFILE* textfile) {
+    const char* line; size_t length; long capacity=1024;
+    memset(lines, 0, sizeof(LINES));
+    lines->firstLine = textfile->lineNumber;
+    lines->lines     = malloc(capacity*sizeof(char*));
+    lines->lengths   = malloc(capacity*sizeof(size_t));
+    while ((line=textfgetline_n(textfile, &length))!=NULL) {
+        if (lines->count==capacity) {
+            capacity *= 2;
+            lines->lines   = realloc(lines->lines,   capacity*sizeof(char*));
+            lines->lengths = realloc(lines->lengths, capacity*sizeof(size_t));
+        }
+        lines->lines[lines->count] = malloc(length+1);
+        memcpy(lines->lines[lines->count], line, length);
+        lines->lengths[lines->count++] = length;
+    }
+    lines->delivered = calloc(lines->count+1, sizeof(int));
+}
+
+static void freeLines(LINES* lines) {
+    long i;
+    for (i=0; i<lines->count; ++i) { free(lines->lines[i]); }
+    free(lines->lines); free(lines->lengths); free(lines->delivered);
+}
+
+/** Accepts one of each three lines (called concurrently) */
+static int filterLine(void* userData, const char* line, size_t length, long lineNumber) {
+    (void)userData; (void)line; (void)length;
+    return lineNumber%3==0;
+}
+
+/** Checks that the delivered line is the line with the same number in the sequential read */
+static int deliverLine(void* userData, const char* line, size_t length, long lineNumber) {
+    LINES* lines = (LINES*)userData; long index = lineNumber - lines->firstLine - 1;
+    if (index<0 || index>=lines->count || length!=lines->lengths[index] ||
+        memcmp(line, lines->lines[index], length)!=0) { ++lines->errors; return 1; }
+    if (lines->isOrdered && lineNumber<=lines->lastNumber) { ++lines->errors; }
+    ++lines->delivered[index];
+    lines->lastNumber = lineNumber;
+    return lines->stopAt==0 || lineNumber<lines->stopAt;
+}
+
+/**
+ * Reads a file with textfparallel (after skipping some lines) and compares it with the sequential read
+ */
+static void checkParallel(const char* path, int jobs, int ordered, int useFilter, long skip, long stopAt) {
+    TEXTFILE *textfile, *reference; LINES lines; long i, count, expectedDeliveries=0, deliveries=0;
+    size_t length;
+
+    reference = textfopen(path, "r");
+    textfile  = textfopen(path, "rm");
+    if (!CHECK(textfile!=NULL && reference!=NULL)) { return; }
+    for (i=0; i<skip; ++i) { textfgetline_n(reference, &length); textfgetline_n(textfile, &length); }
+    readLines(&lines, reference);
+    lines.isOrdered = ordered;
+    lines.stopAt    = stopAt;
+
+    count = textfparallel(textfile, jobs, ordered, useFilter ? filterLine : NULL, deliverLine, &lines);
+    CHECK_LONG(count, lines.count);
+    CHECK_LONG(lines.errors, 0);
+    CHECK_LONG(textfile->lineNumber, reference->lineNumber);
+    CHECK(textfgetline_n(textfile, &length)==NULL);
+    for (i=0; i<lines.count; ++i) {
+        deliveries += lines.delivered[i];
+        if (!useFilter || (lines.firstLine+i+1)%3==0) { ++expectedDeliveries; }
+        if (lines.delivered[i]>1) { ++lines.errors; }
+    }
+    /* (when the delivery is stopped, only the ordered mode knows exactly which lines were delivered) */
+    if (stopAt==0) { CHECK_LONG(deliveries, expectedDeliveries); }
+    else if (ordered) { CHECK(deliveries>0 && lines.lastNumber==stopAt); }
+    CHECK_LONG(lines.errors, 0);
+    if (lines.errors || count!=lines.count) {
+        fprintf(stderr, "  '%s' jobs=%d ordered=%d filter=%d skip=%ld stop=%ld\n",
+                path, jobs, ordered, useFilter, skip, stopAt);
+    }
+    freeLines(&lines);
+    textfclose(textfile);
+    textfclose(reference);
+}
+
+/**
+ * Reads with textfparallel from a position saved between the '\r' and the '\n' of a pair, the '\n' isn't an empty line
+ * (the position is saved while following the file, when the '\n' wasn't written yet)
+ */
+static void checkPendingEol(int jobs) {
+    char path[256]; TEXTFILE* textfile; TEXTF_POS pos; LINES lines; const char* expected[] = { "two", "three", "" };
+    const char* line; size_t length; FILE* file; long count, i;
+
+    testWriteFile(path, "parallel-pending.txt", "one\r", 4);
+    textfile = textfopen(path, "rf");
+    if (!CHECK(textfile!=NULL)) { return; }
+    line = textfgetline_n(textfile, &length);
+    CHECK_TEXT(line, length, "one");
+    CHECK(textftell(textfile, &pos)==0 && pos.pendingEol=='\r');
+    textfclose(textfile);
+
+    file = fopen(path, "ab");
+    if (!CHECK(file!=NULL)) { return; }
+    fputs("\ntwo\r\nthree\n", file); fclose(file);
+    textfile = textfopen(path, "rm");
+    if (!CHECK(textfile!=NULL && textfseek(textfile, &pos)==0)) { textfclose(textfile); return; }
+    memset(&lines, 0, sizeof(LINES));
+    lines.firstLine = 1; lines.count = 3; lines.isOrdered = 1;
+    lines.lines     = (char**)expected;
+    lines.lengths   = malloc(3*sizeof(size_t));
+    lines.delivered = calloc(4, sizeof(int));
+    for (i=0; i<3; ++i) { lines.lengths[i] = strlen(expected[i]); }
+    count = textfparallel(textfile, jobs, TEXTF_ORDERED, NULL, deliverLine, &lines);
+    CHECK_LONG(count, 3);
+    CHECK_LONG(lines.errors, 0);
+    CHECK_LONG(lines.lastNumber, 4);
+    CHECK_LONG(textfile->lineNumber, 4);
+    free(lines.lengths); free(lines.delivered);
+    textfclose(textfile);
+}
+
+int main(void) {
+    static const int  jobs[]  = { 2, 3, 8 };
+    static const long skips[] = { 0, 1, 7, 4321 };
+    char utf8Path[256], legacyPath[256], utf16Path[256]; const char* paths[6]; TEXTFILE* textfile;
+    int p, j, s, ordered, useFilter;
+
+    writeRandomText(utf8Path,   "parallel.txt",       0, 0);
+    writeRandomText(legacyPath, "parallel-1252.txt",  1, 0);
+    writeRandomText(utf16Path,  "parallel-utf16.txt", 0, 1);
+    paths[0] = utf8Path; paths[1] = legacyPath; paths[2] = utf16Path;
+    textfile = textfopen(legacyPath, "rm");
+    if (CHECK(textfile!=NULL)) { CHECK_LONG(textfile->encoding, TEXTF_ENCODING_WINDOWS1252); textfclose(textfile); }
+    textfile = textfopen(utf16Path, "rm");
+    if (CHECK(textfile!=NULL)) { CHECK_LONG(textfile->encoding, TEXTF_ENCODING_UTF16_BE_BOM); textfclose(textfile); }
+    paths[3] = fixtures[0]; paths[4] = fixtures[1]; paths[5] = fixtures[2];
+
+    for (p=0; p<6; ++p) {
+        for (j=0; j<(int)(sizeof(jobs)/sizeof(jobs[0])); ++j) {
+            for (s=0; s<(int)(sizeof(skips)/sizeof(skips[0])); ++s) {
+                for (ordered=0; ordered<=1; ++ordered) {
+                    for (useFilter=0; useFilter<=1; ++useFilter) {
+                        checkParallel(paths[p], jobs[j], ordered, useFilter, skips[s], 0);
+                    }
+                }
+            }
+        }
+        /* the delivery is stopped but all the lines are read */
+        checkParallel(paths[p], 4, TEXTF_ORDERED, 0, 2, 9);
+        checkParallel(paths[p], 4, TEXTF_UNORDERED, 0, 0, 9);
+    }
+    checkPendingEol(2);
+    checkPendingEol(8);
+    return testResult("parallel");
+}
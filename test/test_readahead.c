@@ -0,0 +1,137 @@
+/**
+ * @file       test_readahead.c
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  Checks the readAhead option: the blocks read by the background thread
+ *  return the same lines than the synchronous reading, also after moving
+ *  the read position and when the file is closed before its end
+ * -------------------------------------------------------------------------
+ */
+
+/* pipe() and open() are POSIX extensions */
+#define _XOPEN_SOURCE 700
+
+/* includes the 'textfile.h' library and its implementation */
+#define TEXTFILE_IMPLEMENTATION
+#include "../textfile.h"
+#include "testing.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#define MAX_TEXT (64*1024)
+
+/**
+ * Checks that two TEXTFILE objects return the same lines from their current position (both objects are closed)
+ */
+static void checkSameLines(TEXTFILE* textfile, TEXTFILE* expected, const char* name) {
+    const char *line, *expectedLine; size_t length, expectedLength;
+    if (!CHECK(textfile!=NULL && expected!=NULL)) { textfclose(textfile); textfclose(expected); return; }
+    do {
+        expectedLine = textfgetline_n(expected, &expectedLength);
+        line         = textfgetline_n(textfile, &length);
+        if (!CHECK(expectedLine==NULL ? line==NULL : (line!=NULL && length==expectedLength &&
+                                                       memcmp(line, expectedLine, length)==0))) {
+            fprintf(stderr, "  line %ld of '%s'\n", expected->lineNumber, name);
+            break;
+        }
+    } while (expectedLine!=NULL);
+    CHECK_LONG(textfile->lineNumber, expected->lineNumber);
+    textfclose(textfile);
+    textfclose(expected);
+}
+
+/**
+ * Writes a text with lines of random lengths and mixed end-of-lines (UTF-16 LE with BOM when 'isUtf16' is TRUE)
+ * @returns the size of the text in bytes
+ */
+static size_t randomText(char* text, size_t maxSize, unsigned long seed, int isUtf16) {
+    static const char* const eols[] = { "\n", "\r\n", "\n", "\r" };
+    size_t size=0, unit=isUtf16 ? 2 : 1, i; int length; const char* eol;
+    if (isUtf16) { text[size++] = '\xFF'; text[size++] = '\xFE'; }
+    while (size<(maxSize-300)) {
+        seed   = seed*1103515245ul + 12345ul;
+        length = (int)((seed>>16) % 120);
+        while (length-->0) {
+            seed = seed*1103515245ul + 12345ul;
+            text[size] = (char)('a' + (seed>>16)%26); if (isUtf16) { text[size+1] = 0; } size += unit;
+        }
+        seed = seed*1103515245ul + 12345ul;
+        for (eol=eols[(seed>>16)%4], i=0; eol[i]; ++i) {
+            text[size] = eol[i]; if (isUtf16) { text[size+1] = 0; } size += unit;
+        }
+    }
+    return size;
+}
+
+int main(void) {
+    static const int depths[] = { 1, 2, 4 }, blockSizes[] = { 16, 17, 0 };
+    static char text[MAX_TEXT];
+    char path[256]; TEXTF_OPTIONS options; TEXTF_POS pos; TEXTFILE *textfile, *expected; FILE* stream;
+    size_t size, d, b; int isUtf16, fds[2], i;
+
+    for (isUtf16=0; isUtf16<=1; ++isUtf16) {
+        size = randomText(text, MAX_TEXT, 7+isUtf16, isUtf16);
+        testWriteFile(path, "readahead.txt", text, size);
+        for (d=0; d<sizeof(depths)/sizeof(depths[0]); ++d) {
+            for (b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); ++b) {
+                memset(&options, 0, sizeof(options));
+                options.blockSize = blockSizes[b];
+                options.readAhead = depths[d];
+                /* the file, the descriptor and the stream return the same lines than the text in memory */
+                textfile = textfopen_ex(path, "r", &options);
+                CHECK(textfile!=NULL && textfile->readAhead!=NULL);
+                checkSameLines(textfile, textfopen_mem(text, size), path);
+                checkSameLines(textfdopen_ex(open(path, O_RDONLY), "r", &options), textfopen_mem(text, size), path);
+                stream = fopen(path, "rb");
+                checkSameLines(textfopen_stream_ex(stream, &options), textfopen_mem(text, size), path);
+                fclose(stream);
+
+                /* moving the read position discards the blocks read in advance */
+                textfile = textfopen_ex(path, "r", &options);
+                expected = textfopen_mem(text, size);
+                CHECK_LONG(textfseekline(textfile, 300), 0);
+                CHECK_LONG(textfseekline(expected, 300), 0);
+                CHECK_LONG(textfseekline(textfile, 20), 0);
+                CHECK_LONG(textfseekline(expected, 20), 0);
+                CHECK_LONG(textftell(textfile, &pos), 0);
+                for (i=0; i<100; ++i) { textfgetline(textfile); }
+                CHECK_LONG(textfseek(textfile, &pos), 0);
+                checkSameLines(textfile, expected, path);
+            }
+        }
+    }
+
+    /* the read-ahead isn't used with mapped files */
+    memset(&options, 0, sizeof(options));
+    options.readAhead = 2;
+    textfile = textfopen_ex(path, "rm", &options);
+    CHECK(textfile!=NULL && textfile->readAhead==NULL);
+    textfclose(textfile);
+
+    /* the file is closed before its end while the background thread is waiting (it's stopped) */
+    options.blockSize = 16;
+    for (i=0; i<20; ++i) {
+        textfile = textfopen_ex(path, "r", &options);
+        CHECK(textfgetline(textfile)!=NULL);
+        textfclose(textfile);
+    }
+
+    /* a pipe can be read in advance but it can't be repositioned */
+    if (CHECK(pipe(fds)==0)) {
+        CHECK(write(fds[1], "one\ntwo\nthree\n", 14)==14);
+        close(fds[1]);
+        textfile = textfdopen_ex(fds[0], "r", &options);
+        CHECK(textfile!=NULL && textfile->readAhead!=NULL);
+        CHECK(textfgetline(textfile)!=NULL);
+        CHECK_LONG(textftell(textfile, &pos), 0);
+        CHECK(textfseek(textfile, &pos)!=0);
+        expected = textfopen_mem("one\ntwo\nthree\n", 14);
+        CHECK(textfgetline(expected)!=NULL);
+        checkSameLines(textfile, expected, "(pipe)");
+    }
+    return testResult("readahead");
+}
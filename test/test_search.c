@@ -0,0 +1,222 @@
+/**
+ * @file       test_search.c
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  Checks textfsearch_find and textfgetmatch against a naive search: the
+ *  occurrence that ends first, the lines containing any pattern (with and
+ *  without TEXTF_SEARCH_IGNORECASE), the patterns that are rejected and
+ *  the allocator hooks used by textfsearch_new_ex
+ * -------------------------------------------------------------------------
+ */
+
+/* includes the 'textfile.h' library and its implementation */
+#define TEXTFILE_IMPLEMENTATION
+#include "../textfile.h"
+#include "testing.h"
+
+#define MAX_TEXT (16*1024)
+
+/** Sets of patterns: a few first bytes (searched with SIMD), many first bytes, prefixes of other patterns */
+static const char* const patternSets[][6] = {
+    { "abc", "cab", NULL },
+    { "b", "ca", "acb", "d", "e", "f" },
+    { "aaaa", "aa", "abab", NULL },
+    { "ab", "abcab", "bcabc", "cabca", NULL }
+};
+
+/**
+ * Returns TRUE if the letters are equal (ignoring the case of the ASCII letters if 'ignoreCase' is TRUE)
+ */
+static int isSameChar(int a, int b, int ignoreCase) {
+    if (ignoreCase && 'A'<=a && a<='Z') { a += 'a'-'A'; }
+    if (ignoreCase && 'A'<=b && b<='Z') { b += 'a'-'A'; }
+    return a==b;
+}
+
+/**
+ * Returns TRUE if the pattern is found at the provided position of the text
+ */
+static int isAt(const char* text, size_t size, size_t pos, const char* pattern, int ignoreCase) {
+    size_t i, length=strlen(pattern);
+    if (pos+length>size) { return 0; }
+    for (i=0; i<length; ++i) { if (!isSameChar(text[pos+i], pattern[i], ignoreCase)) { return 0; } }
+    return 1;
+}
+
+/**
+ * Returns the end of the first occurrence of any pattern in the text or 0 if there is none (naive search)
+ */
+static size_t naiveFind(const char* text, size_t size, const char* const* patterns, int count, int ignoreCase) {
+    size_t end, length; int i;
+    for (end=1; end<=size; ++end) {
+        for (i=0; i<count; ++i) {
+            length = strlen(patterns[i]);
+            if (length<=end && isAt(text, size, end-length, patterns[i], ignoreCase)) { return end; }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Checks textfsearch_find over every suffix of a text
+ */
+static void checkFind(const char* text, size_t size, const char* const* patterns, int count, int flags) {
+    TEXTF_SEARCH* search; const char* found; size_t start, end; int pattern, ignoreCase;
+    search = textfsearch_new(patterns, count, flags);
+    if (!CHECK(search!=NULL)) { return; }
+    ignoreCase = (flags & TEXTF_SEARCH_IGNORECASE)!=0;
+    for (start=0; start<size; start+=7) {
+        end     = naiveFind(&text[start], size-start, patterns, count, ignoreCase);
+        pattern = -1;
+        found   = textfsearch_find(search, &text[start], size-start, &pattern);
+        if (end==0) { CHECK(found==NULL); continue; }
+        /* (when several patterns end at the same position, any of them is valid) */
+        if (CHECK(found!=NULL && pattern>=0 && pattern<count)) {
+            CHECK(isAt(text, size, (size_t)(found-text), patterns[pattern], ignoreCase));
+            CHECK_LONG((found-text) + strlen(patterns[pattern]), start+end);
+        }
+    }
+    textfsearch_free(search);
+}
+
+/**
+ * Reads a file with textfgetmatch and checks that it returns the same lines than reading every line and searching it
+ */
+static void checkGetMatch(TEXTFILE* textfile, TEXTFILE* expected, const char* const* patterns, int count, int flags) {
+    TEXTF_SEARCH* search; const char *line, *expectedLine; size_t length, expectedLength; int pattern, ignoreCase;
+    search = textfsearch_new(patterns, count, flags);
+    if (!CHECK(search!=NULL && textfile!=NULL && expected!=NULL)) {
+        textfsearch_free(search); textfclose(textfile); textfclose(expected); return;
+    }
+    ignoreCase = (flags & TEXTF_SEARCH_IGNORECASE)!=0;
+    while ((expectedLine=textfgetline_n(expected, &expectedLength))!=NULL) {
+        if (naiveFind(expectedLine, expectedLength, patterns, count, ignoreCase)==0) { continue; }
+        line = textfgetmatch(textfile, search, &length, &pattern);
+        if (!CHECK(line!=NULL && length==expectedLength && memcmp(line, expectedLine, length)==0)) { break; }
+        CHECK_LONG(textfile->lineNumber, expected->lineNumber);
+        CHECK(pattern>=0 && pattern<count);
+    }
+    if (!expectedLine) { CHECK(textfgetmatch(textfile, search, &length, NULL)==NULL); }
+    textfsearch_free(search);
+    textfclose(textfile);
+    textfclose(expected);
+}
+
+/**
+ * Writes a text with few different letters (so that the patterns are found often and partially)
+ * @returns the size of the text in bytes
+ */
+static size_t randomText(char* text, size_t maxSize, unsigned long seed, int isMixedCase) {
+    static const char letters[] = "aaaabbbccdef";
+    size_t size=0; char c;
+    while (size<maxSize) {
+        seed = seed*1103515245ul + 12345ul;
+        c    = letters[(seed>>16) % (sizeof(letters)-1)];
+        if (isMixedCase && (seed>>24)%2) { c = (char)(c-'a'+'A'); }
+        text[size++] = ((seed>>8)%23==0) ? '\n' : ((seed>>8)%97==1) ? '\r' : c;
+    }
+    return size;
+}
+
+/** Counts the blocks allocated through the hooks, failing when 'limit' allocations are reached (-1 = no limit) */
+typedef struct Allocator {
+    long allocations;
+    long blocks;
+    long limit;
+} Allocator;
+
+static void* countingMalloc(void* allocatorData, size_t size) {
+    Allocator* allocator = (Allocator*)allocatorData; void* ptr;
+    if (allocator->limit>=0 && allocator->allocations>=allocator->limit) { return NULL; }
+    ptr = malloc(size);
+    if (ptr) { ++allocator->allocations; ++allocator->blocks; }
+    return ptr;
+}
+
+static void countingFree(void* allocatorData, void* ptr) {
+    Allocator* allocator = (Allocator*)allocatorData;
+    if (ptr) { --allocator->blocks; }
+    free(ptr);
+}
+
+/**
+ * Creates a search with the allocator hooks and checks that every block is released when the search is freed
+ * @param limit  Number of allocations before the allocator starts to fail (-1 = no limit)
+ * @returns      The number of allocations made
+ */
+static long checkAllocator(const char* const* patterns, int count, long limit) {
+    Allocator allocator; TEXTF_OPTIONS options; TEXTF_SEARCH* search; int pattern;
+    allocator.allocations = allocator.blocks = 0; allocator.limit = limit;
+    memset(&options, 0, sizeof(options));
+    options.mallocFunc    = countingMalloc;
+    options.freeFunc      = countingFree;
+    options.allocatorData = &allocator;
+    search = textfsearch_new_ex(patterns, count, 0, &options);
+    if (search) {
+        CHECK(textfsearch_find(search, "xxcabx", 6, &pattern)!=NULL && pattern==1);
+        textfsearch_free(search);
+    }
+    else { CHECK(limit>=0); }
+    CHECK_LONG(allocator.blocks, 0);
+    return allocator.allocations;
+}
+
+int main(void) {
+    static const int blockSizes[] = { 0, 16, 17 };
+    static char text[MAX_TEXT], utf16[2*MAX_TEXT];
+    static const char* const invalid[] = { "ok", "a\nb" };
+    static const char* const empty[]   = { "" };
+    char path[256], path16[256]; TEXTF_OPTIONS options; TEXTF_SEARCH* search; const char* found;
+    size_t size, i, s; int count, flags, b, pattern; long allocations, limit;
+
+    /* the patterns can't contain end-of-lines */
+    CHECK(textfsearch_new(invalid, 2, 0)==NULL);
+    CHECK(textfsearch_new(&invalid[1], 1, TEXTF_SEARCH_IGNORECASE)==NULL);
+
+    /* an empty pattern is found at the beginning of the text */
+    search = textfsearch_new(empty, 1, 0);
+    if (CHECK(search!=NULL)) {
+        found = textfsearch_find(search, "abc", 3, &pattern);
+        CHECK(found!=NULL && strcmp(found, "abc")==0 && pattern==0);
+        textfsearch_free(search);
+    }
+    /* no patterns, nothing is found */
+    search = textfsearch_new(NULL, 0, 0);
+    if (CHECK(search!=NULL)) { CHECK(textfsearch_find(search, "abc", 3, NULL)==NULL); textfsearch_free(search); }
+
+    /* the memory of the search comes from the allocator hooks (and nothing leaks when they fail) */
+    allocations = checkAllocator(patternSets[0], 2, -1);
+    CHECK(allocations>0);
+    for (limit=0; limit<allocations; ++limit) { checkAllocator(patternSets[0], 2, limit); }
+
+    for (flags=0; flags<=TEXTF_SEARCH_IGNORECASE; flags+=TEXTF_SEARCH_IGNORECASE) {
+        size = randomText(text, MAX_TEXT, 5+flags, flags!=0);
+        testWriteFile(path, "search.txt", text, size);
+        for (i=0; i<size; ++i) { utf16[2*i] = text[i]; utf16[2*i+1] = 0; }
+        testWriteFile(path16, "search16.txt", utf16, 2*size);
+
+        for (s=0; s<sizeof(patternSets)/sizeof(patternSets[0]); ++s) {
+            for (count=0; count<6 && patternSets[s][count]; ++count) { }
+            checkFind(text, 1000, patternSets[s], count, flags);
+
+            /* buffered (several block sizes), mapped, in memory and in UTF-16 */
+            memset(&options, 0, sizeof(options));
+            for (b=0; b<(int)(sizeof(blockSizes)/sizeof(blockSizes[0])); ++b) {
+                options.blockSize = blockSizes[b];
+                checkGetMatch(textfopen_ex(path, "r", &options), textfopen(path, "r"), patternSets[s], count, flags);
+            }
+            checkGetMatch(textfopen(path, "rm"), textfopen(path, "r"), patternSets[s], count, flags);
+            checkGetMatch(textfopen_mem(text, size), textfopen(path, "r"), patternSets[s], count, flags);
+            checkGetMatch(textfopen(path16, "r"), textfopen(path16, "r"), patternSets[s], count, flags);
+            /* the long lines are split (the pieces are searched one by one) */
+            options.blockSize     = 0;
+            options.maxBufferSize = 64;
+            checkGetMatch(textfopen_ex(path, "r", &options), textfopen_ex(path, "r", &options),
+                          patternSets[s], count, flags);
+        }
+    }
+    return testResult("search");
+}
@@ -0,0 +1,113 @@
+/**
+ * @file       test_stats.c
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  Checks the performance counters returned by textfstats: the bytes read,
+ *  the refills, the growths of the buffer, the lines and the longest line
+ *  (reading line by line, in batches and only counting the lines)
+ * -------------------------------------------------------------------------
+ */
+
+/* collects the performance counters */
+#define TEXTFILE_STATS
+
+/* includes the 'textfile.h' library and its implementation */
+#define TEXTFILE_IMPLEMENTATION
+#include "../textfile.h"
+#include "testing.h"
+
+#define MAX_TEXT (32*1024)
+#define LONGEST  3000
+
+/**
+ * Reads all the lines of a file and checks the counters that don't depend on how the file is read
+ * @param bytesRead  The bytes expected to be read from the file (-1 = the size of the file)
+ * @param blockSize  The block size used to read the file (0 = the default)
+ * @param isBatch    TRUE to read the lines in batches with `textfgetlines(..)`
+ */
+static void checkStats(TEXTFILE* textfile, size_t size, long lineCount, long longestLine, long bytesRead,
+                       int blockSize, int isBatch) {
+    TEXTF_STATS stats; TEXTF_SPAN spans[8]; size_t length;
+    if (!CHECK(textfile!=NULL)) { return; }
+    CHECK_LONG(textfstats(textfile, &stats), 0);
+    CHECK_LONG(stats.lineCount, 0);
+    if (isBatch) { while (textfgetlines(textfile, spans, 8)>0) { } }
+    else         { while (textfgetline_n(textfile, &length)!=NULL) { } }
+    CHECK_LONG(textfstats(textfile, &stats), 0);
+    CHECK_LONG(stats.lineCount, lineCount);
+    CHECK_LONG(stats.longestLine, longestLine);
+    CHECK_LONG(stats.bytesRead, bytesRead<0 ? (long)size : bytesRead);
+    if (bytesRead!=0) {
+        /* (each refill reads one block at most) */
+        CHECK(stats.refills>=1);
+        if (blockSize>0) { CHECK(stats.refills>=(long)size/blockSize); }
+        CHECK(stats.peakBufferSize>=longestLine);
+        CHECK(stats.bufferGrowths>0 || longestLine<TEXTFILE_INI_BUFSIZE);
+    }
+    CHECK(stats.detectTime>=0 && stats.refillTime>=0 && stats.scanTime>=0);
+    textfclose(textfile);
+}
+
+/**
+ * Writes a text with short lines, and a long line in the middle of it
+ * @returns the size of the text in bytes
+ */
+static size_t randomText(char* text, size_t maxSize, unsigned long seed, long* out_lineCount) {
+    size_t size=0; int length; long lines=1;
+    while (size<(maxSize-LONGEST-100)) {
+        seed   = seed*1103515245ul + 12345ul;
+        length = lines==100 ? LONGEST : (int)((seed>>16) % 80);
+        while (length-->0) { seed = seed*1103515245ul + 12345ul; text[size++] = (char)('a' + (seed>>16)%26); }
+        text[size++] = '\n'; ++lines;
+    }
+    (*out_lineCount) = lines;
+    return size;
+}
+
+int main(void) {
+    static char text[MAX_TEXT];
+    char path[256]; TEXTF_OPTIONS options; TEXTF_STATS stats; TEXTFILE* textfile; size_t size; long lineCount;
+
+    /* (the text after the last end-of-line is one more line, an empty one) */
+    size = randomText(text, MAX_TEXT, 17, &lineCount);
+    testWriteFile(path, "stats.txt", text, size);
+
+    /* buffered with several block sizes, line by line and in batches */
+    memset(&options, 0, sizeof(options));
+    checkStats(textfopen_ex(path, "r", &options), size, lineCount, LONGEST, -1, 0, 0);
+    checkStats(textfopen_ex(path, "r", &options), size, lineCount, LONGEST, -1, 0, 1);
+    options.blockSize = 16;
+    checkStats(textfopen_ex(path, "r", &options), size, lineCount, LONGEST, -1, 16, 1);
+    options.blockSize = 100;
+    checkStats(textfopen_ex(path, "r", &options), size, lineCount, LONGEST, -1, 100, 0);
+
+    /* a mapped file and a text in memory aren't read */
+    checkStats(textfopen(path, "rm"), size, lineCount, LONGEST, 0, 0, 0);
+    checkStats(textfopen_mem(text, size), size, lineCount, LONGEST, 0, 0, 1);
+
+    /* the long line split by the maximum buffer size (and the buffer doesn't grow beyond it) */
+    options.blockSize     = 0;
+    options.maxBufferSize = 1024;
+    textfile = textfopen_ex(path, "r", &options);
+    while (textfgetline(textfile)) { }
+    if (CHECK(textfstats(textfile, &stats)==0)) {
+        CHECK(stats.lineCount>lineCount);
+        CHECK(stats.longestLine<1024);
+        CHECK(stats.peakBufferSize<=1024);
+    }
+    textfclose(textfile);
+
+    /* only counting the lines */
+    textfile = textfopen(path, "r");
+    if (CHECK(textfile!=NULL)) {
+        CHECK_LONG(textfcountlines(textfile, NULL), lineCount);
+        CHECK(textfstats(textfile, &stats)==0);
+        CHECK_LONG(stats.lineCount, lineCount);
+        CHECK_LONG(stats.bytesRead, size);
+        textfclose(textfile);
+    }
+    return testResult("stats");
+}
@@ -0,0 +1,177 @@
+/**
+ * @file       test_tail.c
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  Checks the backward reading: textfseektail returns the same last lines
+ *  than reading the whole file, textfgetprevline returns them newest-first
+ *  and the lines are numbered from the end until the beginning is reached
+ * -------------------------------------------------------------------------
+ */
+
+/* pipe() is a POSIX extension */
+#define _XOPEN_SOURCE 700
+
+/* includes the 'textfile.h' library and its implementation */
+#define TEXTFILE_IMPLEMENTATION
+#include "../textfile.h"
+#include "testing.h"
+
+#include <unistd.h>
+
+#define MAX_TEXT  (32*1024)
+#define MAX_LINES 4096
+
+/** The lines of the file read forward (the reference) */
+static char   lineData[2*MAX_TEXT];
+static size_t lineStarts[MAX_LINES], lineLengths[MAX_LINES];
+static long   lineCount;
+
+/**
+ * Reads all the lines of a file forward and keeps them as the reference (the file is closed)
+ */
+static void readReference(TEXTFILE* textfile) {
+    const char* line; size_t length, size=0;
+    lineCount = 0;
+    if (!CHECK(textfile!=NULL)) { return; }
+    while ((line=textfgetline_n(textfile, &length))!=NULL && lineCount<MAX_LINES) {
+        memcpy(&lineData[size], line, length);
+        lineStarts[lineCount] = size; lineLengths[lineCount] = length; ++lineCount;
+        size += length;
+    }
+    textfclose(textfile);
+}
+
+/**
+ * Returns TRUE if the line is the provided line of the reference (starting at 0)
+ */
+static int isLine(const char* line, size_t length, long index) {
+    return line!=NULL && 0<=index && index<lineCount &&
+           length==lineLengths[index] && memcmp(line, &lineData[lineStarts[index]], length)==0;
+}
+
+/**
+ * Checks textfseektail with several counts and textfgetprevline from the end to the beginning of the file
+ * @param open  Function that opens the file (it's called once for each check)
+ */
+static void checkTail(TEXTFILE* (*open)(void), const char* name) {
+    static const long counts[] = { 0, 1, 2, 3, 50, -1, -2, -3 };
+    TEXTFILE* textfile; const char* line; size_t length; long count, i, c;
+
+    /* the last lines (also all of them and more than all of them) */
+    for (c=0; c<(long)(sizeof(counts)/sizeof(counts[0])); ++c) {
+        /* (-1 = all the lines but one, -2 = all the lines, -3 = more lines than the file has) */
+        count    = counts[c]>=0 ? counts[c] : lineCount + counts[c] + 2 + (counts[c]==-3 ? 6 : 0);
+        textfile = open();
+        if (!CHECK(textfile!=NULL)) { return; }
+        if (!CHECK_LONG(textfseektail(textfile, count), 0)) { textfclose(textfile); continue; }
+        for (i=(count<lineCount ? lineCount-count : 0); i<lineCount; ++i) {
+            line = textfgetline_n(textfile, &length);
+            if (!CHECK(isLine(line, length, i))) { fprintf(stderr, "  line %ld of '%s'\n", i+1, name); break; }
+            CHECK_LONG(textfile->lineNumber, count<lineCount ? i-lineCount : i+1);
+        }
+        CHECK(textfgetline_n(textfile, &length)==NULL);
+        textfclose(textfile);
+    }
+    /* the lines newest-first, and each one is read again forward from the position left */
+    textfile = open();
+    if (!CHECK(textfile!=NULL)) { return; }
+    CHECK_LONG(textfseektail(textfile, 0), 0);
+    for (i=lineCount-1; i>=0; --i) {
+        line = textfgetprevline(textfile, &length);
+        if (!CHECK(isLine(line, length, i))) { fprintf(stderr, "  line %ld of '%s' (backward)\n", i+1, name); break; }
+        CHECK_LONG(textfile->lineNumber+1, i-lineCount);
+        if (i%7==0) {
+            line = textfgetline_n(textfile, &length);
+            CHECK(isLine(line, length, i));
+            CHECK(isLine(textfgetprevline(textfile, &length), length, i));
+        }
+    }
+    CHECK(textfgetprevline(textfile, &length)==NULL);
+    CHECK(textfgetprevline(textfile, &length)==NULL);
+    /* (the beginning of the file is still readable forward) */
+    if (lineCount>0) { line = textfgetline_n(textfile, &length); CHECK(isLine(line, length, 0)); }
+    textfclose(textfile);
+}
+
+static char        text[MAX_TEXT];
+static size_t      textSize;
+static char        path[256];
+static TEXTF_OPTIONS options;
+
+static TEXTFILE* openBuffered(void) { return textfopen_ex(path, "r", &options); }
+static TEXTFILE* openMapped(void)   { return textfopen(path, "rm"); }
+static TEXTFILE* openMemory(void)   { return textfopen_mem(text, textSize); }
+
+/**
+ * Writes a text with lines of random lengths (some longer than the blocks read backward) and the provided end-of-line
+ * @returns the size of the text in bytes
+ */
+static size_t randomText(char* dest, size_t maxSize, unsigned long seed, const char* eol, int isUtf16) {
+    size_t size=0, unit=isUtf16 ? 2 : 1, i; int length;
+    if (isUtf16) { dest[size++] = '\xFF'; dest[size++] = '\xFE'; }
+    while (size<(maxSize-3000)) {
+        seed   = seed*1103515245ul + 12345ul;
+        length = (int)((seed>>16) % ((seed>>8)%16==0 ? 1200 : 40));
+        while (length-->0) {
+            seed = seed*1103515245ul + 12345ul;
+            dest[size] = (char)('a' + (seed>>16)%26); if (isUtf16) { dest[size+1] = 0; } size += unit;
+        }
+        for (i=0; eol[i]; ++i) { dest[size] = eol[i]; if (isUtf16) { dest[size+1] = 0; } size += unit; }
+    }
+    return size;
+}
+
+int main(void) {
+    static const char* const eols[] = { "\n", "\r\n", "\r" };
+    static const int blockSizes[] = { 0, 16, 17 };
+    TEXTFILE* textfile; size_t length; int e, b, isUtf16, isLastEol, fds[2];
+
+    for (isUtf16=0; isUtf16<=1; ++isUtf16) {
+        for (e=0; e<(int)(sizeof(eols)/sizeof(eols[0])); ++e) {
+            for (isLastEol=0; isLastEol<=1; ++isLastEol) {
+                textSize = randomText(text, MAX_TEXT, 11+e, eols[e], isUtf16);
+                /* (without the last end-of-line the file ends with the text of the last line) */
+                if (!isLastEol) { textSize -= strlen(eols[e]) * (isUtf16 ? 2 : 1); }
+                testWriteFile(path, "tail.txt", text, textSize);
+                readReference(textfopen_mem(text, textSize));
+
+                memset(&options, 0, sizeof(options));
+                for (b=0; b<(int)(sizeof(blockSizes)/sizeof(blockSizes[0])); ++b) {
+                    options.blockSize = blockSizes[b];
+                    checkTail(openBuffered, path);
+                }
+                checkTail(openMapped, path);
+                checkTail(openMemory, "(memory)");
+            }
+        }
+    }
+    /* an empty file and a file with only one end-of-line */
+    textSize = 0;
+    testWriteFile(path, "tail.txt", text, textSize);
+    readReference(textfopen(path, "r"));
+    checkTail(openBuffered, path);
+    checkTail(openMapped, path);
+    checkTail(openMemory, "(memory)");
+    text[0] = '\n'; textSize = 1;
+    testWriteFile(path, "tail.txt", text, textSize);
+    readReference(textfopen(path, "r"));
+    checkTail(openBuffered, path);
+    checkTail(openMapped, path);
+    checkTail(openMemory, "(memory)");
+
+    /* a pipe can't be read backward */
+    if (CHECK(pipe(fds)==0)) {
+        CHECK(write(fds[1], "one\ntwo\n", 8)==8);
+        close(fds[1]);
+        textfile = textfdopen(fds[0], "r");
+        if (CHECK(textfile!=NULL)) {
+            CHECK(textfseektail(textfile, 1)!=0);
+            CHECK(textfgetprevline(textfile, &length)==NULL);
+            textfclose(textfile);
+        }
+    }
+    return testResult("tail");
+}
@@ -0,0 +1,125 @@
+/**
+ * @file       test_tell.c
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  Checks textftell and textfseek: a position taken after any line resumes
+ *  the reading at the next line, also in the middle of a "\r\n" pair whose
+ *  second half is appended to the file later
+ * -------------------------------------------------------------------------
+ */
+
+/* includes the 'textfile.h' library and its implementation */
+#define TEXTFILE_IMPLEMENTATION
+#include "../textfile.h"
+#include "testing.h"
+
+#define MAX_TEXT   1024
+#define MAX_LINES  256
+#define MAX_LENGTH 256
+
+/** Texts mixing every end-of-line (the pairs are split across refills by the small blocks) */
+static const char* const texts[] = {
+    "one\r\ntwo\r\nthree\r\n",
+    "one\r\r\ntwo\n\n\rthree\r\n\r\nfour",
+    "mixed\rold mac\nunix\r\nwindows\n\racorn\r\n"
+};
+
+/**
+ * Reads a file taking its position after each line, then resumes the reading from each position in a new
+ * TEXTFILE object and checks that it returns the same next line (with the same number)
+ */
+static void checkResume(const char* path, const TEXTF_OPTIONS* options) {
+    static TEXTF_POS positions[MAX_LINES]; static char lines[MAX_LINES][MAX_LENGTH]; size_t lengths[MAX_LINES];
+    TEXTFILE *textfile, *resumed; const char* line; size_t length; int count=0, i;
+
+    textfile = textfopen_ex(path, "r", options);
+    if (!CHECK(textfile!=NULL)) { return; }
+    CHECK_LONG(textftell(textfile, &positions[0]), 0);
+    while ((line=textfgetline_n(textfile, &length))!=NULL && count<(MAX_LINES-1) && length<MAX_LENGTH) {
+        memcpy(lines[count], line, length); lengths[count++] = length;
+        CHECK_LONG(textftell(textfile, &positions[count]), 0);
+    }
+    textfclose(textfile);
+
+    for (i=0; i<=count; ++i) {
+        resumed = textfopen_ex(path, "r", options);
+        if (!CHECK(resumed!=NULL)) { return; }
+        CHECK_LONG(textfseek(resumed, &positions[i]), 0);
+        CHECK_LONG(resumed->lineNumber, i);
+        line = textfgetline_n(resumed, &length);
+        if (i<count) {
+            if (!CHECK(line!=NULL && length==lengths[i] && memcmp(line, lines[i], length)==0)) {
+                fprintf(stderr, "  resuming after line %d of '%s'\n", i, path);
+            }
+            CHECK_LONG(resumed->lineNumber, i+1);
+        }
+        else { CHECK(line==NULL); }
+        textfclose(resumed);
+    }
+}
+
+/**
+ * Follows a file whose last end-of-line is the first half of a pair, takes the position and resumes it (in a new
+ * TEXTFILE object) after the rest of the text is appended
+ * @param first     The text of the file when the position is taken
+ * @param second    The text appended later
+ * @param expected  The line expected after the position (the second line of the file)
+ */
+static void checkPendingEol(const char* first, size_t firstSize, const char* second, size_t secondSize,
+                            const char* expected) {
+    char path[256]; TEXTFILE* textfile; TEXTF_POS pos; const char* line; size_t length; FILE* file;
+
+    textfile = textfopen(testWriteFile(path, "tell.txt", first, firstSize), "rf");
+    if (!CHECK(textfile!=NULL)) { return; }
+    line = textfgetline_n(textfile, &length);
+    CHECK(line!=NULL);
+    CHECK(textfgetline_n(textfile, &length)==NULL);
+    CHECK_LONG(textftell(textfile, &pos), 0);
+    textfclose(textfile);
+
+    file = fopen(path, "ab");
+    fwrite(second, 1, secondSize, file);
+    fclose(file);
+
+    textfile = textfopen(path, "r");
+    CHECK_LONG(textfseek(textfile, &pos), 0);
+    line = textfgetline_n(textfile, &length);
+    CHECK_TEXT(line, length, expected);
+    CHECK_LONG(textfile->lineNumber, 2);
+    textfclose(textfile);
+}
+
+int main(void) {
+    static const int blockSizes[] = { 16, 17, 0 };
+    char text[MAX_TEXT], path[256]; TEXTF_OPTIONS options; size_t t, b, padding;
+
+    /* every text is moved (adding a prefix) so that each end-of-line lands at each position of a refill */
+    for (t=0; t<sizeof(texts)/sizeof(texts[0]); ++t) {
+        for (padding=0; padding<20; ++padding) {
+            memset(text, 'x', padding);
+            strcpy(&text[padding], texts[t]);
+            testWriteFile(path, "tell.txt", text, strlen(text));
+            for (b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); ++b) {
+                memset(&options, 0, sizeof(options));
+                options.blockSize  = blockSizes[b];
+                options.bufferSize = blockSizes[b];
+                checkResume(path, &options);
+            }
+        }
+    }
+    /* the fixtures in UTF-16 are resumed at the same lines */
+    checkResume("utf16le.txt", NULL);
+    checkResume("utf16be-bom.txt", NULL);
+
+    /* the position is taken between the two halves of a pair */
+    checkPendingEol("one\r", 4, "\ntwo\n", 5, "two");
+    checkPendingEol("one\n", 4, "\rtwo\n", 5, "two");
+    checkPendingEol("one\r", 4, "\rtwo\n", 5, "");
+    checkPendingEol("one\n", 4, "\ntwo\n", 5, "");
+    checkPendingEol("\xFF\xFEo\0n\0e\0\r\0", 10, "\n\0t\0w\0o\0\n\0", 10, "two");
+
+    return testResult("tell");
+}
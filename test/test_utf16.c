@@ -0,0 +1,125 @@
+/**
+ * @file       test_utf16.c
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  Checks the UTF-16 decoders, specially the code units and the surrogate
+ *  pairs split across two refills of the raw buffer
+ * -------------------------------------------------------------------------
+ */
+
+/* includes the 'textfile.h' library and its implementation */
+#define TEXTFILE_IMPLEMENTATION
+#include "../textfile.h"
+#include "testing.h"
+
+#define MAX_TEXT  4096
+#define MAX_LINES 256
+
+/** UTF-8 texts with characters of 1, 2, 3 and 4 bytes (the last ones are surrogate pairs in UTF-16) */
+static const char* const texts[] = {
+    "\xF0\x9F\x98\x80\r\n\xF0\x9F\x98\x81\xF0\x9F\x98\x82\r\n\xF0\x9D\x84\x9E clef\n",
+    "caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x8D\xB5\r\nna\xC3\xAFve \xF0\x90\x8D\x88\xF0\x90\x8D\x89\n\r\xE6\x97\xA5\xE6\x9C\xAC",
+    "\xF0\x9F\x98\x80\xF0\x9F\x98\x80\xF0\x9F\x98\x80\xF0\x9F\x98\x80\xF0\x9F\x98\x80\xF0\x9F\x98\x80\xF0\x9F\x98\x80\r"
+};
+
+/** Fixtures that contain the text of 'utf8.txt' in other encodings */
+static const char* const fixtures[] = {
+    "utf8-bom.txt", "utf16le.txt", "utf16be.txt", "utf16le-bom.txt", "utf16be-bom.txt"
+};
+
+/** Options used to read the files, the small blocks split the characters at every position of a refill */
+static const int blockSizes[] = { 16, 17, 18, 19, 0 };
+
+/**
+ * Encodes a UTF-8 text in UTF-16 (with its byte order mark)
+ * @returns the size of the UTF-16 text in bytes
+ */
+static size_t encodeUtf16(char* dest, const char* text, int isBigEndian) {
+    const unsigned char* ptr = (const unsigned char*)text; unsigned long c, units[2]; size_t size=0; int n, i;
+    units[0] = 0xFEFF; n = 1;
+    do {
+        for (i=0; i<n; ++i) {
+            dest[size++] = (char)(isBigEndian ? (units[i]>>8) : (units[i] & 0xFF));
+            dest[size++] = (char)(isBigEndian ? (units[i] & 0xFF) : (units[i]>>8));
+        }
+        if (*ptr=='\0') { break; }
+        if      (*ptr<0x80) { c = ptr[0]; ptr+=1; }
+        else if (*ptr<0xE0) { c = ((ptr[0] & 0x1Ful)<<6)  | (ptr[1] & 0x3F); ptr+=2; }
+        else if (*ptr<0xF0) { c = ((ptr[0] & 0x0Ful)<<12) | ((ptr[1] & 0x3Ful)<<6)  | (ptr[2] & 0x3F); ptr+=3; }
+        else                { c = ((ptr[0] & 0x07ul)<<18) | ((ptr[1] & 0x3Ful)<<12) | ((ptr[2] & 0x3Ful)<<6) | (ptr[3] & 0x3F); ptr+=4; }
+        if (c<0x10000) { units[0] = c; n = 1; }
+        else           { c -= 0x10000; units[0] = 0xD800 | (c>>10); units[1] = 0xDC00 | (c & 0x3FF); n = 2; }
+    } while (1);
+    return size;
+}
+
+/**
+ * Reads the lines of a file and checks that they are the lines of the reference file
+ */
+static void checkSameLines(TEXTFILE* textfile, TEXTFILE* reference, const char* name) {
+    const char *line, *expected; size_t length, expectedLength;
+    if (!CHECK(textfile!=NULL && reference!=NULL)) { return; }
+    CHECK(textfissupported(textfile));
+    do {
+        expected = textfgetline_n(reference, &expectedLength);
+        line     = textfgetline_n(textfile, &length);
+        if (!CHECK(expected==NULL ? line==NULL : (line!=NULL && length==expectedLength &&
+                                                   memcmp(line, expected, length)==0))) {
+            fprintf(stderr, "  line %ld of '%s'\n", reference->lineNumber, name);
+            break;
+        }
+    } while (expected!=NULL);
+    CHECK_LONG(textfile->lineNumber, reference->lineNumber);
+}
+
+int main(void) {
+    char text[MAX_TEXT], utf16[2*MAX_TEXT], path[256]; TEXTF_OPTIONS options; TEXTFILE *textfile, *reference;
+    size_t t, f, b, padding, size; int isBigEndian;
+
+    /* the fixtures in UTF-16 are decoded to the same lines than the fixture in UTF-8 */
+    for (f=0; f<sizeof(fixtures)/sizeof(fixtures[0]); ++f) {
+        for (b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); ++b) {
+            memset(&options, 0, sizeof(options));
+            options.blockSize = blockSizes[b];
+            textfile  = textfopen_ex(fixtures[f], "r", &options);
+            reference = textfopen("utf8.txt", "r");
+            checkSameLines(textfile, reference, fixtures[f]);
+            if (textfile)  { textfclose(textfile);  }
+            if (reference) { textfclose(reference); }
+        }
+        textfile  = textfopen(fixtures[f], "rm");
+        reference = textfopen("utf8.txt", "rm");
+        checkSameLines(textfile, reference, fixtures[f]);
+        if (textfile)  { textfclose(textfile);  }
+        if (reference) { textfclose(reference); }
+    }
+
+    /* every text is moved (adding a prefix) so that each surrogate pair lands at each position of a refill */
+    for (t=0; t<sizeof(texts)/sizeof(texts[0]); ++t) {
+        for (padding=0; padding<24; ++padding) {
+            memset(text, 'x', padding);
+            strcpy(&text[padding], texts[t]);
+            for (isBigEndian=0; isBigEndian<=1; ++isBigEndian) {
+                size = encodeUtf16(utf16, text, isBigEndian);
+                testWriteFile(path, "utf16.txt", utf16, size);
+                for (b=0; b<sizeof(blockSizes)/sizeof(blockSizes[0]); ++b) {
+                    memset(&options, 0, sizeof(options));
+                    options.blockSize = blockSizes[b];
+                    textfile  = textfopen_ex(path, "r", &options);
+                    reference = textfopen_mem(text, strlen(text));
+                    if (CHECK(textfile!=NULL)) {
+                        CHECK_LONG(textfile->encoding, isBigEndian ? TEXTF_ENCODING_UTF16_BE_BOM :
+                                                                     TEXTF_ENCODING_UTF16_LE_BOM);
+                    }
+                    checkSameLines(textfile, reference, text);
+                    if (textfile)  { textfclose(textfile);  }
+                    if (reference) { textfclose(reference); }
+                }
+            }
+        }
+    }
+    return testResult("utf16");
+}
@@ -0,0 +1,125 @@
+/**
+ * @file       test_validate.c
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  Checks the validate option: the policies REPORT, REPLACE and STOP, the
+ *  offset and line of the first error, and the valid characters cut by
+ *  the refills of the buffer (they must not be reported)
+ * -------------------------------------------------------------------------
+ */
+
+/* includes the 'textfile.h' library and its implementation */
+#define TEXTFILE_IMPLEMENTATION
+#include "../textfile.h"
+#include "testing.h"
+
+#define MAX_TEXT 4096
+#define BOM      "\xEF\xBB\xBF"
+#define FFFD     "\xEF\xBF\xBD"
+
+/** A text with two errors (the first at offset 17 of line 3) */
+static const char text[] = BOM "good\ncaf\xC3\xA9\nbad\xFFline\nx\xC3(\nend";
+
+static const char* const reported[] = { "good", "caf\xC3\xA9", "bad\xFFline", "x\xC3(", "end", NULL };
+static const char* const replaced[] = { "good", "caf\xC3\xA9", "bad" FFFD "line", "x" FFFD "(", "end", NULL };
+static const char* const stopped[]  = { "good", "caf\xC3\xA9", NULL };
+
+/** Invalid sequences: overlong, surrogate, above U+10FFFF, lone continuation byte and cut character */
+static const char* const invalids[] = { "\xC0\xAF", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\x80", "\xE2\x82" };
+
+/**
+ * Reads a file with the provided options and checks its lines and the error reported
+ * @param lines        The expected lines terminated by NULL (NULL = read the lines without checking them)
+ * @param errorOffset  The expected offset of the first error (-1 = no error)
+ * @param errorLine    The expected line of the first error (0 = no error)
+ */
+static void checkLines(TEXTFILE* textfile, const char* const* lines, long errorOffset, long errorLine) {
+    const char* line; size_t length; int i;
+    if (!CHECK(textfile!=NULL)) { return; }
+    for (i=0; lines && lines[i]; ++i) {
+        line = textfgetline_n(textfile, &length);
+        if (!CHECK_TEXT(line, length, lines[i])) { break; }
+    }
+    if (!lines) { while (textfgetline_n(textfile, &length)!=NULL) { } }
+    CHECK(textfgetline_n(textfile, &length)==NULL);
+    CHECK_LONG(textferror(textfile), errorOffset<0 ? TEXTF_ERROR_NONE : TEXTF_ERROR_INVALID_UTF8);
+    CHECK_LONG(textferroroffset(textfile), errorOffset);
+    CHECK_LONG(textferrorline(textfile), errorLine);
+    textfclose(textfile);
+}
+
+/**
+ * Checks a file in every mode (buffered with several block sizes, mapped and in memory)
+ */
+static void checkModes(const char* data, size_t size, TEXTF_VALIDATE validate,
+                       const char* const* lines, long errorOffset, long errorLine) {
+    static const int blockSizes[] = { 0, 16, 17 };
+    char path[256]; TEXTF_OPTIONS options; int b;
+    testWriteFile(path, "validate.txt", data, size);
+    memset(&options, 0, sizeof(options));
+    options.validate = validate;
+    for (b=0; b<(int)(sizeof(blockSizes)/sizeof(blockSizes[0])); ++b) {
+        options.blockSize = blockSizes[b];
+        checkLines(textfopen_ex(path, "r", &options), lines, errorOffset, errorLine);
+    }
+    options.blockSize = 0;
+    checkLines(textfopen_ex(path, "rm", &options), lines, errorOffset, errorLine);
+    checkLines(textfopen_mem_ex(data, size, &options), lines, errorOffset, errorLine);
+}
+
+/**
+ * Checks that a line containing an invalid sequence is repaired: it's valid UTF-8 and the text around it is kept
+ */
+static void checkRepaired(const char* data, const char* before, const char* after) {
+    TEXTF_OPTIONS options; TEXTFILE* textfile; const char* line; size_t length;
+    memset(&options, 0, sizeof(options));
+    options.validate = TEXTF_VALIDATE_REPLACE;
+    textfile = textfopen_mem_ex(data, strlen(data), &options);
+    if (!CHECK(textfile!=NULL)) { return; }
+    textfgetline_n(textfile, &length);
+    line = textfgetline_n(textfile, &length);
+    if (CHECK(line!=NULL && length>=strlen(before)+strlen(after)+3)) {
+        CHECK(textf__findinvalid(line, line+length)==(line+length));
+        CHECK(memcmp(line, before, strlen(before))==0);
+        CHECK(memcmp(line+length-strlen(after), after, strlen(after))==0);
+        CHECK(memcmp(line+strlen(before), FFFD, 3)==0);
+    }
+    textfclose(textfile);
+}
+
+int main(void) {
+    static char data[MAX_TEXT];
+    static const char* const firstLine[] = { "ok", NULL };
+    size_t size, i;
+
+    /* each policy, and no validation at all */
+    checkModes(text, sizeof(text)-1, TEXTF_VALIDATE_REPORT,  reported, 17, 3);
+    checkModes(text, sizeof(text)-1, TEXTF_VALIDATE_REPLACE, replaced, 17, 3);
+    checkModes(text, sizeof(text)-1, TEXTF_VALIDATE_STOP,    stopped,  17, 3);
+    checkModes(text, sizeof(text)-1, TEXTF_VALIDATE_NONE,    reported, -1, 0);
+
+    /* each kind of invalid sequence is found (at offset 8 of line 2) and repaired */
+    for (i=0; i<sizeof(invalids)/sizeof(invalids[0]); ++i) {
+        sprintf(data, BOM "ok\nab%scd", invalids[i]);
+        checkModes(data, strlen(data), TEXTF_VALIDATE_STOP, firstLine, 8, 2);
+        checkRepaired(data, "ab", "cd");
+    }
+    /* (also when the cut character is at the end of the file) */
+    sprintf(data, BOM "ok\nab\xE2\x82");
+    checkModes(data, strlen(data), TEXTF_VALIDATE_STOP, firstLine, 8, 2);
+    checkRepaired(data, "ab", "");
+
+    /* valid characters of 2, 3 and 4 bytes cut by the refills (of 16 and 17 bytes) aren't reported */
+    for (size=0; size<(MAX_TEXT-64); size+=11) {
+        memcpy(&data[size], "\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80" "a\n", 11);
+    }
+    checkModes(data, size, TEXTF_VALIDATE_STOP, NULL, -1, 0);
+
+    /* without BOM, an error found after the block examined to detect the encoding */
+    memset(data, 'a', 600); memcpy(&data[600], "\nz\xFF\n", 4);
+    checkModes(data, 604, TEXTF_VALIDATE_REPORT, NULL, 602, 2);
+    return testResult("validate");
+}
@@ -0,0 +1,89 @@
+/**
+ * @file       testing.h
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  Minimal checks shared by the tests of the 'textfile.h' library
+ *  (each test is a program that returns 0 when all its checks pass)
+ * -------------------------------------------------------------------------
+ */
+#ifndef TESTING_H_INCLUDED
+#define TESTING_H_INCLUDED
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TESTING_DIR "bin/" /* < directory where the tests write their temporary files */
+
+/** Checks that a condition is TRUE */
+#define CHECK(cond) testCheck((cond)!=0, #cond, __FILE__, __LINE__)
+
+/** Checks that two integers are equal (both values are printed when they aren't) */
+#define CHECK_LONG(actual, expected) testCheckLong((long)(actual), (long)(expected), #actual, __FILE__, __LINE__)
+
+/** Checks that a text with length (not null-terminated) is equal to a null-terminated string */
+#define CHECK_TEXT(actual, length, expected) \
+    testCheckText((actual), (length), (expected), #actual, __FILE__, __LINE__)
+
+static int testChecks   = 0;
+static int testFailures = 0;
+
+static int testCheck(int ok, const char* expression, const char* file, int line) {
+    ++testChecks;
+    if (!ok) { ++testFailures; fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression); }
+    return ok;
+}
+
+static int testCheckLong(long actual, long expected, const char* expression, const char* file, int line) {
+    ++testChecks;
+    if (actual!=expected) {
+        ++testFailures;
+        fprintf(stderr, "%s:%d: check failed: %s is %ld (expected %ld)\n", file, line, expression, actual, expected);
+    }
+    return actual==expected;
+}
+
+static int testCheckText(const char* actual, size_t length, const char* expected,
+                         const char* expression, const char* file, int line) {
+    int ok = actual!=NULL && length==strlen(expected) && memcmp(actual, expected, length)==0;
+    ++testChecks;
+    if (!ok) {
+        ++testFailures;
+        fprintf(stderr, "%s:%d: check failed: %s is \"%.*s\" (expected \"%s\")\n", file, line, expression,
+                actual ? (int)length : 0, actual ? actual : "", expected);
+    }
+    return ok;
+}
+
+/**
+ * Prints the result of the test
+ * @param name  The name of the test
+ * @returns     The exit code of the test program (0 = all checks passed)
+ */
+static int testResult(const char* name) {
+    printf("%-16s %d checks, %d failed\n", name, testChecks, testFailures);
+    return testFailures==0 ? 0 : 1;
+}
+
+/**
+ * Writes a temporary file in the TESTING_DIR directory
+ * @param path  Buffer where the path to the file is returned (at least 256 bytes)
+ * @param name  The name of the file
+ * @param data  The content of the file
+ * @param size  The size of the content in bytes
+ * @returns     The path to the file or NULL if it couldn't be written
+ */
+static const char* testWriteFile(char* path, const char* name, const void* data, size_t size) {
+    FILE* file;
+    sprintf(path, "%s%.200s", TESTING_DIR, name);
+    file = fopen(path, "wb");
+    if (!file) { fprintf(stderr, "can't write the file '%s'\n", path); exit(2); }
+    fwrite(data, 1, size, file);
+    fclose(file);
+    return path;
+}
+
+#endif /* ifndef TESTING_H_INCLUDED */
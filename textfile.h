@@ -34,20 +34,36 @@
 
 #include <assert.h>
 #include <stdio.h>
-#define TEXTFILE_INI_BUFSIZE 512
-#define TEXTFILE_MAX_BUFSIZE (32*1024)
+#ifndef TEXTFILE_INI_BUFSIZE
+#define TEXTFILE_INI_BUFSIZE 512        /* < default initial size of the buffer (it's reserved inside the TEXTFILE object) */
+#endif
+#ifndef TEXTFILE_MAX_BUFSIZE
+#define TEXTFILE_MAX_BUFSIZE 0          /* < default maximum size of the buffer (0 = no limit)                          */
+#endif
+#ifndef TEXTFILE_INDEX_STEP
+#define TEXTFILE_INDEX_STEP  1024       /* < number of lines between two checkpoints of the line index  */
+#endif
+#ifndef TEXTFILE_INDEX_EXT
+#define TEXTFILE_INDEX_EXT   ".tfidx"   /* < extension added to the name of the line index sidecar file */
+#endif
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 
 /*=================================================================================================================*/
 #pragma mark - > TEXTFILE INTERFACE
 
 typedef enum TEXTF_ENCODING {
-    TEXTF_ENCODING_UTF8,         /* < UTF8, ASCI, Windows-1252, ...                 */
+    TEXTF_ENCODING_UTF8,         /* < UTF8, ASCII                                   */
     TEXTF_ENCODING_UTF8_BOM,     /* < UTF8+BOM [confirmed]                          */
     TEXTF_ENCODING_UTF16_LE,     /* < UTF16 little-endian                           */
     TEXTF_ENCODING_UTF16_BE,     /* < UTF16 big-endian                              */
     TEXTF_ENCODING_UTF16_LE_BOM, /* < UTF16+BOM little-endian [confirmed]           */
     TEXTF_ENCODING_UTF16_BE_BOM, /* < UTF16+BOM big-endian [confirmed]              */
+    TEXTF_ENCODING_WINDOWS1252,  /* < Windows-1252 (western european, converted to UTF-8) */
+    TEXTF_ENCODING_ISO8859_1,    /* < ISO-8859-1 / Latin-1 (converted to UTF-8)     */
+    TEXTF_ENCODING_ISO8859_15,   /* < ISO-8859-15 / Latin-9 (converted to UTF-8, only if selected in the options) */
     TEXTF_ENCODING_BINARY        /* < invalid text file (it's likely a binary file) */
 } TEXTF_ENCODING;
 
@@ -59,8 +75,87 @@ typedef enum TEXTF_EOL {
     TEXTF_EOL_UNKNOWN
 } TEXTF_EOL;
 
+typedef enum TEXTF_OVERFLOW {
+    TEXTF_OVERFLOW_SPLIT,    /* < the line is returned in pieces that fit in the buffer        */
+    TEXTF_OVERFLOW_TRUNCATE, /* < only the first piece of the line is returned, the rest is skipped */
+    TEXTF_OVERFLOW_ERROR     /* < reading stops and textferror() reports TEXTF_ERROR_LINE_TOO_LONG */
+} TEXTF_OVERFLOW;
+
+typedef enum TEXTF_VALIDATE {
+    TEXTF_VALIDATE_NONE,    /* < the text is returned as it is in the file (no validation)                  */
+    TEXTF_VALIDATE_REPORT,  /* < invalid UTF-8 is returned as it is, textferror() reports the first error    */
+    TEXTF_VALIDATE_REPLACE, /* < each invalid UTF-8 sequence is replaced by U+FFFD (and reported)           */
+    TEXTF_VALIDATE_STOP     /* < reading stops at the first line containing invalid UTF-8 (and reported)    */
+} TEXTF_VALIDATE;
+
+typedef enum TEXTF_ERROR {
+    TEXTF_ERROR_NONE,
+    TEXTF_ERROR_LINE_TOO_LONG,   /* < a line didn't fit in the maximum buffer size (TEXTF_OVERFLOW_ERROR) */
+    TEXTF_ERROR_INVALID_UTF8,    /* < the file contains invalid UTF-8 (TEXTF_VALIDATE_xxx)                */
+    TEXTF_ERROR_OUT_OF_MEMORY    /* < a buffer couldn't be allocated (see 'mallocFunc' in TEXTF_OPTIONS)  */
+} TEXTF_ERROR;
+
+/** Options used by textfopen_ex() to open a file (any field set to zero takes its default value) */
+typedef struct TEXTF_OPTIONS {
+    int            blockSize;      /* < bytes read from the file in each call (0 = fill the buffer)                */
+    int            bufferSize;     /* < initial size of the buffer (0 = TEXTFILE_INI_BUFSIZE)                     */
+    int            maxBufferSize;  /* < maximum size of the buffer, it limits the length of the lines (0 = TEXTFILE_MAX_BUFSIZE) */
+    TEXTF_OVERFLOW overflow;       /* < what to do with the lines that don't fit in the maximum buffer size       */
+    int            readAhead;      /* < blocks read in advance by a background thread (0 = disabled, "r" mode only) */
+    TEXTF_VALIDATE validate;       /* < what to do with invalid UTF-8 (0 = TEXTF_VALIDATE_NONE, UTF-8 files only) */
+    TEXTF_ENCODING legacyEncoding; /* < single-byte encoding of the files that aren't UTF-8 (0 = detect Windows-1252 or ISO-8859-1) */
+    int            indexFile;      /* < TRUE to keep the line index in a sidecar file (filename + TEXTFILE_INDEX_EXT) */
+    void*        (*mallocFunc)(void* allocatorData, size_t size); /* < allocates memory (NULL = malloc)            */
+    void         (*freeFunc)(void* allocatorData, void* ptr);     /* < releases memory  (NULL = free)              */
+    void*          allocatorData;  /* < pointer passed to 'mallocFunc' and 'freeFunc'                             */
+} TEXTF_OPTIONS;
+
+/** A line returned by textfgetlines() */
+typedef struct TEXTF_SPAN {
+    const char* line;   /* < pointer to the first character of the line (NOT null-terminated) */
+    size_t      length; /* < length of the line in bytes                                      */
+} TEXTF_SPAN;
+
+/** A read position returned by textftell() (its fields are private, it can be stored and restored later with textfseek()) */
+typedef struct TEXTF_POS {
+    long           offset;         /* < offset in the file of the next line to read                                */
+    long           lineNumber;     /* < number of lines read before it                                             */
+    TEXTF_ENCODING encoding;       /* < encoding of the file (restored without detecting it again)                 */
+    TEXTF_EOL      eol;
+    int            pendingEol;     /* < end-of-line just before 'offset' that can be the first half of a pair      */
+    int            isSkippingLine; /* < TRUE if 'offset' is inside a truncated line (its rest is skipped)          */
+    int            isEnd;          /* < TRUE if all the lines were read (only the data appended later is read)     */
+} TEXTF_POS;
+
+/** Performance counters returned by textfstats() (they are collected only when TEXTFILE_STATS is defined) */
+typedef struct TEXTF_STATS {
+    long           bytesRead;      /* < bytes read from the file (the files mapped in memory aren't read)         */
+    long           refills;        /* < number of reads made to refill the buffer                                 */
+    long           bytesMoved;     /* < bytes moved to the beginning of the buffers before each refill            */
+    long           bufferGrowths;  /* < number of times the buffer was expanded to fit a long line                */
+    long           peakBufferSize; /* < largest size reached by the buffer                                        */
+    long           longestLine;    /* < length in bytes of the longest line read                                  */
+    long           lineCount;      /* < number of lines read (including the lines skipped by seeks and searches)  */
+    double         detectTime;     /* < seconds spent detecting the encoding and the end-of-line                  */
+    double         refillTime;     /* < seconds spent refilling the buffer (reading and decoding the data)        */
+    double         scanTime;       /* < seconds spent finding the lines in the buffer (excluding the refills)     */
+} TEXTF_STATS;
+
+/** Number of end-of-lines of each style returned by textfcountlines() */
+typedef struct TEXTF_EOLCOUNTS {
+    long           cr;             /* < lone '\r' (Classic Mac OS)                                                 */
+    long           crlf;           /* < '\r\n' pairs (Windows)                                                     */
+    long           lf;             /* < lone '\n' (Unix)                                                           */
+    long           lfcr;           /* < '\n\r' pairs (Acorn BBC / RISC OS)                                         */
+} TEXTF_EOLCOUNTS;
+
+struct TEXTF__READAHEAD;
+
 typedef struct TEXTFILE {
     FILE*          file;
+    int            fd;             /* < file descriptor read directly (textfdopen) or -1                        */
+    unsigned int   isFileOwned;    /* < TRUE if 'file' is closed by textfclose() (FALSE for textfopen_stream)   */
+    struct TEXTF__READAHEAD* readAhead; /* < background thread reading the next blocks of the file or NULL     */
     char*          buffer;
     int            bufferSize;
     char*          bufferEnd;
@@ -70,24 +165,221 @@ typedef struct TEXTFILE {
     unsigned int   moreDataAvailable;
     unsigned int   isEncodingSupported;
     char*          expandedBuffer;
+    char*          mapping;        /* < read-only memory mapping of the whole file ("rm" mode) or NULL */
+    size_t         mappingSize;
+    unsigned int   isMappingOwned; /* < TRUE if 'mapping' is unmapped by textfclose() (FALSE for textfopen_mem) */
+    char*          lineBuffer;     /* < copy of the last line (textfgetline() in "rm" mode or repaired UTF-8) */
+    size_t         lineBufferSize;
+    unsigned int   isBufferReadOnly;
+    /* decoding of non UTF-8 files (the raw data comes from 'rawBuffer' or directly from the 'mapping') */
+    int          (*decoder)(struct TEXTFILE* textfile, char* dest, int destSize);
+    char*          rawBuffer;
+    int            rawBufferSize;
+    const unsigned char* rawNext;
+    const unsigned char* rawEnd;
+    unsigned int   moreRawDataAvailable;
+    /* position & line index */
+    char*          filename;       /* < copy of the path, used to locate the line index sidecar file  */
+    long           startOffset;    /* < offset in the file where the reading started (streams can be already positioned) */
+    long           dataOffset;     /* < offset in the file of the first byte not loaded yet            */
+    long           lineNumber;     /* < number of lines read so far                                    */
+    long*          index;          /* < offset of the line (1+i*TEXTFILE_INDEX_STEP) or NULL if unused */
+    long           indexCount;
+    long           indexCapacity;
+    unsigned int   isIndexModified;
+    /* reverse reading (the raw data is read backward in blocks when the file isn't mapped) */
+    char*          tailBuffer;
+    long           tailBufferSize;
+    long           tailOffset;     /* < offset in the file of the first byte contained in 'tailBuffer' */
+    long           tailLength;     /* < number of bytes contained in 'tailBuffer'                       */
+    /* follow mode (the end of the data is not the end of the file, the file can grow while it's read) */
+    unsigned int   isFollowing;
+    unsigned int   isRotated;      /* < TRUE when 'filename' was replaced by a new file (opened after the rest of this one) */
+    int            pendingEol;     /* < end-of-line at the end of the data, it can be the first half of a pair (0 = none)  */
+    int            watchFd;        /* < inotify instance used to wait for changes in the file or -1                        */
+    /* options */
+    TEXTF_OPTIONS  options;        /* < options used to open the file (with the default values applied)           */
+    long           maxLineLength;  /* < longest line that fits in a buffer of 'options.maxBufferSize' (0 = no limit) */
+    unsigned int   isSkippingLine; /* < TRUE when the rest of a truncated line must be skipped                      */
+    TEXTF_ERROR    error;
+    char*          validEnd;       /* < end of the data of the buffer known to be valid UTF-8 (NULL = unknown)   */
+    long           errorOffset;    /* < offset in the file of the first invalid UTF-8 byte (-1 = none)           */
+    long           errorLine;      /* < number of the line containing the first invalid UTF-8 byte (0 = none)    */
+    TEXTF_STATS    stats;          /* < performance counters (all zero unless TEXTFILE_STATS is defined)         */
     char           initialBuffer[TEXTFILE_INI_BUFSIZE];
 } TEXTFILE;
 
 /**
  * Opens a file and returns a TEXTFILE object that controls it
  * @param filename  The path to the file to open
- * @param mode      A null-terminated string determining the file access mode (only the "r" is supported)
+ * @param mode      A null-terminated string determining the file access mode:
+ *                    "r"  = read the file through a buffer
+ *                    "rm" = map the whole file in memory (read-only), falls back to "r" for pipes and special files
+ *                    "rf" = follow the file while it grows (logs), the incomplete last line is returned when its
+ *                           end-of-line arrives and `textfwait(..)` waits for more data (POSIX systems only)
  * @returns         The pointer to the TEXTFILE object that controls the opened file or NULL if an error has ocurred
  */
 extern TEXTFILE* textfopen(const char* filename, const char* mode);
 
+/**
+ * Opens a file using the provided options and returns a TEXTFILE object that controls it
+ * @param filename  The path to the file to open
+ * @param mode      A null-terminated string determining the file access mode ("r", "rm" or "rf", see textfopen)
+ * @param options   The size of the buffers, the policy for long lines and the memory allocator (NULL = defaults)
+ * @returns         The pointer to the TEXTFILE object that controls the opened file or NULL if an error has ocurred
+ */
+extern TEXTFILE* textfopen_ex(const char* filename, const char* mode, const TEXTF_OPTIONS* options);
+
+/**
+ * Returns a TEXTFILE object that reads the lines contained in a block of memory (without copying it)
+ * @param data      Pointer to the text, it must remain valid and unmodified until the TEXTFILE object is closed
+ * @param size      The size of the text in bytes
+ * @returns         The pointer to the TEXTFILE object that controls the text or NULL if an error has ocurred
+ */
+extern TEXTFILE* textfopen_mem(const void* data, size_t size);
+
+/**
+ * Same as `textfopen_mem(..)` but using the provided options (see textfopen_ex)
+ */
+extern TEXTFILE* textfopen_mem_ex(const void* data, size_t size, const TEXTF_OPTIONS* options);
+
+/**
+ * Returns a TEXTFILE object that reads the file associated with a file descriptor (POSIX systems only)
+ * @param fd        The file descriptor, it's read from its current position and closed by textfclose()
+ * @param mode      "r", "rm" or "rf" (see textfopen), "rm" maps the file only if it's a regular file read from its beginning
+ * @returns         The pointer to the TEXTFILE object that controls the file or NULL if an error has ocurred
+ */
+extern TEXTFILE* textfdopen(int fd, const char* mode);
+
+/**
+ * Same as `textfdopen(..)` but using the provided options (see textfopen_ex)
+ */
+extern TEXTFILE* textfdopen_ex(int fd, const char* mode, const TEXTF_OPTIONS* options);
+
+/**
+ * Returns a TEXTFILE object that reads an already open stream (ex: stdin)
+ * @param stream    The stream, it's read from its current position and it's NOT closed by textfclose()
+ * @returns         The pointer to the TEXTFILE object that controls the stream or NULL if an error has ocurred
+ */
+extern TEXTFILE* textfopen_stream(FILE* stream);
+
+/**
+ * Same as `textfopen_stream(..)` but using the provided options (see textfopen_ex)
+ */
+extern TEXTFILE* textfopen_stream_ex(FILE* stream, const TEXTF_OPTIONS* options);
+
 /**
  * Read a line of text from the provided file
+ * (lines containing '\0' characters are only returned complete by `textfgetline_n(..)`)
  * @param textfile  The pointer to a TEXTFILE object that controls the file to read the data from
  * @returns         A pointer to the buffer containing the read line or NULL if there isn't more lines to read
  */
 extern char* textfgetline(TEXTFILE* textfile);
 
+/**
+ * Read a line of text from the provided file without copying or modifying it
+ * (the returned line is NOT null-terminated, it can contain '\0' characters and it's only valid until the next read operation)
+ * @param textfile        The pointer to a TEXTFILE object that controls the file to read the data from
+ * @param[out] out_length Pointer to the variable where the length of the line (in bytes) will be returned
+ * @returns               A pointer to the first character of the line or NULL if there isn't more lines to read
+ */
+extern const char* textfgetline_n(TEXTFILE* textfile, size_t* out_length);
+
+/**
+ * Read several lines of text from the provided file without copying or modifying them
+ * (all the complete lines available in the buffer are returned, the buffer is refilled only when they are drained)
+ * @param textfile  The pointer to a TEXTFILE object that controls the file to read the data from
+ * @param spans     Array where the position and length of each line will be returned (the lines are NOT null-terminated)
+ * @param max       The number of elements in the 'spans' array
+ * @returns         The number of lines returned (0 if there isn't more lines to read), they are valid until the next read operation
+ */
+extern int textfgetlines(TEXTFILE* textfile, TEXTF_SPAN* spans, int max);
+
+/**
+ * Counts the lines from the current position to the end of the file without returning them
+ * (the end-of-lines are counted directly over the data with SIMD instructions, the lines aren't located one by one)
+ * @param textfile        Pointer to a TEXTFILE object that identifies a file opened with the 'textfopen' function
+ * @param[out] out_counts Pointer to the structure where the number of end-of-lines of each style will be returned (can be NULL)
+ * @returns               The number of lines counted (0 if there isn't more lines to read), all of them are consumed
+ */
+extern long textfcountlines(TEXTFILE* textfile, TEXTF_EOLCOUNTS* out_counts);
+
+/**
+ * Moves the read position to the beginning of the provided line
+ *
+ * The position of every TEXTFILE_INDEX_STEP lines is recorded while reading, so that later calls can jump directly
+ * to any line. With the 'indexFile' option it's also kept in a sidecar file (filename + TEXTFILE_INDEX_EXT) for
+ * later runs.
+ *
+ * @param textfile   Pointer to a TEXTFILE object that identifies a file opened with the 'textfopen' function
+ * @param lineNumber The number of the line to be returned by the next read operation (starting at 1)
+ * @returns          Zero (0) on success or -1 if the file doesn't have that line (or it can't be reached)
+ */
+extern int textfseekline(TEXTFILE* textfile, long lineNumber);
+
+/**
+ * Moves the read position to the beginning of the last lines of the file
+ *
+ * The file is scanned backward from its end, so the cost depends on the number of lines and not on the size of the file.
+ * The number of lines of the file is unknown, so the lines are numbered from the end of the file (the last line is -1),
+ * except when the beginning of the file is reached (then they are numbered from 1 as usual).
+ *
+ * @param textfile   Pointer to a TEXTFILE object that identifies a file opened with the 'textfopen' function
+ * @param lineCount  The number of lines to be returned by the next read operations (0 = move to the end of the file)
+ * @returns          Zero (0) on success or -1 if the file can't be read backward (pipes, terminals, ...)
+ */
+extern int textfseektail(TEXTFILE* textfile, long lineCount);
+
+/**
+ * Read the line that precedes the read position and move the read position back to its beginning
+ * (the lines are returned newest-first, call `textfseektail(textfile,0)` to start from the end of the file)
+ * @param textfile         The pointer to a TEXTFILE object that controls the file to read the data from
+ * @param[out] out_length  Pointer to the variable where the length of the line (in bytes) will be returned
+ * @returns                A pointer to the first character of the line (NOT null-terminated) or NULL if the beginning of
+ *                         the file was reached (or it can't be read backward); the number of the line is `lineNumber+1`
+ */
+extern const char* textfgetprevline(TEXTFILE* textfile, size_t* out_length);
+
+/**
+ * Waits until more data is appended to a file opened in follow mode ("rf")
+ *
+ * In follow mode the read functions return NULL when no complete line is available yet (it isn't the end of the file),
+ * this function waits until the file grows, is truncated (it's read again from its beginning) or is replaced by a new
+ * file with the same name (log rotation, the new file is read from its beginning after the rest of the old one).
+ *
+ * @param textfile  Pointer to a TEXTFILE object opened with the "rf" mode
+ * @param timeout   The maximum time to wait in milliseconds (-1 = no limit, 0 = only check the file)
+ * @returns         1 if more lines can be read, 0 if the time expired or -1 if the file can't be followed
+ *                  (not opened with "rf", pipes and terminals, or the reading was stopped by an error)
+ */
+extern int textfwait(TEXTFILE* textfile, int timeout);
+
+/**
+ * Returns the read position of the file, so the reading can be resumed from there later (even by another process)
+ * @param textfile      Pointer to a TEXTFILE object that identifies a file opened with the 'textfopen' function
+ * @param[out] out_pos  Pointer to the TEXTF_POS structure where the position (offset, line number, encoding, ...) is returned
+ * @returns             Zero (0) on success or -1 if the encoding of the file isn't supported
+ */
+extern int textftell(TEXTFILE* textfile, TEXTF_POS* out_pos);
+
+/**
+ * Moves the read position to a position returned by `textftell(..)`
+ * (the encoding and the end-of-line stored in the position are restored, they aren't detected again)
+ * @param textfile   Pointer to a TEXTFILE object that identifies a file opened with the 'textfopen' function
+ * @param pos        Pointer to the position returned by `textftell(..)` for the same file
+ * @returns          Zero (0) on success or -1 if the file can't be repositioned (pipes, terminals, ...)
+ */
+extern int textfseek(TEXTFILE* textfile, const TEXTF_POS* pos);
+
+/**
+ * Returns the performance counters of the file: bytes read, refills, buffer growths, longest line, time spent, ...
+ * (the counters are collected only when TEXTFILE_STATS is defined before including 'textfile.h', otherwise they cost nothing)
+ * @param textfile        Pointer to a TEXTFILE object that identifies a file opened with the 'textfopen' function
+ * @param[out] out_stats  Pointer to the TEXTF_STATS structure where the counters are returned
+ * @returns               Zero (0) on success or -1 if the counters were compiled out (all of them are returned as zero)
+ */
+extern int textfstats(const TEXTFILE* textfile, TEXTF_STATS* out_stats);
+
 /**
  * This function is for compatibility with preexistent source code using standard file access
  *
@@ -109,16 +401,127 @@ extern char* textfgets(char* buffer, int bufsize, TEXTFILE* textfile);
  */
 extern int textfclose(TEXTFILE* textfile);
 
+/**
+ * Function called for each line by `textfparallel(..)`
+ * @param userData    The pointer provided to `textfparallel(..)`
+ * @param line        Pointer to the first character of the line (NOT null-terminated)
+ * @param length      The length of the line in bytes
+ * @param lineNumber  The number of the line, starting at 1
+ * @returns           filter: TRUE(1) to deliver the line / deliver: TRUE(1) to continue, FALSE(0) to stop reading
+ */
+typedef int (*TEXTF_LINEFUNC)(void* userData, const char* line, size_t length, long lineNumber);
+
+#define TEXTF_UNORDERED 0 /* < lines are delivered as soon as each chunk of the file is processed */
+#define TEXTF_ORDERED   1 /* < lines are delivered in the same order they appear in the file     */
+
+/**
+ * Reads all the remaining lines of a file using several threads
+ *
+ * The file is split into chunks that are processed in parallel by a pool of 'jobs' threads, each chunk begins
+ * in the next end-of-line found after its nominal offset. The 'filter' function is called concurrently from
+ * the threads, while the 'deliver' function is never called concurrently (the allocator of the options is also
+ * called from the threads). Only files opened in "rm" mode are processed in parallel, other files are read
+ * sequentially. The reading starts at the current position, the lines already read are not delivered again and
+ * the numbers continue from the last line read.
+ *
+ * @param textfile  Pointer to a TEXTFILE object that identifies a file opened with the 'textfopen' function
+ * @param jobs      The number of threads to use (including the calling thread)
+ * @param ordered   TEXTF_ORDERED to deliver the lines in file order, TEXTF_UNORDERED otherwise
+ * @param filter    Function called for every line, it returns TRUE to deliver the line (NULL = deliver all lines)
+ * @param deliver   Function called for every line accepted by 'filter' (can be NULL)
+ * @param userData  Pointer passed to the 'filter' and 'deliver' functions
+ * @returns         The number of lines read (all the remaining lines, even if 'deliver' stops the delivery)
+ *                  or -1 if an error has ocurred
+ */
+extern long textfparallel(TEXTFILE* textfile, int jobs, int ordered,
+                          TEXTF_LINEFUNC filter, TEXTF_LINEFUNC deliver, void* userData);
+
+/** Set of patterns searched at once (created with `textfsearch_new(..)`) */
+typedef struct TEXTF_SEARCH TEXTF_SEARCH;
+
+#define TEXTF_SEARCH_IGNORECASE 1 /* < the ASCII letters match regardless of their case */
+
+/**
+ * Prepares the search of several patterns at once (Aho-Corasick automaton)
+ * @param patterns  Array of null-terminated patterns (they can't contain end-of-line characters)
+ * @param count     The number of elements in the 'patterns' array
+ * @param flags     TEXTF_SEARCH_IGNORECASE or 0
+ * @returns         The pointer to the TEXTF_SEARCH object or NULL if a pattern contains end-of-line characters
+ *                  (or if there isn't enough memory)
+ */
+extern TEXTF_SEARCH* textfsearch_new(const char* const* patterns, int count, int flags);
+
+/**
+ * Same as `textfsearch_new(..)` but allocating the memory with the allocator of the provided options
+ * (only 'mallocFunc', 'freeFunc' and 'allocatorData' are used; NULL = malloc/free)
+ */
+extern TEXTF_SEARCH* textfsearch_new_ex(const char* const* patterns, int count, int flags, const TEXTF_OPTIONS* options);
+
+/**
+ * Finds the first occurrence of any of the patterns in the provided text (it can be called concurrently)
+ * @param search           Pointer to a TEXTF_SEARCH object created with `textfsearch_new(..)`
+ * @param text             The text where the patterns are searched (it doesn't need to be null-terminated)
+ * @param length           The length of the text in bytes
+ * @param[out] out_pattern Pointer to the variable where the index of the pattern found will be returned (can be NULL)
+ * @returns                A pointer to the beginning of the occurrence or NULL if none of the patterns was found
+ */
+extern const char* textfsearch_find(const TEXTF_SEARCH* search, const char* text, size_t length, int* out_pattern);
+
+/**
+ * Releases a TEXTF_SEARCH object
+ * @param search  Pointer to the TEXTF_SEARCH object to release (NULL is ignored)
+ */
+extern void textfsearch_free(TEXTF_SEARCH* search);
+
+/**
+ * Read the next line of text that contains any of the patterns, without copying or modifying it
+ * (the whole buffer is searched at once and the lines without occurrences are skipped without examining them)
+ * @param textfile         The pointer to a TEXTFILE object that controls the file to read the data from
+ * @param search           Pointer to a TEXTF_SEARCH object created with `textfsearch_new(..)`
+ * @param[out] out_length  Pointer to the variable where the length of the line (in bytes) will be returned
+ * @param[out] out_pattern Pointer to the variable where the index of the pattern found will be returned (can be NULL)
+ * @returns                A pointer to the first character of the line (NOT null-terminated) or NULL if there isn't more
+ *                         lines containing the patterns; the number of the line is available in `textfile->lineNumber`
+ */
+extern const char* textfgetmatch(TEXTFILE* textfile, const TEXTF_SEARCH* search, size_t* out_length, int* out_pattern);
+
 
 /**
  * Returns TRUE(1) if the encoding of the provided file is supported
  * @param textfile A pointer to the TEXTFILE object that identifies a file opened with the `textfopen( )` function
  */
 #define textfissupported(textfile) (                \
-  (textfile->encoding==TEXTF_ENCODING_UTF8    ) ||  \
-  (textfile->encoding==TEXTF_ENCODING_UTF8_BOM)     \
+  (textfile->encoding!=TEXTF_ENCODING_BINARY)       \
 )
 
+/**
+ * Returns the error that stopped the reading of the provided file (TEXTF_ERROR_NONE if no error has ocurred)
+ * @param textfile A pointer to the TEXTFILE object that identifies a file opened with the `textfopen( )` function
+ */
+#define textferror(textfile) (                      \
+  (textfile->error)                                 \
+)
+
+/**
+ * Returns the offset in the file of the first invalid UTF-8 byte found (-1 if none)
+ * @param textfile A pointer to a TEXTFILE object opened with the `TEXTF_VALIDATE_xxx` option
+ */
+#define textferroroffset(textfile) (                \
+  (textfile->errorOffset)                           \
+)
+
+/**
+ * Returns the number of the line that contains the first invalid UTF-8 byte found (0 if none)
+ * @param textfile A pointer to a TEXTFILE object opened with the `TEXTF_VALIDATE_xxx` option
+ */
+#define textferrorline(textfile) (                  \
+  (textfile->errorLine)                             \
+)
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
 
 /*=================================================================================================================*/
 #pragma mark - > INTERNAL PRIVATE FUNCTIONS
@@ -127,198 +530,3463 @@ extern int textfclose(TEXTFILE* textfile);
 #include <stdlib.h>
 #include <string.h>
 
-static char* textf__readmoredata(TEXTFILE* textfile) {
-    int bytesToKeep, bytesToLoad, bytesRead;
-    char* bufferToFree=NULL;
-    
-    bytesToKeep = (int)(textfile->bufferEnd - textfile->nextLine);
-    bytesToLoad = (textfile->bufferSize-2) - bytesToKeep;
-    /* if not enough space to load a line of text -> expand buffer!! */
-    if (bytesToLoad==0) {
-        bufferToFree = textfile->expandedBuffer;
-        textfile->bufferSize    *= 2;
-        textfile->expandedBuffer = malloc(textfile->bufferSize);
-        textfile->buffer         = textfile->expandedBuffer;
-        bytesToLoad = (textfile->bufferSize-2) - bytesToKeep;
-    }
-    if (bytesToKeep) { memmove(textfile->buffer, textfile->nextLine, bytesToKeep); }
-    bytesRead = (int)fread(&textfile->buffer[bytesToKeep], sizeof(char), bytesToLoad, textfile->file);
-    textfile->moreDataAvailable = (bytesRead==bytesToLoad);
-    textfile->nextLine          = textfile->buffer;
-    textfile->bufferEnd         = &textfile->buffer[bytesToKeep+bytesRead];
-    if (bufferToFree) { free(bufferToFree); }
-    return textfile->nextLine;
-}
+/* SIMD support: SSE2 is the x86-64 baseline, AVX2 is selected at runtime, NEON is the AArch64 baseline */
+/* (define TEXTFILE_NO_SIMD to force the portable ANSI-C scanner)                                       */
+#if !defined(TEXTFILE_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)))
+#   define TEXTF__SSE2 1
+#   include <emmintrin.h>
+#   if defined(__GNUC__) && ((__GNUC__>4) || (__GNUC__==4 && __GNUC_MINOR__>=9) || defined(__clang__))
+#       define TEXTF__AVX2 1
+#       include <immintrin.h>
+#   endif
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+#   endif
+#elif !defined(TEXTFILE_NO_SIMD) && (defined(__aarch64__) || defined(_M_ARM64))
+#   define TEXTF__NEON 1
+#   include <arm_neon.h>
+#endif
 
-static TEXTF_EOL textf__selecteol(int count_r, int count_rn, int count_n, int count_nr) {
-    int max=count_r; TEXTF_EOL eol=TEXTF_EOL_CLASSICMAC;
-    if (count_rn>max) { max=count_rn; eol=TEXTF_EOL_WINDOWS;  }
-    if (count_n >max) { max=count_n ; eol=TEXTF_EOL_UNIX;     }
-    if (count_nr>max) { max=count_nr; eol=TEXTF_EOL_ACORNBBC; }
-    if (max==0) { eol=TEXTF_EOL_UNKNOWN; }
-    return eol;
-}
+/* memory-mapped files ("rm" mode) are available on POSIX systems (define TEXTFILE_NO_MMAP to disable them) */
+#if !defined(TEXTFILE_NO_MMAP) && (defined(__unix__) || defined(__APPLE__))
+#   define TEXTF__MMAP 1
+#   include <sys/types.h>
+#   include <sys/stat.h>
+#   include <sys/mman.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
 
-static void textf__detectencoding(TEXTFILE* textfile) {
-    static const unsigned char UTF8_BOM[]     = { 239, 187, 191 };
-    static const unsigned char UTF16_BE_BOM[] = { 254, 255 };
-    static const unsigned char UTF16_LE_BOM[] = { 255, 254 };
-    int len, count, oddzeros, evenzeros, notext, isEncodingSupported;
-    int eol_rn=0, eol_r=0, eol_nr=0, eol_n=0;
-    unsigned char *ptr, *start;
-    TEXTF_ENCODING encoding = TEXTF_ENCODING_BINARY;
-    assert( textfile!=NULL );
-    
-    /* detect encoding using BOM (byte order mask) */
-    start = (unsigned char*)textfile->nextLine;
-    len   = (int)(textfile->bufferEnd - textfile->nextLine);
-    if      (len>=3 && memcmp(start,UTF8_BOM    ,3)==0) { encoding=TEXTF_ENCODING_UTF8_BOM    ; start+=3; }
-    else if (len>=2 && memcmp(start,UTF16_BE_BOM,2)==0) { encoding=TEXTF_ENCODING_UTF16_BE_BOM; start+=2; }
-    else if (len>=2 && memcmp(start,UTF16_LE_BOM,2)==0) { encoding=TEXTF_ENCODING_UTF16_LE_BOM; start+=2; }
-    
-    /* detect encoding using an heuristic algorithm */
-    else {
-        oddzeros = evenzeros = notext = 0;
-        ptr=start; count=len/2; while (count-->0) {
-            if (*ptr==0) { ++oddzeros;  } else if (*ptr<=8 || (14<=*ptr && *ptr<=31)) { ++notext; } ++ptr;
-            if (*ptr==0) { ++evenzeros; } else if (*ptr<=8 || (14<=*ptr && *ptr<=31)) { ++notext; } ++ptr;
-        }
-        if      (oddzeros<(evenzeros/8)) { encoding=TEXTF_ENCODING_UTF16_LE; }
-        else if (evenzeros<(oddzeros/8)) { encoding=TEXTF_ENCODING_UTF16_BE; }
-        else if (notext==0)              { encoding=TEXTF_ENCODING_UTF8;     }
-    }
+/* the line index can be kept in a sidecar file on POSIX systems (define TEXTFILE_NO_INDEXFILE to keep it only in memory) */
+/* (the nanoseconds of the modification time are read from the field available in each system, 0 if there isn't any)  */
+#if !defined(TEXTFILE_NO_INDEXFILE) && (defined(__unix__) || defined(__APPLE__))
+#   define TEXTF__INDEXFILE 1
+#   include <sys/types.h>
+#   include <sys/stat.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#   if defined(__APPLE__) && (!defined(_POSIX_C_SOURCE) || defined(_DARWIN_C_SOURCE))
+#       define textf__mtimensec(st) ((long)(st).st_mtimespec.tv_nsec)
+#   elif defined(__APPLE__) || (defined(__GLIBC__) && !defined(st_mtime))
+#       define textf__mtimensec(st) ((long)(st).st_mtimensec)
+#   elif defined(st_mtime)
+#       define textf__mtimensec(st) ((long)(st).st_mtim.tv_nsec)
+#   else
+#       define textf__mtimensec(st) 0L
+#   endif
+#   if defined(O_NOFOLLOW)
+#       define TEXTF__NOFOLLOW O_NOFOLLOW
+#   else
+#       define TEXTF__NOFOLLOW 0
+#   endif
+#endif
 
-    /* detect end-of-line for UTF-8 & UTF-8 with BOM */
-    if (encoding==TEXTF_ENCODING_UTF8 || encoding==TEXTF_ENCODING_UTF8_BOM) {
-        ptr=start; for (count=len-2; count>0; --count,++ptr) {
-            if      (ptr[0]=='\r') { if (ptr[1]=='\n') { ++eol_rn; } else { ++eol_r; } }
-            else if (ptr[0]=='\n') { if (ptr[1]=='\r') { ++eol_nr; } else { ++eol_n; } }
-        }
-    }
-    /* detect end-of-line for UTF-16BE & UTF-16BE with BOM */
-    else if (encoding==TEXTF_ENCODING_UTF16_BE || encoding==TEXTF_ENCODING_UTF16_BE_BOM) {
-        ptr=start; for (count=(len/2)-2; count>0; --count,ptr+=2) {
-            if (ptr[0]==0) {
-                if      (ptr[1]=='\r') { if (ptr[2]==0 && ptr[3]=='\n') { ++eol_rn; } else { ++eol_r; } }
-                else if (ptr[1]=='\n') { if (ptr[2]==0 && ptr[3]=='\r') { ++eol_nr; } else { ++eol_n; } }
-            }
-        }
-    }
-    /* detect end-of-line for UTF-16LE & UTF-16LE with BOM */
-    else if (encoding==TEXTF_ENCODING_UTF16_LE || encoding==TEXTF_ENCODING_UTF16_LE_BOM) {
-        ptr=start; for (count=(len/2)-2; count>0; --count,ptr+=2) {
-            if (ptr[1]==0) {
-                if      (ptr[0]=='\r') { if (ptr[3]==0 && ptr[2]=='\n') { ++eol_rn; } else { ++eol_r; } }
-                else if (ptr[0]=='\n') { if (ptr[3]==0 && ptr[2]=='\r') { ++eol_nr; } else { ++eol_n; } }
-            }
-        }
-    }
-    /* store results and return */
-    isEncodingSupported = (encoding==TEXTF_ENCODING_UTF8) || (encoding==TEXTF_ENCODING_UTF8_BOM);
-    textfile->encoding = encoding;
-    textfile->eol      = textf__selecteol(eol_r, eol_rn, eol_n, eol_nr);;
-    textfile->nextLine = textfissupported(textfile) ? (char*)start : NULL;
-}
+/* file descriptors can be read directly on POSIX systems (textfdopen) */
+#if defined(__unix__) || defined(__APPLE__)
+#   define TEXTF__FILEDESC 1
+#   include <sys/types.h>
+#   include <unistd.h>
+#   include <errno.h>
+#endif
+
+/* threads for `textfparallel(..)` are available on POSIX systems (define TEXTFILE_NO_THREADS to disable them) */
+#if !defined(TEXTFILE_NO_THREADS) && (defined(__unix__) || defined(__APPLE__))
+#   define TEXTF__THREADS 1
+#   include <pthread.h>
+#   define textf__lock(mutex)   pthread_mutex_lock(mutex)
+#   define textf__unlock(mutex) pthread_mutex_unlock(mutex)
+#else
+#   define textf__lock(mutex)
+#   define textf__unlock(mutex)
+#endif
+
+/* follow mode ("rf") is available on POSIX systems, the growth of the file is waited with inotify on Linux and polling on */
+/* the other systems (define TEXTFILE_NO_INOTIFY to use polling on Linux too)                                            */
+#if defined(__unix__) || defined(__APPLE__)
+#   define TEXTF__FOLLOW 1
+#   include <sys/types.h>
+#   include <sys/stat.h>
+#   include <fcntl.h>
+#   include <poll.h>
+#   if !defined(TEXTFILE_NO_INOTIFY) && defined(__linux__)
+#       define TEXTF__INOTIFY 1
+#       include <sys/inotify.h>
+#   endif
+#endif
+
+/* performance counters are collected only when TEXTFILE_STATS is defined (the time is measured with gettimeofday on */
+/* POSIX systems and with clock on the other systems, twice for each line read one by one, so it's a profiling aid)  */
+#if defined(TEXTFILE_STATS)
+#   define TEXTF__STATS 1
+#   if defined(__unix__) || defined(__APPLE__)
+#       define TEXTF__GETTIMEOFDAY 1
+#       include <sys/time.h>
+#   else
+#       include <time.h>
+#   endif
+#endif
 
 
 /*=================================================================================================================*/
-#pragma mark - > TEXTFILE IMPLEMENTATION
+#pragma mark - > MEMORY ALLOCATION
+
+#define TEXTF__MIN_BUFSIZE 16 /* < minimum size of the buffers (enough for a few characters and an end-of-line) */
+
+static void* textf__stdmalloc(void* allocatorData, size_t size) { (void)allocatorData; return malloc(size); }
+static void  textf__stdfree(void* allocatorData, void* ptr)     { (void)allocatorData; free(ptr);          }
 
 /**
- * Opens a file and returns a TEXTFILE object that controls it
- *
- * @param filename  The path to the file to open
- * @param mode      A null-terminated string determining the file access mode (only the "r" is supported)
- * @returns         The pointer to the TEXTFILE object that controls the opened file or NULL if an error has ocurred.
+ * Allocates memory using the allocator provided in the options of the TEXTFILE object
  */
-TEXTFILE* textfopen(const char* filename, const char* mode) {
-    TEXTFILE* textfile=NULL; FILE* file;
-    assert( filename!=NULL );
-    assert( mode[0]=='r' && mode[1]=='\0' );
-
-    file = fopen(filename,mode);
-    if (file) {
-        textfile = malloc(sizeof(TEXTFILE));
-        textfile->file              = file;
-        textfile->buffer            = textfile->initialBuffer;
-        textfile->bufferSize        = TEXTFILE_INI_BUFSIZE;
-        textfile->nextLine          = textfile->buffer;
-        textfile->bufferEnd         = textfile->nextLine;
-        textfile->expandedBuffer    = NULL;
-        textfile->moreDataAvailable = 0;
-        
-        /* read first chunk of data */
-        textf__readmoredata(textfile);
-        textf__detectencoding(textfile);
-    }
-    return textfile;
-}
+#define textf__malloc(textfile, size) \
+    ((textfile)->options.mallocFunc((textfile)->options.allocatorData, (size)))
 
 /**
- * Read a line of text from the provided file
- * @param textfile  The pointer to a TEXTFILE object that controls the file to read the data from
- * @returns         A pointer to the buffer containing the read line or NULL if there isn't more lines to read
+ * Releases memory allocated with `textf__malloc(..)` (NULL is ignored)
  */
-char* textfgetline(TEXTFILE* textfile) {
-    char *ptr, *line;
-    assert( textfile!=NULL && textfile->file!=NULL );
-    
-    if (textfile->nextLine==NULL) { return NULL; }
-    
-    ptr = line = textfile->nextLine;
-    while (ptr==line) {
-        /* find end-of-line */
-        while (*ptr!='\n' && *ptr!='\r' && ptr<(textfile->bufferEnd)) { ++ptr; }
-        /* if end-of-line is found -> mark it with a string terminator '\0' */
-        if      (*ptr=='\r') { *ptr++='\0'; if (*ptr=='\n') { ++ptr; } }
-        else if (*ptr=='\n') { *ptr++='\0'; if (*ptr=='\r') { ++ptr; } }
-        /* end-of-line NOT found in buffer */
-        /* if more data is available -> load more data into buffer and SEARCH AGAIN (ptr=line) */
-        /* otherwise the end of file was reached -> mark it with a string terminator '\0'      */
-        else if (textfile->moreDataAvailable) { ptr=line=textf__readmoredata(textfile); }
-        else                                  { *ptr='\0'; ptr=NULL; /* end-of-file */  }
-    }
-    textfile->nextLine = ptr;
-    return line;
+#define textf__free(textfile, ptr) \
+    { if (ptr) { (textfile)->options.freeFunc((textfile)->options.allocatorData, (ptr)); } }
+
+/**
+ * Resizes a block of memory allocated with `textf__malloc(..)` (the allocator hooks don't provide realloc)
+ * @returns the new block or NULL if there isn't enough memory (the old block is kept, like realloc does)
+ */
+static void* textf__realloc(TEXTFILE* textfile, void* ptr, size_t oldSize, size_t newSize) {
+    void* newPtr;
+    assert( textfile!=NULL );
+    newPtr = textf__malloc(textfile, newSize);
+    if (!newPtr) { return NULL; }
+    if (ptr) { memcpy(newPtr, ptr, oldSize<newSize ? oldSize : newSize); }
+    textf__free(textfile, ptr);
+    return newPtr;
 }
 
 /**
- * This function is for compatibility with preexistent source code using standard file access
- *
- * Reads characters from text file until (bufsize-1) characters have been read or either
- * a newline or end-of-file is reached, whichever happens first.
- *
- * @param buffer   Pointer to the buffer of chars where the string read will be stored
- * @param bufsize  Maximum number of bytes to be copied into 'buffer' (including '\0')
- * @param textfile Pointer to a TEXTFILE object that identifies a file opened with the 'textfopen' function
- * @returns
- *     pointer to 'buffer' when success or NULL when no more lines can be read
+ * Stops the reading because a buffer required to continue couldn't be allocated
+ * (the lines already in the buffer are lost and textferror() reports TEXTF_ERROR_OUT_OF_MEMORY)
  */
-char* textfgets(char* buffer, int bufsize, TEXTFILE* textfile) {
-    char* line; int length;
-    assert( buffer!=NULL && bufsize>2 );
+static void textf__outofmemory(TEXTFILE* textfile) {
     assert( textfile!=NULL );
- 
-    line = textfgetline(textfile); if (line==NULL) { return NULL; }
-    length=(int)strlen(line); if (length>(bufsize-2)) { length=(bufsize-2); }
-    memcpy(buffer, line, length);
-    buffer[length]='\n'; buffer[length+1]='\0';
-    return buffer;
+    textfile->error                = TEXTF_ERROR_OUT_OF_MEMORY;
+    textfile->moreDataAvailable    = 0;
+    textfile->moreRawDataAvailable = 0;
+}
+
+
+/*=================================================================================================================*/
+#pragma mark - > PERFORMANCE COUNTERS
+
+#if defined(TEXTF__STATS)
+
+/** Returns the current time in seconds */
+static double textf__now(void) {
+#   if defined(TEXTF__GETTIMEOFDAY)
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (double)now.tv_sec + (double)now.tv_usec/1000000.0;
+#   else
+    return (double)clock() / CLOCKS_PER_SEC;
+#   endif
 }
 
+/** Adds the counters of a TEXTFILE object used internally (the chunks of `textfparallel(..)`) to the counters of the file */
+static void textf__mergestats(TEXTFILE* textfile, const TEXTFILE* range) {
+    TEXTF_STATS* stats = &textfile->stats;
+    assert( textfile!=NULL && range!=NULL );
+    stats->bytesRead     += range->stats.bytesRead;
+    stats->refills       += range->stats.refills;
+    stats->bytesMoved    += range->stats.bytesMoved;
+    stats->bufferGrowths += range->stats.bufferGrowths;
+    stats->lineCount     += range->stats.lineCount;
+    stats->refillTime    += range->stats.refillTime;
+    stats->scanTime      += range->stats.scanTime;
+    if (range->stats.peakBufferSize>stats->peakBufferSize) { stats->peakBufferSize = range->stats.peakBufferSize; }
+    if (range->stats.longestLine   >stats->longestLine   ) { stats->longestLine    = range->stats.longestLine;    }
+}
+
+#   define textf__timer(start)                      double start
+#   define textf__starttimer(start)                 start = textf__now()
+#   define textf__stoptimer(textfile, field, start) (textfile)->stats.field += textf__now() - (start)
+#   define textf__count(textfile, field, value)     (textfile)->stats.field += (long)(value)
+#   define textf__peak(textfile, field, value)      if ((long)(value)>(textfile)->stats.field) { (textfile)->stats.field = (long)(value); }
+#else
+#   define textf__timer(start)
+#   define textf__starttimer(start)
+#   define textf__stoptimer(textfile, field, start)
+#   define textf__count(textfile, field, value)
+#   define textf__peak(textfile, field, value)
+#endif /* if defined(TEXTF__STATS) */
+
+
+/*=================================================================================================================*/
+#pragma mark - > END-OF-LINE SCANNER
+
+typedef const char* (*TEXTF__FINDEOL)(const char* ptr, const char* end);
+
 /**
- * Closes the file associated with the provided TEXTFILE object and releases all related resources
- * @param textfile Pointer to a TEXTFILE object that specifies the file to close
- * @returns        Zero (0) if the file is successfully closed
+ * Returns a pointer to the first '\r' or '\n' character in the range [ptr,end) or 'end' if there is none
+ * (portable version, one byte at a time)
  */
-int textfclose(TEXTFILE* textfile) {
-    if (textfile!=NULL) {
-        free(textfile->expandedBuffer);
-        free(textfile);
+static const char* textf__findeol_scalar(const char* ptr, const char* end) {
+    while (ptr<end && *ptr!='\n' && *ptr!='\r') { ++ptr; }
+    return ptr;
+}
+
+#if defined(TEXTF__SSE2)
+static int textf__ctz(unsigned int mask) {
+#   if defined(_MSC_VER)
+    unsigned long index; _BitScanForward(&index, mask); return (int)index;
+#   else
+    return __builtin_ctz(mask);
+#   endif
+}
+
+/** SSE2 version of `textf__findeol_scalar(..)`, it checks 16 bytes per iteration */
+static const char* textf__findeol_sse2(const char* ptr, const char* end) {
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+    __m128i block; int mask;
+    while ((end-ptr)>=16) {
+        block = _mm_loadu_si128((const __m128i*)ptr);
+        mask  = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block,cr), _mm_cmpeq_epi8(block,lf)));
+        if (mask) { return ptr + textf__ctz((unsigned int)mask); }
+        ptr += 16;
     }
-    return 0;
+    return textf__findeol_scalar(ptr, end);
+}
+#endif
+
+#if defined(TEXTF__AVX2)
+/** AVX2 version of `textf__findeol_scalar(..)`, it checks 32 bytes per iteration */
+__attribute__((target("avx2")))
+static const char* textf__findeol_avx2(const char* ptr, const char* end) {
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i lf = _mm256_set1_epi8('\n');
+    __m256i block; int mask;
+    while ((end-ptr)>=32) {
+        block = _mm256_loadu_si256((const __m256i*)ptr);
+        mask  = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(block,cr), _mm256_cmpeq_epi8(block,lf)));
+        if (mask) { return ptr + textf__ctz((unsigned int)mask); }
+        ptr += 32;
+    }
+    return textf__findeol_sse2(ptr, end);
 }
+#endif
 
+#if defined(TEXTF__NEON)
+/** NEON version of `textf__findeol_scalar(..)`, it checks 16 bytes per iteration */
+static const char* textf__findeol_neon(const char* ptr, const char* end) {
+    const uint8x16_t cr = vdupq_n_u8('\r');
+    const uint8x16_t lf = vdupq_n_u8('\n');
+    uint8x16_t block;
+    while ((end-ptr)>=16) {
+        block = vld1q_u8((const uint8_t*)ptr);
+        if (vmaxvq_u8(vorrq_u8(vceqq_u8(block,cr), vceqq_u8(block,lf)))) { return textf__findeol_scalar(ptr, ptr+16); }
+        ptr += 16;
+    }
+    return textf__findeol_scalar(ptr, end);
+}
+#endif
+
+/**
+ * Returns the best end-of-line scanner supported by the CPU running the code
+ */
+static TEXTF__FINDEOL textf__selectfindeol(void) {
+#if defined(TEXTF__AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) { return textf__findeol_avx2; }
+#endif
+#if defined(TEXTF__SSE2)
+    return textf__findeol_sse2;
+#elif defined(TEXTF__NEON)
+    return textf__findeol_neon;
+#else
+    return textf__findeol_scalar;
+#endif
+}
+
+/* the scanner is selected by `textf__selectkernels()` when the first file is opened (CPU dispatch) */
+static TEXTF__FINDEOL textf__findeol = textf__findeol_scalar;
+
+/** State of the end-of-line counter (the pairs can be split between two blocks of data) */
+typedef struct TEXTF__EOLCOUNT {
+    long         cr, lf;   /* < number of '\r' and '\n' characters                                          */
+    long         crlf;     /* < number of '\r\n' pairs                                                      */
+    long         lfcr;     /* < number of '\n\r' pairs                                                      */
+    unsigned int prevCR;   /* < 1 if the last character of the previous block was '\r'                       */
+    unsigned int prevLF;   /* < 1 if the last character of the previous block was '\n'                       */
+    unsigned int prevPair; /* < 1 if the last character of the previous block was the second half of a pair */
+} TEXTF__EOLCOUNT;
+
+/** Returns the number of bits set in a 32-bit mask */
+static int textf__popcount(unsigned int mask) {
+    mask = mask - ((mask>>1) & 0x55555555u);
+    mask = (mask & 0x33333333u) + ((mask>>2) & 0x33333333u);
+    mask = (mask + (mask>>4)) & 0x0F0F0F0Fu;
+    return (int)(((mask * 0x01010101u) >> 24) & 0xFF);
+}
+
+/**
+ * Counts the end-of-lines of a block of up to 32 characters from the masks of its '\r' and '\n' characters
+ * (the pairs are taken greedily from left to right, like `textf__skipeol(..)` does while reading)
+ * @param count  The state of the counter, updated with the end-of-lines of the block
+ * @param cr     Mask with the bit 'i' set when the character 'i' of the block is '\r'
+ * @param lf     Mask with the bit 'i' set when the character 'i' of the block is '\n'
+ * @param len    The number of characters in the block (1..32)
+ */
+static void textf__counteolmasks(TEXTF__EOLCOUNT* count, unsigned int cr, unsigned int lf, int len) {
+    unsigned int pairs, evenRuns, last = 1u<<(len-1);
+    if ((cr|lf)==0) { count->prevCR = count->prevLF = count->prevPair = 0; return; }
+    count->cr += textf__popcount(cr);
+    count->lf += textf__popcount(lf);
+    /* bit 'i' is set when the characters 'i-1' and 'i' can form a pair ('\r\n' or '\n\r') */
+    pairs = (((cr<<1)|count->prevCR) & lf) | (((lf<<1)|count->prevLF) & cr);
+    if (count->prevPair) { pairs &= ~1u; }
+    if (pairs) {
+        /* in each run of consecutive candidates only the 1st, 3rd, 5th, ... are pairs (the others overlap them) */
+        evenRuns = pairs & ~(pairs + (pairs & ~(pairs<<1) & 0x55555555u));
+        pairs    = (evenRuns & 0x55555555u) | (pairs & ~evenRuns & 0xAAAAAAAAu);
+        count->crlf += textf__popcount(pairs & lf);
+        count->lfcr += textf__popcount(pairs & cr);
+    }
+    count->prevCR   = (cr    & last)!=0;
+    count->prevLF   = (lf    & last)!=0;
+    count->prevPair = (pairs & last)!=0;
+}
+
+/**
+ * Counts the end-of-lines of a block of up to 32 characters (portable version, one byte at a time)
+ */
+static void textf__counteolblock(TEXTF__EOLCOUNT* count, const char* ptr, int len) {
+    unsigned int cr=0, lf=0; int i;
+    for (i=0; i<len; ++i) {
+        if      (ptr[i]=='\r') { cr |= 1u<<i; }
+        else if (ptr[i]=='\n') { lf |= 1u<<i; }
+    }
+    textf__counteolmasks(count, cr, lf, len);
+}
+
+/**
+ * Counts the end-of-lines contained in the range [ptr,end) (SIMD when available)
+ * @param count  The state of the counter, updated with the end-of-lines found (the range continues the previous one)
+ * @param ptr    Pointer to the first character of the range
+ * @param end    Pointer to the end of the range
+ */
+static void textf__counteols(TEXTF__EOLCOUNT* count, const char* ptr, const char* end) {
+#if defined(TEXTF__SSE2)
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+    __m128i lo, hi; unsigned int crMask, lfMask;
+    while ((end-ptr)>=32) {
+        lo = _mm_loadu_si128((const __m128i*)ptr);
+        hi = _mm_loadu_si128((const __m128i*)(ptr+16));
+        crMask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(lo,cr)) | ((unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(hi,cr))<<16);
+        lfMask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(lo,lf)) | ((unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(hi,lf))<<16);
+        /* (without any '\r' there are no pairs, the usual case of the Unix files is counted here) */
+        if ((crMask|count->prevCR)==0) {
+            count->lf += textf__popcount(lfMask);
+            count->prevLF = lfMask>>31; count->prevPair = 0;
+        }
+        else { textf__counteolmasks(count, crMask, lfMask, 32); }
+        ptr += 32;
+    }
+#elif defined(TEXTF__NEON)
+    const uint8x16_t cr = vdupq_n_u8('\r');
+    const uint8x16_t lf = vdupq_n_u8('\n');
+    uint8x16_t block;
+    while ((end-ptr)>=16) {
+        block = vld1q_u8((const uint8_t*)ptr);
+        if (vmaxvq_u8(vorrq_u8(vceqq_u8(block,cr), vceqq_u8(block,lf)))) { textf__counteolblock(count, ptr, 16); }
+        else { textf__counteolmasks(count, 0, 0, 16); }
+        ptr += 16;
+    }
+#endif
+    while ((end-ptr)>=32) { textf__counteolblock(count, ptr, 32); ptr += 32; }
+    if (ptr<end) { textf__counteolblock(count, ptr, (int)(end-ptr)); }
+}
+
+
+/*=================================================================================================================*/
+#pragma mark - > UTF-8 VALIDATOR
+
+/**
+ * Checks the UTF-8 sequence starting at 'ptr' (RFC 3629: no overlong forms, no surrogates, nothing above U+10FFFF)
+ * @returns The length of the sequence if it's valid, otherwise the negative length of its longest valid
+ *          prefix (at least 1), so that the whole prefix can be replaced by a single U+FFFD
+ */
+static int textf__utf8sequence(const unsigned char* ptr, const unsigned char* end) {
+    unsigned char lo=0x80, hi=0xBF; int length, i;
+    assert( ptr<end );
+    if      (ptr[0]< 0x80)                  { return 1; }
+    else if (ptr[0]>=0xC2 && ptr[0]<=0xDF)  { length = 2; }
+    else if (ptr[0]==0xE0)                  { length = 3; lo = 0xA0; }
+    else if (ptr[0]==0xED)                  { length = 3; hi = 0x9F; }
+    else if (ptr[0]>=0xE1 && ptr[0]<=0xEF)  { length = 3; }
+    else if (ptr[0]==0xF0)                  { length = 4; lo = 0x90; }
+    else if (ptr[0]>=0xF1 && ptr[0]<=0xF3)  { length = 4; }
+    else if (ptr[0]==0xF4)                  { length = 4; hi = 0x8F; }
+    else                                    { return -1; }
+    if ((end-ptr)<2 || ptr[1]<lo || ptr[1]>hi) { return -1; }
+    for (i=2; i<length; ++i) {
+        if ((end-ptr)<=i || (ptr[i]&0xC0)!=0x80) { return -i; }
+    }
+    return length;
+}
+
+typedef const char* (*TEXTF__FINDINVALID)(const char* ptr, const char* end);
+
+/**
+ * Returns a pointer to the first invalid UTF-8 sequence in the range [ptr,end) or 'end' if all the text is valid
+ * (portable version, one character at a time, blocks of ASCII characters are skipped 16 bytes at a time when SIMD is available)
+ */
+static const char* textf__findinvalid_scalar(const char* ptr, const char* end) {
+    const unsigned char *uptr=(const unsigned char*)ptr, *uend=(const unsigned char*)end; int length;
+    while (uptr<uend) {
+#if defined(TEXTF__SSE2)
+        while ((uend-uptr)>=16 && _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)uptr))==0) { uptr += 16; }
+#elif defined(TEXTF__NEON)
+        while ((uend-uptr)>=16 && vmaxvq_u8(vld1q_u8((const uint8_t*)uptr))<0x80) { uptr += 16; }
+#endif
+        while (uptr<uend && *uptr<0x80) { ++uptr; }
+        if (uptr<uend) {
+            length = textf__utf8sequence(uptr, uend);
+            if (length<0) { return (const char*)uptr; }
+            uptr += length;
+        }
+    }
+    return end;
+}
+
+#if defined(TEXTF__AVX2)
+/**
+ * AVX2 version of `textf__findinvalid_scalar(..)`, it validates 32 bytes per iteration with the lookup algorithm
+ * from "Validating UTF-8 In Less Than One Instruction Per Byte" (J. Keiser, D. Lemire, 2021).
+ * When a block fails, the scalar version finds the exact position of the error.
+ */
+__attribute__((target("avx2")))
+static const char* textf__findinvalid_avx2(const char* ptr, const char* end) {
+    /* error flags: 0x01 too short, 0x02 too long, 0x04 overlong 3, 0x08 too large, 0x10 surrogate,     */
+    /*              0x20 overlong 2, 0x40 overlong 4 / too large 1000, 0x80 two continuations            */
+    static const unsigned char tables[3][16] = {
+        /* high nibble of the 1st byte */
+        { 0x02,0x02,0x02,0x02,0x02,0x02,0x02,0x02, 0x80,0x80,0x80,0x80, 0x21,0x01,0x15,0x49 },
+        /* low nibble of the 1st byte  */
+        { 0xE7,0xA3,0x83,0x83,0x8B,0xCB,0xCB,0xCB, 0xCB,0xCB,0xCB,0xCB, 0xCB,0xDB,0xCB,0xCB },
+        /* high nibble of the 2nd byte */
+        { 0x01,0x01,0x01,0x01,0x01,0x01,0x01,0x01, 0xE6,0xAE,0xBA,0xBA, 0x01,0x01,0x01,0x01 }
+    };
+    /* largest byte value that doesn't start a sequence continuing in the next block (by position) */
+    static const unsigned char maxValues[32] = {
+        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF, 0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+        0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF, 0xFF,0xFF,0xFF,0xFF,0xFF,0xEF,0xDF,0xBF
+    };
+    const __m256i byte1High = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)tables[0]));
+    const __m256i byte1Low  = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)tables[1]));
+    const __m256i byte2High = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)tables[2]));
+    const __m256i maxValue  = _mm256_loadu_si256((const __m256i*)maxValues);
+    const __m256i nibble    = _mm256_set1_epi8(0x0F);
+    const __m256i bit7      = _mm256_set1_epi8((char)0x80);
+    const __m256i is3rdByte = _mm256_set1_epi8((char)(0xE0-0x80));
+    const __m256i is4thByte = _mm256_set1_epi8((char)(0xF0-0x80));
+    __m256i input, prevInput, prevIncomplete, prev1, prev2, prev3, special, required;
+    const char* start = ptr; int i;
+    
+    prevInput = prevIncomplete = _mm256_setzero_si256();
+    while ((end-ptr)>=32) {
+        input = _mm256_loadu_si256((const __m256i*)ptr);
+        if (_mm256_movemask_epi8(input)==0) {
+            /* ASCII block, it's only wrong if a sequence of the previous block was left incomplete */
+            if (!_mm256_testz_si256(prevIncomplete, prevIncomplete)) { break; }
+        }
+        else {
+            prev1 = _mm256_permute2x128_si256(prevInput, input, 0x21);
+            prev3 = _mm256_alignr_epi8(input, prev1, 13);
+            prev2 = _mm256_alignr_epi8(input, prev1, 14);
+            prev1 = _mm256_alignr_epi8(input, prev1, 15);
+            special = _mm256_and_si256(
+                _mm256_and_si256(_mm256_shuffle_epi8(byte1High, _mm256_and_si256(_mm256_srli_epi16(prev1,4), nibble)),
+                                 _mm256_shuffle_epi8(byte1Low,  _mm256_and_si256(prev1, nibble))),
+                _mm256_shuffle_epi8(byte2High, _mm256_and_si256(_mm256_srli_epi16(input,4), nibble)));
+            /* the 2nd continuation of 3/4 bytes sequences (and the 3rd of 4 bytes sequences) are required */
+            required = _mm256_and_si256(_mm256_or_si256(_mm256_subs_epu8(prev2, is3rdByte), _mm256_subs_epu8(prev3, is4thByte)), bit7);
+            special  = _mm256_xor_si256(special, required);
+            if (!_mm256_testz_si256(special, special)) { break; }
+        }
+        prevIncomplete = _mm256_subs_epu8(input, maxValue);
+        prevInput      = input;
+        ptr += 32;
+    }
+    /* go back to the beginning of the last character (the previous text is valid) and continue with the scalar version */
+    for (i=1; i<=3 && (ptr-i)>=start; ++i) {
+        if ((ptr[-i]&0xC0)!=0x80) { if ((ptr[-i]&0xC0)==0xC0) { ptr -= i; } break; }
+    }
+    return textf__findinvalid_scalar(ptr, end);
+}
+#endif
+
+/**
+ * Returns the best UTF-8 validator supported by the CPU running the code
+ */
+static TEXTF__FINDINVALID textf__selectfindinvalid(void) {
+#if defined(TEXTF__AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) { return textf__findinvalid_avx2; }
+#endif
+    return textf__findinvalid_scalar;
+}
+
+/* the validator is selected by `textf__selectkernels()` when the first file is opened (CPU dispatch) */
+static TEXTF__FINDINVALID textf__findinvalid = textf__findinvalid_scalar;
+
+/**
+ * Selects the best scanner and validator supported by the CPU running the code (CPU dispatch)
+ */
+static void textf__initkernels(void) {
+    textf__findeol     = textf__selectfindeol();
+    textf__findinvalid = textf__selectfindinvalid();
+}
+
+/* the kernels are selected only once, even when several threads open files at the same time */
+#if defined(TEXTF__THREADS)
+static pthread_once_t textf__kernelsOnce = PTHREAD_ONCE_INIT;
+#   define textf__selectkernels() pthread_once(&textf__kernelsOnce, textf__initkernels)
+#else
+static int textf__areKernelsSelected = 0;
+static void textf__selectkernels(void) {
+    if (!textf__areKernelsSelected) { textf__initkernels(); textf__areKernelsSelected = 1; }
+}
+#endif
+
+
+/*=================================================================================================================*/
+#pragma mark - > FILE READING
+
+#define TEXTF__READAHEAD_BLOCK (64*1024) /* < size of the blocks read in advance when no block size is provided */
+
+/**
+ * Reads data directly from the file (or from its file descriptor)
+ * @returns the number of bytes read, it's less than 'size' only when the end of the file was reached (or on error)
+ */
+static int textf__readsource(TEXTFILE* textfile, char* dest, int size) {
+#if defined(TEXTF__FILEDESC)
+    ssize_t count; int total=0;
+    if (textfile->fd>=0) {
+        /* pipes and terminals can return less data than requested before the end of the file */
+        while (total<size) {
+            count = read(textfile->fd, &dest[total], (size_t)(size-total));
+            if      (count>0)                  { total += (int)count; }
+            else if (count<0 && errno==EINTR)  { continue;            }
+            else                               { break;               }
+        }
+        return total;
+    }
+#endif
+    return (int)fread(dest, sizeof(char), size, textfile->file);
+}
+
+#if defined(TEXTF__THREADS)
+
+/** Queue of blocks that a background thread reads in advance (a ring of 'depth' blocks) */
+typedef struct TEXTF__READAHEAD {
+    TEXTFILE*       textfile;
+    pthread_t       thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t  filled;     /* < signaled when a block is filled (or the end of the file is reached) */
+    pthread_cond_t  emptied;    /* < signaled when a block is released by the reader (or on shutdown)    */
+    char*           blocks;     /* < memory of all the blocks ('depth' x 'blockSize' bytes)              */
+    int*            sizes;      /* < number of bytes contained in each block                             */
+    int             blockSize;
+    int             depth;
+    int             head;       /* < next block to consume                                               */
+    int             count;      /* < number of blocks filled and not consumed yet                        */
+    int             consumed;   /* < bytes already consumed from the 'head' block                        */
+    int             isEndOfFile;
+    int             isSeekable; /* < FALSE for pipes, terminals, ... (the blocks read can't be discarded)   */
+    int             stop;
+} TEXTF__READAHEAD;
+
+/**
+ * Fills the blocks of the queue until the end of the file is reached (executed by the background thread)
+ */
+static void* textf__readaheadworker(void* readAhead_) {
+    TEXTF__READAHEAD* ra = (TEXTF__READAHEAD*)readAhead_; int tail, bytesRead;
+    assert( ra!=NULL );
+    for (;;) {
+        pthread_mutex_lock(&ra->mutex);
+        while (ra->count==ra->depth && !ra->stop) { pthread_cond_wait(&ra->emptied, &ra->mutex); }
+        if (ra->stop) { pthread_mutex_unlock(&ra->mutex); return NULL; }
+        tail = (ra->head + ra->count) % ra->depth;
+        pthread_mutex_unlock(&ra->mutex);
+        
+        /* the block at 'tail' is not visible to the reader until 'count' is incremented */
+        bytesRead = textf__readsource(ra->textfile, &ra->blocks[tail*ra->blockSize], ra->blockSize);
+        
+        pthread_mutex_lock(&ra->mutex);
+        ra->sizes[tail] = bytesRead;
+        ++ra->count;
+        ra->isEndOfFile = (bytesRead<ra->blockSize);
+        pthread_cond_signal(&ra->filled);
+        pthread_mutex_unlock(&ra->mutex);
+        if (bytesRead<ra->blockSize) { return NULL; }
+    }
+}
+
+/**
+ * Starts the background thread that reads the next blocks of the file (if the read-ahead option is enabled)
+ */
+static void textf__startreadahead(TEXTFILE* textfile) {
+    TEXTF__READAHEAD* ra;
+    assert( textfile!=NULL && textfile->readAhead==NULL );
+    
+    if (textfile->options.readAhead<=0 || textfile->mapping) { return; }
+    ra = textf__malloc(textfile, sizeof(TEXTF__READAHEAD));
+    if (!ra) { return; }
+    ra->textfile    = textfile;
+    ra->depth       = textfile->options.readAhead;
+    ra->blockSize   = textfile->options.blockSize ? textfile->options.blockSize : TEXTF__READAHEAD_BLOCK;
+    ra->blocks      = textf__malloc(textfile, (size_t)ra->depth*ra->blockSize);
+    ra->sizes       = textf__malloc(textfile, ra->depth*sizeof(int));
+    if (!ra->blocks || !ra->sizes) {
+        /* not enough memory -> read the file synchronously */
+        if (ra->blocks) { textf__free(textfile, ra->blocks); }
+        if (ra->sizes)  { textf__free(textfile, ra->sizes);  }
+        textf__free(textfile, ra);
+        return;
+    }
+    ra->head        = ra->count = ra->consumed = 0;
+    ra->isEndOfFile = ra->stop = 0;
+#if defined(TEXTF__FILEDESC)
+    ra->isSeekable  = textfile->fd>=0 ? (lseek(textfile->fd, 0, SEEK_CUR)>=0) : (ftell(textfile->file)>=0);
+#else
+    ra->isSeekable  = (ftell(textfile->file)>=0);
+#endif
+    pthread_mutex_init(&ra->mutex, NULL);
+    pthread_cond_init(&ra->filled, NULL);
+    pthread_cond_init(&ra->emptied, NULL);
+    if (pthread_create(&ra->thread, NULL, textf__readaheadworker, ra)!=0) {
+        /* no thread -> read the file synchronously */
+        pthread_mutex_destroy(&ra->mutex);
+        pthread_cond_destroy(&ra->filled);
+        pthread_cond_destroy(&ra->emptied);
+        textf__free(textfile, ra->blocks);
+        textf__free(textfile, ra->sizes);
+        textf__free(textfile, ra);
+        return;
+    }
+    textfile->readAhead = ra;
+}
+
+/**
+ * Stops the background thread and discards the blocks read in advance
+ */
+static void textf__stopreadahead(TEXTFILE* textfile) {
+    TEXTF__READAHEAD* ra;
+    assert( textfile!=NULL );
+    
+    ra = textfile->readAhead; if (!ra) { return; }
+    pthread_mutex_lock(&ra->mutex);
+    ra->stop = 1;
+    pthread_cond_signal(&ra->emptied);
+    pthread_mutex_unlock(&ra->mutex);
+    pthread_join(ra->thread, NULL);
+    pthread_mutex_destroy(&ra->mutex);
+    pthread_cond_destroy(&ra->filled);
+    pthread_cond_destroy(&ra->emptied);
+    textf__free(textfile, ra->blocks);
+    textf__free(textfile, ra->sizes);
+    textf__free(textfile, ra);
+    textfile->readAhead = NULL;
+}
+
+/**
+ * Copies data from the blocks read in advance, waiting for the background thread when the queue is empty
+ * @returns the number of bytes copied, it's less than 'size' only when the end of the file was reached
+ */
+static int textf__readqueue(TEXTF__READAHEAD* ra, char* dest, int size) {
+    int total=0, count;
+    assert( ra!=NULL && dest!=NULL );
+    
+    pthread_mutex_lock(&ra->mutex);
+    while (total<size) {
+        while (ra->count==0 && !ra->isEndOfFile) { pthread_cond_wait(&ra->filled, &ra->mutex); }
+        if (ra->count==0) { break; }
+        pthread_mutex_unlock(&ra->mutex);
+        /* the 'head' block is not modified by the background thread while it's in the queue */
+        count = ra->sizes[ra->head] - ra->consumed;
+        if (count>(size-total)) { count = size-total; }
+        memcpy(&dest[total], &ra->blocks[ra->head*ra->blockSize + ra->consumed], count);
+        total += count; ra->consumed += count;
+        pthread_mutex_lock(&ra->mutex);
+        if (ra->consumed==ra->sizes[ra->head]) {
+            ra->head     = (ra->head+1) % ra->depth;
+            ra->consumed = 0;
+            --ra->count;
+            pthread_cond_signal(&ra->emptied);
+        }
+    }
+    pthread_mutex_unlock(&ra->mutex);
+    return total;
+}
+
+#else
+#   define textf__startreadahead(textfile)
+#   define textf__stopreadahead(textfile)
+#endif /* if defined(TEXTF__THREADS) */
+
+/**
+ * Reads data from the file (from the blocks read in advance when the read-ahead option is enabled)
+ * @returns the number of bytes read, it's less than 'size' only when the end of the file was reached (or on error)
+ */
+static int textf__readfile(TEXTFILE* textfile, char* dest, int size) {
+    int bytesRead;
+#if defined(TEXTF__THREADS)
+    if (textfile->readAhead) { bytesRead = textf__readqueue(textfile->readAhead, dest, size); }
+    else                     { bytesRead = textf__readsource(textfile, dest, size);           }
+#else
+    bytesRead = textf__readsource(textfile, dest, size);
+#endif
+    textf__count(textfile, bytesRead, bytesRead);
+    textf__count(textfile, refills, 1);
+    return bytesRead;
+}
+
+
+/*=================================================================================================================*/
+#pragma mark - > DECODERS (UTF-16, WINDOWS-1252, ISO-8859)
+
+#define TEXTF__MIN_DECODE 4 /* < minimum space required to decode one character (the longest UTF-8 sequence) */
+
+static char* textf__readmoredata(TEXTFILE* textfile);
+static void  textf__allocbuffer(TEXTFILE* textfile);
+
+/**
+ * Ensures that the raw buffer contains at least a few bytes (a surrogate pair) unless the end of file was reached
+ */
+static void textf__readmorerawdata(TEXTFILE* textfile) {
+    int bytesToKeep, bytesRead;
+    assert( textfile!=NULL && textfile->rawBuffer!=NULL );
+    
+    bytesToKeep = (int)(textfile->rawEnd - textfile->rawNext);
+    if (bytesToKeep) { memmove(textfile->rawBuffer, textfile->rawNext, bytesToKeep); }
+    textf__count(textfile, bytesMoved, bytesToKeep);
+    bytesRead = textf__readfile(textfile, &textfile->rawBuffer[bytesToKeep], textfile->rawBufferSize-bytesToKeep);
+    textfile->moreRawDataAvailable = (bytesRead==(textfile->rawBufferSize-bytesToKeep));
+    textfile->dataOffset += bytesRead;
+    textfile->rawNext = (const unsigned char*)textfile->rawBuffer;
+    textfile->rawEnd  = (const unsigned char*)&textfile->rawBuffer[bytesToKeep+bytesRead];
+}
+
+/**
+ * Converts a run of ASCII characters encoded in UTF-16 to UTF-8 (SIMD fast path)
+ * @param in          Pointer to the UTF-16 code units to convert
+ * @param units       Maximum number of code units to convert (the output must have space for this number of chars)
+ * @param out         Pointer to the buffer where the converted characters will be stored
+ * @param bigEndian   TRUE(1) if the code units are big-endian
+ * @returns           The number of code units converted (it stops before the first non-ASCII character)
+ */
+static int textf__utf16toascii(const unsigned char* in, int units, char* out, int bigEndian) {
+    int count=0;
+#if defined(TEXTF__SSE2)
+    const __m128i nonascii = _mm_set1_epi16((short)0xFF80);
+    const __m128i zero     = _mm_setzero_si128();
+    __m128i a, b;
+    while ((units-count)>=16) {
+        a = _mm_loadu_si128((const __m128i*)in);
+        b = _mm_loadu_si128((const __m128i*)(in+16));
+        if (bigEndian) {
+            a = _mm_or_si128(_mm_slli_epi16(a,8), _mm_srli_epi16(a,8));
+            b = _mm_or_si128(_mm_slli_epi16(b,8), _mm_srli_epi16(b,8));
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(a,b),nonascii),zero))!=0xFFFF) { break; }
+        _mm_storeu_si128((__m128i*)out, _mm_packus_epi16(a,b));
+        in+=32; out+=16; count+=16;
+    }
+#elif defined(TEXTF__NEON)
+    uint8x16_t a, b; uint16x8_t a16, b16;
+    while ((units-count)>=16) {
+        a = vld1q_u8(in);
+        b = vld1q_u8(in+16);
+        if (bigEndian) { a = vrev16q_u8(a); b = vrev16q_u8(b); }
+        a16 = vreinterpretq_u16_u8(a);
+        b16 = vreinterpretq_u16_u8(b);
+        if (vmaxvq_u16(vorrq_u16(a16,b16))>=0x80) { break; }
+        vst1q_u8((uint8_t*)out, vcombine_u8(vmovn_u16(a16), vmovn_u16(b16)));
+        in+=32; out+=16; count+=16;
+    }
+#else
+    (void)in; (void)units; (void)out; (void)bigEndian;
+#endif
+    return count;
+}
+
+/**
+ * Decodes UTF-16 (little or big endian) raw data to UTF-8
+ * (surrogate pairs are combined, invalid code units are replaced by U+FFFD)
+ * @param textfile  The pointer to the TEXTFILE object containing the raw data to decode
+ * @param dest      Pointer to the buffer where the UTF-8 text will be stored
+ * @param destSize  The size of 'dest' in bytes
+ * @returns         The number of bytes stored in 'dest'
+ */
+static int textf__decode_utf16(TEXTFILE* textfile, char* dest, int destSize) {
+    const unsigned char *in, *inEnd; unsigned char *out, *outEnd;
+    unsigned long code, low; int bigEndian, hi, lo, count;
+    assert( textfile!=NULL && dest!=NULL );
+    
+    bigEndian = (textfile->encoding==TEXTF_ENCODING_UTF16_BE || textfile->encoding==TEXTF_ENCODING_UTF16_BE_BOM);
+    hi = bigEndian ? 0 : 1;
+    lo = bigEndian ? 1 : 0;
+    out    = (unsigned char*)dest;
+    outEnd = (unsigned char*)dest + destSize;
+    while ((outEnd-out)>=TEXTF__MIN_DECODE) {
+        /* make sure a complete surrogate pair is available */
+        if ((textfile->rawEnd-textfile->rawNext)<4 && textfile->moreRawDataAvailable) { textf__readmorerawdata(textfile); }
+        in = textfile->rawNext; inEnd = textfile->rawEnd;
+        if (in>=inEnd) { break; }
+        
+        while ((inEnd-in)>=2 && (outEnd-out)>=TEXTF__MIN_DECODE) {
+            count = (int)((inEnd-in)/2 < (outEnd-out) ? (inEnd-in)/2 : (outEnd-out));
+            count = textf__utf16toascii(in, count, (char*)out, bigEndian);
+            in += 2*count; out += count;
+            if ((inEnd-in)<2 || (outEnd-out)<TEXTF__MIN_DECODE) { break; }
+            
+            code = ((unsigned long)in[hi]<<8) | in[lo];
+            if (code<0x80) { *out++ = (unsigned char)code; in+=2; continue; }
+            if (code>=0xD800 && code<=0xDBFF) {
+                /* high surrogate, the low surrogate can be in the next block of raw data */
+                if ((inEnd-in)<4 && (textfile->moreRawDataAvailable || textfile->isFollowing)) { break; }
+                low = (inEnd-in)>=4 ? (((unsigned long)in[2+hi]<<8) | in[2+lo]) : 0;
+                if (low>=0xDC00 && low<=0xDFFF) { code = 0x10000 + ((code-0xD800)<<10) + (low-0xDC00); in+=2; }
+                else                            { code = 0xFFFD; }
+            }
+            else if (code>=0xDC00 && code<=0xDFFF) { code = 0xFFFD; }
+            in+=2;
+            if (code<0x800) {
+                *out++ = (unsigned char)(0xC0 | (code>>6));
+                *out++ = (unsigned char)(0x80 | (code&0x3F));
+            }
+            else if (code<0x10000) {
+                *out++ = (unsigned char)(0xE0 | (code>>12));
+                *out++ = (unsigned char)(0x80 | ((code>>6)&0x3F));
+                *out++ = (unsigned char)(0x80 | (code&0x3F));
+            }
+            else {
+                *out++ = (unsigned char)(0xF0 | (code>>18));
+                *out++ = (unsigned char)(0x80 | ((code>>12)&0x3F));
+                *out++ = (unsigned char)(0x80 | ((code>>6)&0x3F));
+                *out++ = (unsigned char)(0x80 | (code&0x3F));
+            }
+        }
+        /* a lone byte at the end of the file -> U+FFFD */
+        if ((inEnd-in)==1 && !textfile->moreRawDataAvailable && !textfile->isFollowing && (outEnd-out)>=TEXTF__MIN_DECODE) {
+            *out++=0xEF; *out++=0xBF; *out++=0xBD; ++in;
+        }
+        textfile->rawNext = in;
+        /* following a file: the incomplete character at the end of the data waits for the rest of its bytes */
+        if (textfile->isFollowing && !textfile->moreRawDataAvailable && (inEnd-in)<4) { break; }
+    }
+    return (int)(out - (unsigned char*)dest);
+}
+
+/**
+ * Returns the unicode characters of the bytes 0x80..0xBF in the provided single-byte encoding
+ * (the bytes 0xC0..0xFF are the characters U+00C0..U+00FF in all of them)
+ */
+static const unsigned short* textf__codepage(TEXTF_ENCODING encoding) {
+    static const unsigned short WINDOWS1252[64] = {
+        0x20AC,0x0081,0x201A,0x0192,0x201E,0x2026,0x2020,0x2021, 0x02C6,0x2030,0x0160,0x2039,0x0152,0x008D,0x017D,0x008F,
+        0x0090,0x2018,0x2019,0x201C,0x201D,0x2022,0x2013,0x2014, 0x02DC,0x2122,0x0161,0x203A,0x0153,0x009D,0x017E,0x0178,
+        0x00A0,0x00A1,0x00A2,0x00A3,0x00A4,0x00A5,0x00A6,0x00A7, 0x00A8,0x00A9,0x00AA,0x00AB,0x00AC,0x00AD,0x00AE,0x00AF,
+        0x00B0,0x00B1,0x00B2,0x00B3,0x00B4,0x00B5,0x00B6,0x00B7, 0x00B8,0x00B9,0x00BA,0x00BB,0x00BC,0x00BD,0x00BE,0x00BF
+    };
+    static const unsigned short ISO8859_1[64] = {
+        0x0080,0x0081,0x0082,0x0083,0x0084,0x0085,0x0086,0x0087, 0x0088,0x0089,0x008A,0x008B,0x008C,0x008D,0x008E,0x008F,
+        0x0090,0x0091,0x0092,0x0093,0x0094,0x0095,0x0096,0x0097, 0x0098,0x0099,0x009A,0x009B,0x009C,0x009D,0x009E,0x009F,
+        0x00A0,0x00A1,0x00A2,0x00A3,0x00A4,0x00A5,0x00A6,0x00A7, 0x00A8,0x00A9,0x00AA,0x00AB,0x00AC,0x00AD,0x00AE,0x00AF,
+        0x00B0,0x00B1,0x00B2,0x00B3,0x00B4,0x00B5,0x00B6,0x00B7, 0x00B8,0x00B9,0x00BA,0x00BB,0x00BC,0x00BD,0x00BE,0x00BF
+    };
+    static const unsigned short ISO8859_15[64] = {
+        0x0080,0x0081,0x0082,0x0083,0x0084,0x0085,0x0086,0x0087, 0x0088,0x0089,0x008A,0x008B,0x008C,0x008D,0x008E,0x008F,
+        0x0090,0x0091,0x0092,0x0093,0x0094,0x0095,0x0096,0x0097, 0x0098,0x0099,0x009A,0x009B,0x009C,0x009D,0x009E,0x009F,
+        0x00A0,0x00A1,0x00A2,0x00A3,0x20AC,0x00A5,0x0160,0x00A7, 0x0161,0x00A9,0x00AA,0x00AB,0x00AC,0x00AD,0x00AE,0x00AF,
+        0x00B0,0x00B1,0x00B2,0x00B3,0x017D,0x00B5,0x00B6,0x00B7, 0x017E,0x00B9,0x00BA,0x00BB,0x0152,0x0153,0x0178,0x00BF
+    };
+    switch (encoding) {
+        case TEXTF_ENCODING_ISO8859_1:  return ISO8859_1;
+        case TEXTF_ENCODING_ISO8859_15: return ISO8859_15;
+        default:                        return WINDOWS1252;
+    }
+}
+
+/**
+ * Copies a run of ASCII characters (SIMD fast path of the single-byte decoder)
+ * @param in     Pointer to the bytes to copy
+ * @param count  Maximum number of bytes to copy
+ * @param out    Pointer to the buffer where the characters will be stored
+ * @returns      The number of bytes copied (it stops before the first non-ASCII character)
+ */
+static int textf__copyascii(const unsigned char* in, int count, char* out) {
+    int copied=0;
+#if defined(TEXTF__SSE2)
+    __m128i block; int mask;
+    while ((count-copied)>=16) {
+        /* the whole block is stored, the bytes after the first non-ASCII character are overwritten later */
+        block = _mm_loadu_si128((const __m128i*)(in+copied));
+        mask  = _mm_movemask_epi8(block);
+        _mm_storeu_si128((__m128i*)(out+copied), block);
+        if (mask) { return copied + textf__ctz((unsigned int)mask); }
+        copied += 16;
+    }
+#elif defined(TEXTF__NEON)
+    uint8x16_t block;
+    while ((count-copied)>=16) {
+        block = vld1q_u8(in+copied);
+        if (vmaxvq_u8(block)>=0x80) { break; }
+        vst1q_u8((uint8_t*)(out+copied), block);
+        copied += 16;
+    }
+#endif
+    while (copied<count && in[copied]<0x80) { out[copied]=(char)in[copied]; ++copied; }
+    return copied;
+}
+
+/**
+ * Decodes single-byte raw data (Windows-1252, ISO-8859-1 or ISO-8859-15) to UTF-8
+ * @param textfile  The pointer to the TEXTFILE object containing the raw data to decode
+ * @param dest      Pointer to the buffer where the UTF-8 text will be stored
+ * @param destSize  The size of 'dest' in bytes
+ * @returns         The number of bytes stored in 'dest'
+ */
+static int textf__decode_8bit(TEXTFILE* textfile, char* dest, int destSize) {
+    const unsigned char *in, *inEnd; unsigned char *out, *outEnd;
+    const unsigned short* codepage; unsigned int code; int count;
+    assert( textfile!=NULL && dest!=NULL );
+    
+    codepage = textf__codepage(textfile->encoding);
+    out      = (unsigned char*)dest;
+    outEnd   = (unsigned char*)dest + destSize;
+    while ((outEnd-out)>=TEXTF__MIN_DECODE) {
+        if (textfile->rawNext>=textfile->rawEnd && textfile->moreRawDataAvailable) { textf__readmorerawdata(textfile); }
+        in = textfile->rawNext; inEnd = textfile->rawEnd;
+        if (in>=inEnd) { break; }
+        
+        while (in<inEnd && (outEnd-out)>=TEXTF__MIN_DECODE) {
+            /* ASCII is copied as it is */
+            count = (int)((inEnd-in) < (outEnd-out) ? (inEnd-in) : (outEnd-out));
+            count = textf__copyascii(in, count, (char*)out);
+            in += count; out += count;
+            if (in>=inEnd || (outEnd-out)<TEXTF__MIN_DECODE) { break; }
+            
+            code = *in++;
+            if (code<0xC0) { code = codepage[code-0x80]; }
+            if (code<0x800) {
+                *out++ = (unsigned char)(0xC0 | (code>>6));
+                *out++ = (unsigned char)(0x80 | (code&0x3F));
+            }
+            else {
+                *out++ = (unsigned char)(0xE0 | (code>>12));
+                *out++ = (unsigned char)(0x80 | ((code>>6)&0x3F));
+                *out++ = (unsigned char)(0x80 | (code&0x3F));
+            }
+        }
+        textfile->rawNext = in;
+    }
+    return (int)(out - (unsigned char*)dest);
+}
+
+/**
+ * Starts decoding the file with the decoder corresponding to its encoding
+ * @param textfile  The pointer to the TEXTFILE object (its buffer contains the first chunk of raw data)
+ * @param start     Pointer to the first byte of raw data to decode (after the BOM)
+ */
+static void textf__startdecoding(TEXTFILE* textfile, char* start) {
+    int length;
+    assert( textfile!=NULL && start!=NULL );
+    
+    switch (textfile->encoding) {
+        case TEXTF_ENCODING_WINDOWS1252:
+        case TEXTF_ENCODING_ISO8859_1:
+        case TEXTF_ENCODING_ISO8859_15: textfile->decoder = textf__decode_8bit;  break;
+        default:                        textfile->decoder = textf__decode_utf16; break;
+    }
+    /* the whole file is mapped in memory -> decode directly from the mapping */
+    if (textfile->mapping) {
+        textfile->rawNext = (const unsigned char*)start;
+        textfile->rawEnd  = (const unsigned char*)textfile->bufferEnd;
+        textfile->moreRawDataAvailable = 0;
+        textfile->isBufferReadOnly     = 0;
+        textf__allocbuffer(textfile);
+    }
+    /* otherwise move the data already read to the raw buffer */
+    else {
+        length = (int)(textfile->bufferEnd - start);
+        textfile->rawBufferSize = textfile->options.blockSize ? textfile->options.blockSize : 2*TEXTFILE_INI_BUFSIZE;
+        if (textfile->rawBufferSize<length) { textfile->rawBufferSize = length; }
+        textfile->rawBuffer     = textf__malloc(textfile, textfile->rawBufferSize);
+        if (!textfile->rawBuffer) { textfile->rawBufferSize = 0; textf__outofmemory(textfile); return; }
+        memcpy(textfile->rawBuffer, start, length);
+        textfile->rawNext = (const unsigned char*)textfile->rawBuffer;
+        textfile->rawEnd  = (const unsigned char*)&textfile->rawBuffer[length];
+        textfile->moreRawDataAvailable = textfile->moreDataAvailable;
+    }
+    textfile->nextLine          = textfile->buffer;
+    textfile->bufferEnd         = textfile->buffer;
+    textfile->moreDataAvailable = 1;
+    textf__readmoredata(textfile);
+}
+
+
+/*=================================================================================================================*/
+#pragma mark - > BUFFER MANAGEMENT
+
+static char* textf__readmoredata(TEXTFILE* textfile) {
+    int bytesToKeep, bytesToLoad, bytesRead, maxBufferSize, newBufferSize;
+    char *bufferToFree=NULL, *newBuffer;
+    textf__timer(refillStart);
+    
+    textf__starttimer(refillStart);
+    bytesToKeep = (int)(textfile->bufferEnd - textfile->nextLine);
+    bytesToLoad = (textfile->bufferSize-2) - bytesToKeep;
+    /* if not enough space to load a line of text -> expand buffer!! (up to its maximum size) */
+    if (bytesToLoad<TEXTF__MIN_DECODE) {
+        maxBufferSize = textfile->options.maxBufferSize;
+        assert( maxBufferSize==0 || textfile->bufferSize<maxBufferSize );
+        newBufferSize = 2*textfile->bufferSize;
+        if (maxBufferSize && newBufferSize>maxBufferSize) { newBufferSize = maxBufferSize; }
+        newBuffer = textf__malloc(textfile, newBufferSize);
+        if (!newBuffer) { textf__outofmemory(textfile); return textfile->nextLine; }
+        bufferToFree = textfile->expandedBuffer;
+        textfile->expandedBuffer = textfile->buffer = newBuffer;
+        textfile->bufferSize     = newBufferSize;
+        bytesToLoad = (textfile->bufferSize-2) - bytesToKeep;
+        textf__count(textfile, bufferGrowths, 1);
+        textf__peak(textfile, peakBufferSize, textfile->bufferSize);
+    }
+    if (textfile->options.blockSize && bytesToLoad>textfile->options.blockSize) { bytesToLoad = textfile->options.blockSize; }
+    if (bytesToKeep) { memmove(textfile->buffer, textfile->nextLine, bytesToKeep); }
+    textf__count(textfile, bytesMoved, bytesToKeep);
+    if (textfile->decoder) {
+        bytesRead = textfile->decoder(textfile, &textfile->buffer[bytesToKeep], bytesToLoad);
+        textfile->moreDataAvailable = (textfile->rawNext<textfile->rawEnd) || textfile->moreRawDataAvailable;
+        /* (following a file, the raw data that can't be decoded is an incomplete character waiting for more data) */
+        if (textfile->isFollowing && bytesRead==0 && !textfile->moreRawDataAvailable) { textfile->moreDataAvailable = 0; }
+    }
+    else {
+        bytesRead = textf__readfile(textfile, &textfile->buffer[bytesToKeep], bytesToLoad);
+        textfile->moreDataAvailable = (bytesRead==bytesToLoad);
+        textfile->dataOffset += bytesRead;
+    }
+    textfile->nextLine          = textfile->buffer;
+    textfile->bufferEnd         = &textfile->buffer[bytesToKeep+bytesRead];
+    textfile->validEnd          = NULL;
+    textf__free(textfile, bufferToFree);
+    textf__stoptimer(textfile, refillTime, refillStart);
+    return textfile->nextLine;
+}
+
+/**
+ * Initializes all the fields of a TEXTFILE object (the buffer is empty and no file is attached to it)
+ * @param textfile  The TEXTFILE object to initialize
+ * @param options   The options provided by the user or NULL to use the default values
+ */
+static void textf__init(TEXTFILE* textfile, const TEXTF_OPTIONS* options) {
+    TEXTF_OPTIONS* opt;
+    assert( textfile!=NULL );
+    
+    /* select the SIMD kernels supported by the CPU (only the first time) */
+    textf__selectkernels();
+    
+    /* apply the default values to the options not provided */
+    opt = &textfile->options;
+    if (options) { *opt = *options; } else { memset(opt, 0, sizeof(TEXTF_OPTIONS)); }
+    if (opt->bufferSize<=0)    { opt->bufferSize    = TEXTFILE_INI_BUFSIZE; }
+    if (opt->maxBufferSize<=0) { opt->maxBufferSize = TEXTFILE_MAX_BUFSIZE; }
+    if (opt->blockSize<0)      { opt->blockSize     = 0;                    }
+    if (opt->readAhead<0)      { opt->readAhead     = 0;                    }
+    if (opt->validate<TEXTF_VALIDATE_NONE || opt->validate>TEXTF_VALIDATE_STOP) { opt->validate = TEXTF_VALIDATE_NONE; }
+    if (opt->legacyEncoding<TEXTF_ENCODING_WINDOWS1252 || opt->legacyEncoding>TEXTF_ENCODING_ISO8859_15) {
+        opt->legacyEncoding = TEXTF_ENCODING_UTF8;
+    }
+    if (opt->blockSize>0     && opt->blockSize    <TEXTF__MIN_BUFSIZE) { opt->blockSize     = TEXTF__MIN_BUFSIZE; }
+    if (opt->maxBufferSize>0 && opt->maxBufferSize<TEXTF__MIN_BUFSIZE) { opt->maxBufferSize = TEXTF__MIN_BUFSIZE; }
+    if (opt->bufferSize<TEXTF__MIN_BUFSIZE)                            { opt->bufferSize    = TEXTF__MIN_BUFSIZE; }
+    if (opt->maxBufferSize>0 && opt->bufferSize>opt->maxBufferSize)    { opt->bufferSize    = opt->maxBufferSize; }
+    if (!opt->mallocFunc || !opt->freeFunc) { opt->mallocFunc = textf__stdmalloc; opt->freeFunc = textf__stdfree; }
+    /* the buffer keeps 2 bytes in reserve and it must have space to load one more character after the line */
+    textfile->maxLineLength  = opt->maxBufferSize>0 ? (long)(opt->maxBufferSize - 3 - TEXTF__MIN_DECODE) : 0;
+    textfile->isSkippingLine = 0;
+    textfile->error          = TEXTF_ERROR_NONE;
+    textfile->validEnd       = NULL;
+    textfile->errorOffset    = -1;
+    textfile->errorLine      = 0;
+    
+    textfile->file              = NULL;
+    textfile->fd                = -1;
+    textfile->isFileOwned       = 1;
+    textfile->readAhead         = NULL;
+    textfile->buffer            = textfile->initialBuffer;
+    textfile->bufferSize        = opt->bufferSize<TEXTFILE_INI_BUFSIZE ? opt->bufferSize : TEXTFILE_INI_BUFSIZE;
+    textfile->nextLine          = textfile->buffer;
+    textfile->bufferEnd         = textfile->nextLine;
+    textfile->encoding          = TEXTF_ENCODING_UTF8;
+    textfile->eol               = TEXTF_EOL_UNKNOWN;
+    textfile->expandedBuffer    = NULL;
+    textfile->moreDataAvailable = 0;
+    textfile->mapping           = NULL;
+    textfile->mappingSize       = 0;
+    textfile->isMappingOwned    = 1;
+    textfile->lineBuffer        = NULL;
+    textfile->lineBufferSize    = 0;
+    textfile->isBufferReadOnly  = 0;
+    textfile->decoder           = NULL;
+    textfile->rawBuffer         = NULL;
+    textfile->rawBufferSize     = 0;
+    textfile->rawNext           = NULL;
+    textfile->rawEnd            = NULL;
+    textfile->moreRawDataAvailable = 0;
+    textfile->filename          = NULL;
+    textfile->startOffset       = 0;
+    textfile->dataOffset        = 0;
+    textfile->lineNumber        = 0;
+    textfile->index             = NULL;
+    textfile->indexCount        = 0;
+    textfile->indexCapacity     = 0;
+    textfile->isIndexModified   = 0;
+    textfile->tailBuffer        = NULL;
+    textfile->tailBufferSize    = 0;
+    textfile->tailOffset        = 0;
+    textfile->tailLength        = 0;
+    textfile->isFollowing       = 0;
+    textfile->isRotated         = 0;
+    textfile->pendingEol        = 0;
+    textfile->watchFd           = -1;
+    memset(&textfile->stats, 0, sizeof(TEXTF_STATS));
+#if defined(TEXTF__STATS)
+    textfile->stats.peakBufferSize = textfile->bufferSize;
+#endif
+}
+
+/**
+ * Allocates a TEXTFILE object with the allocator of the provided options and initializes it
+ * @param options   The options provided by the user or NULL to use the default values
+ * @returns         The new TEXTFILE object or NULL if there isn't enough memory
+ */
+static TEXTFILE* textf__new(const TEXTF_OPTIONS* options) {
+    TEXTFILE* textfile;
+    textfile = (options && options->mallocFunc && options->freeFunc) ?
+               options->mallocFunc(options->allocatorData, sizeof(TEXTFILE)) : malloc(sizeof(TEXTFILE));
+    if (textfile) { textf__init(textfile, options); }
+    return textfile;
+}
+
+/**
+ * Sets up the buffer with the initial size requested in the options (empty)
+ * (buffers up to TEXTFILE_INI_BUFSIZE use the memory reserved inside the TEXTFILE object)
+ */
+static void textf__allocbuffer(TEXTFILE* textfile) {
+    assert( textfile!=NULL && textfile->expandedBuffer==NULL );
+    textfile->bufferSize = textfile->options.bufferSize;
+    if (textfile->bufferSize>TEXTFILE_INI_BUFSIZE) {
+        textfile->expandedBuffer = textf__malloc(textfile, textfile->bufferSize);
+        textfile->buffer         = textfile->expandedBuffer;
+    }
+    /* not enough memory for the requested size -> use the memory reserved inside the TEXTFILE object */
+    if (textfile->bufferSize<=TEXTFILE_INI_BUFSIZE || !textfile->expandedBuffer) {
+        textfile->buffer     = textfile->initialBuffer;
+        textfile->bufferSize = textfile->bufferSize<TEXTFILE_INI_BUFSIZE ? textfile->bufferSize : TEXTFILE_INI_BUFSIZE;
+    }
+    textf__peak(textfile, peakBufferSize, textfile->bufferSize);
+    textfile->nextLine  = textfile->buffer;
+    textfile->bufferEnd = textfile->buffer;
+}
+
+/**
+ * Maps the whole file associated with a file descriptor in memory (read-only)
+ * @returns TRUE(1) if the file was mapped, or FALSE(0) if it can't be mapped (pipes, special files, empty files, ...)
+ */
+static int textf__mapfd(TEXTFILE* textfile, int fd) {
+#if defined(TEXTF__MMAP)
+    struct stat st; void* mapping=MAP_FAILED;
+    assert( textfile!=NULL && fd>=0 );
+    
+    if (fstat(fd,&st)==0 && S_ISREG(st.st_mode) && st.st_size>0 && (off_t)(size_t)st.st_size==st.st_size) {
+        mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    if (mapping==MAP_FAILED) { return 0; }
+    textfile->mapping     = (char*)mapping;
+    textfile->mappingSize = (size_t)st.st_size;
+    textfile->dataOffset  = (long)st.st_size;
+    textfile->buffer      = textfile->mapping;
+    textfile->nextLine    = textfile->mapping;
+    textfile->bufferEnd   = textfile->mapping + textfile->mappingSize;
+    textfile->moreDataAvailable = 0;
+    textfile->isBufferReadOnly  = 1;
+    return 1;
+#else
+    (void)textfile; (void)fd;
+    return 0;
+#endif
+}
+
+/**
+ * Maps the whole file in memory (read-only)
+ * @returns TRUE(1) if the file was mapped, or FALSE(0) if it can't be mapped (pipes, special files, empty files, ...)
+ */
+static int textf__mapfile(TEXTFILE* textfile, const char* filename) {
+#if defined(TEXTF__MMAP)
+    int fd, mapped;
+    assert( textfile!=NULL && filename!=NULL );
+    
+    fd = open(filename, O_RDONLY);
+    if (fd<0) { return 0; }
+    mapped = textf__mapfd(textfile, fd);
+    close(fd);
+    return mapped;
+#else
+    (void)textfile; (void)filename;
+    return 0;
+#endif
+}
+
+/**
+ * Returns the number of bytes that the provided decoded text occupied in the file
+ */
+static long textf__rawsize(const TEXTFILE* textfile, const char* begin, const char* end) {
+    const unsigned char* ptr; long size=0;
+    assert( textfile!=NULL && begin<=end );
+    
+    /* UTF-16: each character of 1, 2 or 3 bytes comes from 1 code unit, each character of 4 bytes from 2 units */
+    if (textfile->decoder==textf__decode_utf16) {
+        for (ptr=(const unsigned char*)begin; ptr<(const unsigned char*)end; ++ptr) {
+            if      ((*ptr&0xC0)==0x80) { continue;  }
+            else if (*ptr>=0xF0)        { size += 4; }
+            else                        { size += 2; }
+        }
+        /* the U+FFFD that replaces a lone byte at the end of the file comes from 1 byte */
+        if (size>0 && (textfile->dataOffset&1) && textfile->rawNext==textfile->rawEnd && !textfile->moreRawDataAvailable
+            && end==textfile->bufferEnd) { --size; }
+        return size;
+    }
+    /* single-byte encodings: each character comes from 1 byte */
+    if (textfile->decoder==textf__decode_8bit) {
+        for (ptr=(const unsigned char*)begin; ptr<(const unsigned char*)end; ++ptr) {
+            if ((*ptr&0xC0)!=0x80) { ++size; }
+        }
+        return size;
+    }
+    return (long)(end - begin);
+}
+
+/**
+ * Returns the offset in the file of a line contained in the buffer
+ */
+static long textf__lineoffset(const TEXTFILE* textfile, const char* line) {
+    long offset;
+    assert( textfile!=NULL && line!=NULL );
+    offset = textfile->dataOffset - textf__rawsize(textfile, line, textfile->bufferEnd);
+    if (textfile->decoder) { offset -= (long)(textfile->rawEnd - textfile->rawNext); }
+    return offset;
+}
+
+/**
+ * Records the offset of a line in the line index if it's the next checkpoint
+ */
+static void textf__addcheckpoint(TEXTFILE* textfile, const char* line) {
+    long* index;
+    assert( textfile!=NULL && textfile->index!=NULL );
+    if ( (textfile->lineNumber-1) != (textfile->indexCount*TEXTFILE_INDEX_STEP) ) { return; }
+    if (textfile->indexCount==textfile->indexCapacity) {
+        /* (without memory the index stops growing, the lines after it are found reading the file) */
+        index = textf__realloc(textfile, textfile->index, textfile->indexCapacity*sizeof(long),
+                               2*textfile->indexCapacity*sizeof(long));
+        if (!index) { return; }
+        textfile->index          = index;
+        textfile->indexCapacity *= 2;
+    }
+    textfile->index[textfile->indexCount++] = textf__lineoffset(textfile, line);
+    textfile->isIndexModified = 1;
+}
+
+/**
+ * Returns a pointer to the character that follows the provided end-of-line ('\r', '\n', '\r\n' or '\n\r')
+ * or NULL if it's the end of the file (following a file, an end-of-line at the end of the data is recorded in
+ * 'pendingEol' because the second half of its pair can arrive later)
+ */
+static char* textf__skipeol(TEXTFILE* textfile, char* ptr) {
+    assert( textfile!=NULL && ptr!=NULL );
+    if (ptr>=textfile->bufferEnd) { return NULL; /* end-of-file */ }
+    if (*ptr++=='\r') { if (ptr<textfile->bufferEnd && *ptr=='\n') { return ++ptr; } }
+    else              { if (ptr<textfile->bufferEnd && *ptr=='\r') { return ++ptr; } }
+    if (ptr==textfile->bufferEnd && textfile->isFollowing) { textfile->pendingEol = ptr[-1]; }
+    return ptr;
+}
+
+/**
+ * Skips the rest of a truncated line, including its end-of-line
+ */
+static void textf__skipline(TEXTFILE* textfile) {
+    char* ptr;
+    assert( textfile!=NULL );
+    
+    textfile->isSkippingLine = 0;
+    if (textfile->nextLine==NULL) { return; }
+    ptr = (char*)textf__findeol(textfile->nextLine, textfile->bufferEnd);
+    /* discard the data while the end-of-line is not found (keeping an end-of-line that can be half of a pair) */
+    while ((ptr+1)>=textfile->bufferEnd && textfile->moreDataAvailable) {
+        textfile->nextLine = ptr;
+        textf__readmoredata(textfile);
+        ptr = (char*)textf__findeol(textfile->nextLine, textfile->bufferEnd);
+    }
+    /* following a file: the rest of the line is skipped when it arrives */
+    if (ptr>=textfile->bufferEnd && textfile->isFollowing && !textfile->isRotated) {
+        textfile->nextLine = textfile->bufferEnd; textfile->isSkippingLine = 1;
+        return;
+    }
+    textfile->nextLine = textf__skipeol(textfile, ptr);
+}
+
+/**
+ * Moves past the provided line, that was found complete in the buffer
+ * @param textfile  The pointer to the TEXTFILE object
+ * @param line      Pointer to the first character of the line
+ * @param end       Pointer to the end of the line (its end-of-line or end-of-file)
+ */
+static void textf__acceptline(TEXTFILE* textfile, char* line, char* end) {
+    char* ptr = end;
+    assert( textfile!=NULL && line!=NULL && end!=NULL );
+    
+    /* record the line in the line index (except the empty line at the end of the file, it can grow) */
+    ++textfile->lineNumber;
+    textf__count(textfile, lineCount, 1);
+    textf__peak(textfile, longestLine, end-line);
+    if (textfile->index && (ptr<textfile->bufferEnd || ptr!=line)) { textf__addcheckpoint(textfile, line); }
+    
+    /* skip the end-of-line or mark the end-of-file with NULL */
+    textfile->nextLine = textf__skipeol(textfile, ptr);
+}
+
+/**
+ * Copies the provided line to 'lineBuffer' replacing each invalid UTF-8 sequence by U+FFFD
+ * @param textfile     The pointer to the TEXTFILE object
+ * @param line         Pointer to the first character of the line
+ * @param[in,out] end  Pointer to the end of the line, the end of the copy is returned here
+ * @returns            A pointer to the copy of the line (it has space for a string terminator) or NULL if the
+ *                     copy couldn't be allocated
+ */
+static char* textf__replaceinvalid(TEXTFILE* textfile, const char* line, char** inout_end) {
+    const char *ptr, *end, *invalid; char* out; size_t size;
+    assert( textfile!=NULL && line!=NULL && inout_end!=NULL );
+    
+    /* each invalid byte can turn into a 3 bytes U+FFFD (+1 for the string terminator) */
+    end  = (*inout_end);
+    size = 3*(size_t)(end - line) + 1;
+    if (size>textfile->lineBufferSize) {
+        textf__free(textfile, textfile->lineBuffer);
+        textfile->lineBufferSize = (size<TEXTFILE_INI_BUFSIZE ? TEXTFILE_INI_BUFSIZE : size);
+        textfile->lineBuffer     = textf__malloc(textfile, textfile->lineBufferSize);
+        if (!textfile->lineBuffer) { textfile->lineBufferSize = 0; return NULL; }
+    }
+    out = textfile->lineBuffer;
+    for (ptr=line; ptr<end; ptr=invalid-textf__utf8sequence((const unsigned char*)invalid, (const unsigned char*)end)) {
+        invalid = textf__findinvalid(ptr, end);
+        memcpy(out, ptr, (size_t)(invalid - ptr)); out += (invalid - ptr);
+        if (invalid==end) { break; }
+        *out++ = (char)0xEF; *out++ = (char)0xBF; *out++ = (char)0xBD;
+    }
+    (*inout_end) = out;
+    return textfile->lineBuffer;
+}
+
+/**
+ * Returns TRUE(1) if the provided line is valid UTF-8
+ * (the rest of the buffer is validated at once, so the next lines are only compared with 'validEnd')
+ */
+static int textf__isvalidline(TEXTFILE* textfile, const char* line, const char* end) {
+    const char* invalid;
+    assert( textfile!=NULL && line!=NULL && end!=NULL );
+    if (textfile->validEnd && end<=textfile->validEnd) { return 1; }
+    /* (a character cut at the end of the buffer is "invalid", but it's after the line and it's checked again after the refill) */
+    invalid = textf__findinvalid(line, textfile->bufferEnd);
+    textfile->validEnd = (invalid>=end ? (char*)invalid : NULL);
+    return (invalid>=end);
+}
+
+/**
+ * Validates the UTF-8 text of the line just read, applying the policy selected in 'options.validate'
+ * @param textfile     The pointer to the TEXTFILE object
+ * @param line         Pointer to the first character of the line
+ * @param[in,out] end  Pointer to the end of the line (it changes if the line is repaired)
+ * @returns            A pointer to the line (or its repaired copy) or NULL if the reading must stop
+ */
+static char* textf__validateline(TEXTFILE* textfile, char* line, char** inout_end) {
+    const char* invalid;
+    assert( textfile!=NULL && line!=NULL && inout_end!=NULL );
+    
+    /* the text produced by the decoders (UTF-16, Windows-1252, ...) is always valid */
+    if (textfile->decoder || textf__isvalidline(textfile, line, *inout_end)) { return line; }
+    invalid = textf__findinvalid(line, *inout_end);
+    
+    /* report the first error */
+    if (textfile->error==TEXTF_ERROR_NONE) {
+        textfile->error       = TEXTF_ERROR_INVALID_UTF8;
+        textfile->errorOffset = textf__lineoffset(textfile, line) + (long)(invalid - line);
+        textfile->errorLine   = textfile->lineNumber;
+    }
+    switch (textfile->options.validate) {
+        case TEXTF_VALIDATE_STOP:    textfile->nextLine = NULL; textfile->isSkippingLine = 0; return NULL;
+        case TEXTF_VALIDATE_REPLACE:
+            line = textf__replaceinvalid(textfile, line, inout_end);
+            if (!line) { textf__outofmemory(textfile); textfile->nextLine = NULL; textfile->isSkippingLine = 0; }
+            return line;
+        default:                     return line;
+    }
+}
+
+/**
+ * Skips the second half of the pair started by the end-of-line at the end of the previous data (following a file)
+ * @returns TRUE(1) if the end-of-line was completed, FALSE(0) if the next character hasn't arrived yet
+ */
+static int textf__skippendingeol(TEXTFILE* textfile) {
+    assert( textfile!=NULL && textfile->nextLine!=NULL && textfile->pendingEol );
+    if (textfile->nextLine==textfile->bufferEnd && textfile->moreDataAvailable) { textf__readmoredata(textfile); }
+    if (textfile->nextLine==textfile->bufferEnd && textfile->isFollowing)       { return 0; }
+    if (textfile->nextLine<textfile->bufferEnd && *textfile->nextLine==(textfile->pendingEol=='\r' ? '\n' : '\r')) {
+        ++textfile->nextLine;
+    }
+    textfile->pendingEol = 0;
+    return 1;
+}
+
+/**
+ * Finds the next line of text in the buffer, loading more data if needed
+ * @param textfile     The pointer to the TEXTFILE object that controls the file to read the data from
+ * @param[out] out_end Pointer to the variable where the end of the line (its end-of-line or end-of-file) will be returned
+ * @returns            A pointer to the first character of the line or NULL if there isn't more lines to read
+ */
+static char* textf__nextline(TEXTFILE* textfile, char** out_end) {
+    char *ptr, *line; int scanned; long maxLength;
+    assert( textfile!=NULL && out_end!=NULL );
+    
+    if (textfile->isSkippingLine) { textf__skipline(textfile); }
+    if (textfile->nextLine==NULL) { return NULL; }
+    
+    if (textfile->pendingEol && !textf__skippendingeol(textfile)) { return NULL; }
+    
+    /* find end-of-line */
+    maxLength = textfile->maxLineLength;
+    line = textfile->nextLine;
+    ptr  = (char*)textf__findeol(line, textfile->bufferEnd);
+    /* end-of-line NOT found in buffer (or found in the last byte, where it can be the first half of a '\r\n' pair) */
+    /* if more data is available -> load more data into buffer and CONTINUE THE SEARCH where it was left            */
+    while ((ptr+1)>=textfile->bufferEnd && textfile->moreDataAvailable && (maxLength==0 || (ptr-line)<=maxLength)) {
+        scanned = (int)(ptr - line);
+        line    = textf__readmoredata(textfile);
+        ptr     = (char*)textf__findeol(line+scanned, textfile->bufferEnd);
+    }
+    if (textfile->error==TEXTF_ERROR_OUT_OF_MEMORY) { textfile->nextLine = NULL; return NULL; }
+    /* the line doesn't fit in the maximum buffer size -> stop reading or cut it (without splitting UTF-8 characters) */
+    if (maxLength && (ptr-line)>maxLength) {
+        if (textfile->options.overflow==TEXTF_OVERFLOW_ERROR) {
+            textfile->error    = TEXTF_ERROR_LINE_TOO_LONG;
+            textfile->nextLine = NULL;
+            return NULL;
+        }
+        ptr = line + maxLength;
+        while (ptr>(line+maxLength-3) && (*ptr&0xC0)==0x80) { --ptr; }
+        if ((*ptr&0xC0)==0x80) { ptr = line + maxLength; }
+        ++textfile->lineNumber;
+        textf__count(textfile, lineCount, 1);
+        textf__peak(textfile, longestLine, ptr-line);
+        if (textfile->index) { textf__addcheckpoint(textfile, line); }
+        textfile->isSkippingLine = (textfile->options.overflow==TEXTF_OVERFLOW_TRUNCATE);
+        textfile->nextLine       = ptr;
+        (*out_end) = ptr;
+        return textfile->options.validate ? textf__validateline(textfile, line, out_end) : line;
+    }
+    /* following a file: the last line is incomplete until its end-of-line arrives */
+    if (ptr>=textfile->bufferEnd && textfile->isFollowing && !textfile->isRotated) { return NULL; }
+    (*out_end) = ptr;
+    textf__acceptline(textfile, line, ptr);
+    return textfile->options.validate ? textf__validateline(textfile, line, out_end) : line;
+}
+
+#if defined(TEXTF__STATS)
+/**
+ * Finds the next line of text measuring the time spent (the time spent refilling the buffer is counted apart)
+ */
+static char* textf__timednextline(TEXTFILE* textfile, char** out_end) {
+    double scanStart, refillTime; char* line;
+    scanStart  = textf__now();
+    refillTime = textfile->stats.refillTime;
+    line = textf__nextline(textfile, out_end);
+    textfile->stats.scanTime += (textf__now() - scanStart) - (textfile->stats.refillTime - refillTime);
+    return line;
+}
+#   define textf__nextline(textfile, out_end) textf__timednextline(textfile, out_end)
+#endif
+
+static TEXTF_EOL textf__selecteol(int count_r, int count_rn, int count_n, int count_nr) {
+    int max=count_r; TEXTF_EOL eol=TEXTF_EOL_CLASSICMAC;
+    if (count_rn>max) { max=count_rn; eol=TEXTF_EOL_WINDOWS;  }
+    if (count_n >max) { max=count_n ; eol=TEXTF_EOL_UNIX;     }
+    if (count_nr>max) { max=count_nr; eol=TEXTF_EOL_ACORNBBC; }
+    if (max==0) { eol=TEXTF_EOL_UNKNOWN; }
+    return eol;
+}
+
+/**
+ * Tells apart UTF-8 and the single-byte encodings (Windows-1252 uses the bytes 0x80..0x9F, they are control characters in ISO-8859-1)
+ * @param textfile  The pointer to the TEXTFILE object
+ * @param start     Pointer to the first block of data
+ * @param len       The size of the block in bytes
+ * @returns         TEXTF_ENCODING_UTF8 if the block is valid UTF-8 (a character cut at its end is accepted), otherwise
+ *                  the single-byte encoding selected in the options or the one detected
+ */
+static TEXTF_ENCODING textf__detectsinglebyte(const TEXTFILE* textfile, const unsigned char* start, int len) {
+    const unsigned char *ptr, *end=start+len;
+    assert( textfile!=NULL && start!=NULL );
+    
+    ptr = (const unsigned char*)textf__findinvalid((const char*)start, (const char*)end);
+    if (ptr==end || -textf__utf8sequence(ptr, end)==(int)(end-ptr)) { return TEXTF_ENCODING_UTF8; }
+    if (textfile->options.legacyEncoding!=TEXTF_ENCODING_UTF8)    { return textfile->options.legacyEncoding; }
+    for (ptr=start; ptr<end; ++ptr) { if (0x80<=*ptr && *ptr<=0x9F) { return TEXTF_ENCODING_WINDOWS1252; } }
+    return TEXTF_ENCODING_ISO8859_1;
+}
+
+static void textf__detectencoding(TEXTFILE* textfile) {
+    static const unsigned char UTF8_BOM[]     = { 239, 187, 191 };
+    static const unsigned char UTF16_BE_BOM[] = { 254, 255 };
+    static const unsigned char UTF16_LE_BOM[] = { 255, 254 };
+    int len, count, oddzeros, evenzeros, notext, isEncodingSupported;
+    int eol_rn=0, eol_r=0, eol_nr=0, eol_n=0;
+    unsigned char *ptr, *start;
+    TEXTF_ENCODING encoding = TEXTF_ENCODING_BINARY;
+    textf__timer(detectStart);
+    assert( textfile!=NULL );
+    
+    textf__starttimer(detectStart);
+    /* read blocks smaller than the buffer until it's full (the same data is examined whatever the 'blockSize') */
+    while (!textfile->isBufferReadOnly && textfile->moreDataAvailable &&
+           (textfile->bufferEnd - textfile->nextLine) < (TEXTFILE_INI_BUFSIZE-2) &&
+           ((textfile->bufferSize-2) - (textfile->bufferEnd - textfile->nextLine)) >= TEXTF__MIN_DECODE) {
+        textf__readmoredata(textfile);
+    }
+    /* detect encoding using BOM (byte order mask) */
+    /* (only the first block of data is examined, even when the whole file is mapped in memory) */
+    start = (unsigned char*)textfile->nextLine;
+    len   = (int)( (textfile->bufferEnd - textfile->nextLine) < (TEXTFILE_INI_BUFSIZE-2) ?
+                   (textfile->bufferEnd - textfile->nextLine) : (TEXTFILE_INI_BUFSIZE-2) );
+    if      (len>=3 && memcmp(start,UTF8_BOM    ,3)==0) { encoding=TEXTF_ENCODING_UTF8_BOM    ; start+=3; }
+    else if (len>=2 && memcmp(start,UTF16_BE_BOM,2)==0) { encoding=TEXTF_ENCODING_UTF16_BE_BOM; start+=2; }
+    else if (len>=2 && memcmp(start,UTF16_LE_BOM,2)==0) { encoding=TEXTF_ENCODING_UTF16_LE_BOM; start+=2; }
+    
+    /* detect encoding using an heuristic algorithm */
+    else {
+        oddzeros = evenzeros = notext = 0;
+        ptr=start; count=len/2; while (count-->0) {
+            if (*ptr==0) { ++oddzeros;  } else if (*ptr<=8 || (14<=*ptr && *ptr<=31)) { ++notext; } ++ptr;
+            if (*ptr==0) { ++evenzeros; } else if (*ptr<=8 || (14<=*ptr && *ptr<=31)) { ++notext; } ++ptr;
+        }
+        if      (oddzeros<(evenzeros/8)) { encoding=TEXTF_ENCODING_UTF16_LE; }
+        else if (evenzeros<(oddzeros/8)) { encoding=TEXTF_ENCODING_UTF16_BE; }
+        else if (notext==0)              { encoding=textf__detectsinglebyte(textfile, start, len); }
+    }
+
+    /* detect end-of-line for UTF-8, UTF-8 with BOM & single-byte encodings */
+    if (encoding==TEXTF_ENCODING_UTF8 || encoding==TEXTF_ENCODING_UTF8_BOM || encoding==TEXTF_ENCODING_WINDOWS1252 ||
+        encoding==TEXTF_ENCODING_ISO8859_1 || encoding==TEXTF_ENCODING_ISO8859_15) {
+        ptr=start; for (count=len-2; count>0; --count,++ptr) {
+            if      (ptr[0]=='\r') { if (ptr[1]=='\n') { ++eol_rn; } else { ++eol_r; } }
+            else if (ptr[0]=='\n') { if (ptr[1]=='\r') { ++eol_nr; } else { ++eol_n; } }
+        }
+    }
+    /* detect end-of-line for UTF-16BE & UTF-16BE with BOM */
+    else if (encoding==TEXTF_ENCODING_UTF16_BE || encoding==TEXTF_ENCODING_UTF16_BE_BOM) {
+        ptr=start; for (count=(len/2)-2; count>0; --count,ptr+=2) {
+            if (ptr[0]==0) {
+                if      (ptr[1]=='\r') { if (ptr[2]==0 && ptr[3]=='\n') { ++eol_rn; } else { ++eol_r; } }
+                else if (ptr[1]=='\n') { if (ptr[2]==0 && ptr[3]=='\r') { ++eol_nr; } else { ++eol_n; } }
+            }
+        }
+    }
+    /* detect end-of-line for UTF-16LE & UTF-16LE with BOM */
+    else if (encoding==TEXTF_ENCODING_UTF16_LE || encoding==TEXTF_ENCODING_UTF16_LE_BOM) {
+        ptr=start; for (count=(len/2)-2; count>0; --count,ptr+=2) {
+            if (ptr[1]==0) {
+                if      (ptr[0]=='\r') { if (ptr[3]==0 && ptr[2]=='\n') { ++eol_rn; } else { ++eol_r; } }
+                else if (ptr[0]=='\n') { if (ptr[3]==0 && ptr[2]=='\r') { ++eol_nr; } else { ++eol_n; } }
+            }
+        }
+    }
+    /* store results and return */
+    isEncodingSupported = (encoding!=TEXTF_ENCODING_BINARY);
+    textfile->encoding = encoding;
+    textfile->eol      = textf__selecteol(eol_r, eol_rn, eol_n, eol_nr);;
+    textfile->nextLine = textfissupported(textfile) ? (char*)start : NULL;
+    if (encoding!=TEXTF_ENCODING_BINARY && encoding!=TEXTF_ENCODING_UTF8 && encoding!=TEXTF_ENCODING_UTF8_BOM) {
+        textf__startdecoding(textfile, (char*)start);
+    }
+    textf__stoptimer(textfile, detectTime, detectStart);
+}
+
+
+/*=================================================================================================================*/
+#pragma mark - > LINE INDEX
+
+#define TEXTF__INDEX_MAGIC    "TFIDX\002\0\0"
+#define TEXTF__INDEX_HEADER   10  /* < number of 8-byte fields in the header of the sidecar file           */
+#define TEXTF__FINGERPRINT    64  /* < number of bytes (before the indexed size) used to detect file changes */
+
+/**
+ * Returns the offset in the file of the first line (the first byte after the BOM)
+ */
+static long textf__datastart(const TEXTFILE* textfile) {
+    assert( textfile!=NULL );
+    switch (textfile->encoding) {
+        case TEXTF_ENCODING_UTF8_BOM:     return textfile->startOffset + 3;
+        case TEXTF_ENCODING_UTF16_LE_BOM:
+        case TEXTF_ENCODING_UTF16_BE_BOM: return textfile->startOffset + 2;
+        default:                          return textfile->startOffset;
+    }
+}
+
+/**
+ * Moves the read position to the provided offset in the file (it must be the beginning of a line)
+ * @returns TRUE(1) on success or FALSE(0) if the file can't be repositioned (pipes, ...)
+ */
+static int textf__seekoffset(TEXTFILE* textfile, long offset) {
+    assert( textfile!=NULL );
+    if (offset<0) { return 0; }
+    textfile->validEnd   = NULL;
+    textfile->pendingEol = 0;
+    if (textfile->mapping) {
+        if ((size_t)offset>textfile->mappingSize) { return 0; }
+        if (textfile->decoder) {
+            textfile->rawNext           = (const unsigned char*)textfile->mapping + offset;
+            textfile->nextLine          = textfile->buffer;
+            textfile->bufferEnd         = textfile->buffer;
+            textfile->moreDataAvailable = (textfile->rawNext<textfile->rawEnd);
+        }
+        else { textfile->nextLine = textfile->mapping + offset; }
+        return 1;
+    }
+    /* the blocks read in advance are discarded, the background thread restarts at the new position */
+#if defined(TEXTF__THREADS)
+    if (textfile->readAhead && !textfile->readAhead->isSeekable) { return 0; }
+#endif
+    textf__stopreadahead(textfile);
+#if defined(TEXTF__FILEDESC)
+    if (textfile->fd>=0) { if (lseek(textfile->fd, (off_t)offset, SEEK_SET)<0) { return 0; } }
+    else
+#endif
+    if (!textfile->file || fseek(textfile->file, offset, SEEK_SET)!=0) { return 0; }
+    textf__startreadahead(textfile);
+    textfile->dataOffset        = offset;
+    textfile->nextLine          = textfile->buffer;
+    textfile->bufferEnd         = textfile->buffer;
+    textfile->moreDataAvailable = 1;
+    if (textfile->decoder) {
+        textfile->rawNext = textfile->rawEnd = (const unsigned char*)textfile->rawBuffer;
+        textfile->moreRawDataAvailable = 1;
+    }
+    return 1;
+}
+
+/**
+ * Changes the encoding of the file without detecting it again (the read position must be moved after calling it)
+ * @returns TRUE(1) on success or FALSE(0) if the encoding isn't supported
+ */
+static int textf__switchencoding(TEXTFILE* textfile, TEXTF_ENCODING encoding) {
+    int (*decoder)(TEXTFILE* textfile, char* dest, int destSize);
+    assert( textfile!=NULL );
+    
+    switch (encoding) {
+        case TEXTF_ENCODING_UTF8:
+        case TEXTF_ENCODING_UTF8_BOM:     decoder = NULL;                break;
+        case TEXTF_ENCODING_UTF16_LE:
+        case TEXTF_ENCODING_UTF16_BE:
+        case TEXTF_ENCODING_UTF16_LE_BOM:
+        case TEXTF_ENCODING_UTF16_BE_BOM: decoder = textf__decode_utf16; break;
+        case TEXTF_ENCODING_WINDOWS1252:
+        case TEXTF_ENCODING_ISO8859_1:
+        case TEXTF_ENCODING_ISO8859_15:   decoder = textf__decode_8bit;  break;
+        default:                          return 0;
+    }
+    textfile->encoding = encoding;
+    if ((decoder!=NULL)==(textfile->decoder!=NULL)) { textfile->decoder = decoder; return 1; }
+    textfile->decoder = decoder;
+    
+    /* the mapping is read directly (UTF-8) or decoded into a buffer of its own */
+    if (textfile->mapping) {
+        textf__free(textfile, textfile->expandedBuffer);
+        textfile->expandedBuffer = NULL;
+        if (decoder) {
+            textfile->rawEnd = (const unsigned char*)textfile->mapping + textfile->mappingSize;
+            textfile->moreRawDataAvailable = 0;
+            textfile->isBufferReadOnly     = 0;
+            textf__allocbuffer(textfile);
+        }
+        else {
+            textfile->buffer    = textfile->mapping;
+            textfile->bufferEnd = textfile->mapping + textfile->mappingSize;
+            textfile->moreDataAvailable = 0;
+            textfile->isBufferReadOnly  = 1;
+        }
+    }
+    /* the file is read through the raw buffer */
+    else if (decoder && !textfile->rawBuffer) {
+        textfile->rawBufferSize = textfile->options.blockSize ? textfile->options.blockSize : 2*TEXTFILE_INI_BUFSIZE;
+        textfile->rawBuffer     = textf__malloc(textfile, textfile->rawBufferSize);
+        if (!textfile->rawBuffer) { textfile->rawBufferSize = 0; textf__outofmemory(textfile); return 0; }
+    }
+    return 1;
+}
+
+#if defined(TEXTF__INDEXFILE)
+static void textf__putlong(unsigned char* ptr, long value) {
+    unsigned long uvalue = (unsigned long)value; int i;
+    for (i=0; i<8; ++i) { ptr[i] = (unsigned char)(uvalue & 0xFF); uvalue >>= 8; }
+}
+
+static long textf__getlong(const unsigned char* ptr) {
+    unsigned long uvalue=0; int i;
+    for (i=7; i>=0; --i) { uvalue = (uvalue<<8) | ptr[i]; }
+    return (long)uvalue;
+}
+
+/**
+ * Returns a hash of the bytes of the file that precede 'size' (used to verify that the file only grew)
+ */
+static long textf__fingerprint(const char* filename, long size) {
+    unsigned char bytes[TEXTF__FINGERPRINT]; unsigned long hash=2166136261UL; FILE* file; int count, i;
+    long start = (size>TEXTF__FINGERPRINT ? size-TEXTF__FINGERPRINT : 0);
+    file = fopen(filename, "rb");
+    if (!file) { return 0; }
+    count = (fseek(file, start, SEEK_SET)==0) ? (int)fread(bytes, 1, (size_t)(size-start), file) : 0;
+    fclose(file);
+    for (i=0; i<count; ++i) { hash = ((hash ^ bytes[i]) * 16777619UL) & 0xFFFFFFFFUL; }
+    return (long)hash;
+}
+
+/**
+ * Returns the path of the sidecar file containing the line index followed by 'suffix' (the string must be freed) or NULL
+ */
+static char* textf__indexfilename(TEXTFILE* textfile, const char* suffix) {
+    char* path;
+    assert( textfile!=NULL && textfile->filename!=NULL && suffix!=NULL );
+    path = textf__malloc(textfile, strlen(textfile->filename)+strlen(TEXTFILE_INDEX_EXT)+strlen(suffix)+1);
+    if (!path) { return NULL; }
+    strcpy(path, textfile->filename);
+    strcat(path, TEXTFILE_INDEX_EXT);
+    strcat(path, suffix);
+    return path;
+}
+
+/**
+ * Reads exactly 'size' bytes from a file descriptor
+ * @returns TRUE(1) on success or FALSE(0) if the data isn't available
+ */
+static int textf__readall(int fd, unsigned char* data, long size) {
+    long bytes;
+    while (size>0) {
+        bytes = (long)read(fd, data, (size_t)size);
+        if (bytes<=0) { return 0; }
+        data += bytes; size -= bytes;
+    }
+    return 1;
+}
+
+/**
+ * Writes exactly 'size' bytes to a file descriptor
+ * @returns TRUE(1) on success or FALSE(0) if the data can't be written
+ */
+static int textf__writeall(int fd, const unsigned char* data, long size) {
+    long bytes;
+    while (size>0) {
+        bytes = (long)write(fd, data, (size_t)size);
+        if (bytes<=0) { return 0; }
+        data += bytes; size -= bytes;
+    }
+    return 1;
+}
+
+/**
+ * Loads the checkpoints stored in the sidecar file if they are still valid for the file
+ * (they are valid when the file has not changed or when it only grew since the index was stored; the checkpoints
+ * must be increasing offsets inside the indexed size, otherwise the whole sidecar file is ignored)
+ */
+static void textf__readindexfile(TEXTFILE* textfile) {
+    unsigned char header[TEXTF__INDEX_HEADER*8], offset[8]; struct stat st, indexSt;
+    char* path; long size, count, i, *index; int fd, isValid;
+    assert( textfile!=NULL && textfile->index!=NULL );
+    
+    if (!textfile->options.indexFile || !textfile->filename || stat(textfile->filename,&st)!=0) { return; }
+    path = textf__indexfilename(textfile, "");
+    if (!path) { return; }
+    fd = open(path, O_RDONLY | TEXTF__NOFOLLOW);
+    textf__free(textfile, path);
+    if (fd<0) { return; }
+    
+    isValid = fstat(fd,&indexSt)==0 && textf__readall(fd, header, sizeof(header)) &&
+              memcmp(header, TEXTF__INDEX_MAGIC, 8)==0;
+    size    = isValid ? textf__getlong(&header[8])  : 0;
+    count   = isValid ? textf__getlong(&header[56]) : 0;
+    /* (the number of checkpoints must match the size of the sidecar file) */
+    isValid = isValid                                                                  &&
+              count>0 && count<=size                                                   &&
+              count == ((long)indexSt.st_size - (long)sizeof(header)) / 8              &&
+              textf__getlong(&header[24]) == (long)textfile->encoding                  &&
+              textf__getlong(&header[32]) == TEXTFILE_INDEX_STEP                       &&
+              textf__getlong(&header[64]) == (long)st.st_ino                           &&
+              ( ((long)st.st_size==size && textf__getlong(&header[16])==(long)st.st_mtime &&
+                                           textf__getlong(&header[48])==textf__mtimensec(st)) ||
+                ((long)st.st_size>size  && textf__getlong(&header[16])<=(long)st.st_mtime) )  &&
+              textf__getlong(&header[40]) == textf__fingerprint(textfile->filename,size);
+    if (isValid && count>textfile->indexCapacity) {
+        index   = textf__realloc(textfile, textfile->index, textfile->indexCapacity*sizeof(long), count*sizeof(long));
+        isValid = (index!=NULL);
+        if (index) { textfile->index = index; textfile->indexCapacity = count; }
+    }
+    for (i=0; isValid && i<count; ++i) {
+        isValid = textf__readall(fd, offset, 8);
+        textfile->index[i] = isValid ? textf__getlong(offset) : -1;
+        isValid = isValid && 0<=textfile->index[i] && textfile->index[i]<size && (i==0 || textfile->index[i-1]<textfile->index[i]);
+    }
+    if (isValid) {
+        textfile->indexCount = count;
+        /* the index was extended for a file that grew -> rewrite it */
+        textfile->isIndexModified = ((long)st.st_size!=size);
+    }
+    close(fd);
+}
+
+/**
+ * Stores the checkpoints of the line index in the sidecar file (errors are ignored, the index is only a cache)
+ * (the data is written to a new temporary file that replaces the sidecar file, so an existing file or link isn't
+ * written through; only the checkpoints inside the file are stored)
+ */
+static void textf__writeindexfile(TEXTFILE* textfile) {
+    unsigned char header[TEXTF__INDEX_HEADER*8], offset[8]; struct stat st;
+    char suffix[32], *tempPath, *path; long count, i; int fd, isWritten;
+    assert( textfile!=NULL && textfile->index!=NULL );
+    
+    if (!textfile->options.indexFile || !textfile->filename || stat(textfile->filename,&st)!=0) { return; }
+    for (count=0; count<textfile->indexCount && textfile->index[count]<(long)st.st_size; ++count) { }
+    if (count==0) { return; }
+    memcpy(header, TEXTF__INDEX_MAGIC, 8);
+    textf__putlong(&header[ 8], (long)st.st_size);
+    textf__putlong(&header[16], (long)st.st_mtime);
+    textf__putlong(&header[24], (long)textfile->encoding);
+    textf__putlong(&header[32], TEXTFILE_INDEX_STEP);
+    textf__putlong(&header[40], textf__fingerprint(textfile->filename, (long)st.st_size));
+    textf__putlong(&header[48], textf__mtimensec(st));
+    textf__putlong(&header[56], count);
+    textf__putlong(&header[64], (long)st.st_ino);
+    textf__putlong(&header[72], 0);
+    sprintf(suffix, ".%ld.tmp", (long)getpid());
+    tempPath = textf__indexfilename(textfile, suffix);
+    path     = textf__indexfilename(textfile, "");
+    if (tempPath && path) {
+        fd = open(tempPath, O_WRONLY | O_CREAT | O_EXCL | TEXTF__NOFOLLOW, 0644);
+        if (fd>=0) {
+            isWritten = textf__writeall(fd, header, sizeof(header));
+            for (i=0; isWritten && i<count; ++i) {
+                textf__putlong(offset, textfile->index[i]); isWritten = textf__writeall(fd, offset, 8);
+            }
+            isWritten = (close(fd)==0) && isWritten;
+            if (!isWritten || rename(tempPath, path)!=0) { remove(tempPath); }
+        }
+    }
+    textf__free(textfile, tempPath);
+    textf__free(textfile, path);
+}
+#endif /* if defined(TEXTF__INDEXFILE) */
+
+/**
+ * Starts using the line index, loading it from its sidecar file when available (the index stays NULL if there isn't
+ * enough memory for it)
+ */
+static void textf__loadindex(TEXTFILE* textfile) {
+    assert( textfile!=NULL && textfile->index==NULL );
+    textfile->indexCapacity = 64;
+    textfile->index         = textf__malloc(textfile, textfile->indexCapacity*sizeof(long));
+    textfile->indexCount    = 0;
+    if (!textfile->index) { textfile->indexCapacity = 0; return; }
+#if defined(TEXTF__INDEXFILE)
+    textf__readindexfile(textfile);
+#endif
+    /* the first checkpoint (line 1) is always known */
+    if (textfile->indexCount==0) {
+        textfile->index[0]        = textf__datastart(textfile);
+        textfile->indexCount      = 1;
+        textfile->isIndexModified = 1;
+    }
+}
+
+
+/*=================================================================================================================*/
+#pragma mark - > REVERSE READING
+
+#define TEXTF__TAIL_BLOCK (64*1024) /* < bytes read in each step when the file is scanned backward */
+
+/**
+ * Prepares the file to be read backward (the blocks read in advance are discarded)
+ * @returns the size of the file in bytes or -1 if it can't be read backward (pipes, terminals, ...)
+ */
+static long textf__starttail(TEXTFILE* textfile) {
+    assert( textfile!=NULL );
+    if (textfile->mapping) { return (long)textfile->mappingSize; }
+#if defined(TEXTF__THREADS)
+    if (textfile->readAhead && !textfile->readAhead->isSeekable) { return -1; }
+#endif
+    textf__stopreadahead(textfile);
+#if defined(TEXTF__FILEDESC)
+    if (textfile->fd>=0) { return (long)lseek(textfile->fd, 0, SEEK_END); }
+#endif
+    if (!textfile->file || fseek(textfile->file, 0, SEEK_END)!=0) { return -1; }
+    return ftell(textfile->file);
+}
+
+/**
+ * Returns a pointer to the raw data of the file in the range [begin,end) or NULL if it can't be read
+ * (the data is read in 'tailBuffer' when the file isn't mapped, it's valid until the next call)
+ */
+static const unsigned char* textf__tailrange(TEXTFILE* textfile, long begin, long end) {
+    int size;
+    assert( textfile!=NULL && begin<=end );
+    
+    if (textfile->mapping) { return (const unsigned char*)textfile->mapping + begin; }
+    if (begin==end)        { return (const unsigned char*)""; } /* < ex: the only line of an empty file */
+    if (textfile->tailBuffer && textfile->tailOffset<=begin && end<=(textfile->tailOffset+textfile->tailLength)) {
+        return (const unsigned char*)textfile->tailBuffer + (begin - textfile->tailOffset);
+    }
+    if ((end-begin)>textfile->tailBufferSize) {
+        textf__free(textfile, textfile->tailBuffer);
+        textfile->tailBufferSize = (end-begin)>TEXTF__TAIL_BLOCK ? (end-begin) : TEXTF__TAIL_BLOCK;
+        textfile->tailBuffer     = textf__malloc(textfile, (size_t)textfile->tailBufferSize);
+        if (!textfile->tailBuffer) { textfile->tailBufferSize = 0; return NULL; }
+    }
+    textfile->tailLength = 0;
+#if defined(TEXTF__FILEDESC)
+    if (textfile->fd>=0) { if (lseek(textfile->fd, (off_t)begin, SEEK_SET)<0) { return NULL; } }
+    else
+#endif
+    if (!textfile->file || fseek(textfile->file, begin, SEEK_SET)!=0) { return NULL; }
+    size = (int)(end - begin);
+    if (textf__readsource(textfile, textfile->tailBuffer, size)!=size) { return NULL; }
+    textf__count(textfile, bytesRead, size);
+    textfile->tailOffset = begin;
+    textfile->tailLength = size;
+    return (const unsigned char*)textfile->tailBuffer;
+}
+
+/**
+ * Returns a pointer to the raw data of the file that precedes 'end' (up to a block, its offset is returned in 'out_begin')
+ * (the pointer is to the byte at 'end', the data loaded in previous calls is reused while it reaches 'end')
+ */
+static const unsigned char* textf__tailbefore(TEXTFILE* textfile, long start, long end, int size, long* out_begin) {
+    const unsigned char* ptr; long begin;
+    assert( textfile!=NULL && start<end && out_begin!=NULL );
+    
+    if (textfile->mapping) { begin = start; }
+    else if (textfile->tailBuffer && textfile->tailOffset<end && end<=(textfile->tailOffset+textfile->tailLength)) {
+        begin = textfile->tailOffset;
+    }
+    else { begin = (end-start)>TEXTF__TAIL_BLOCK ? end-(TEXTF__TAIL_BLOCK/size)*size : start; }
+    ptr = textf__tailrange(textfile, begin, end);
+    (*out_begin) = begin;
+    return ptr ? ptr + (end - begin) : NULL;
+}
+
+/**
+ * Returns a pointer to the byte that follows the last end-of-line character in the range [begin,ptr) or NULL if there is none
+ * (UTF-8 and single-byte encodings; the blocks of 16 bytes without end-of-line are skipped with SIMD)
+ */
+static const unsigned char* textf__findeol_reverse(const unsigned char* begin, const unsigned char* ptr) {
+#if defined(TEXTF__SSE2)
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i lf = _mm_set1_epi8('\n');
+    __m128i block;
+    while ((ptr-begin)>=16) {
+        block = _mm_loadu_si128((const __m128i*)(ptr-16));
+        if (_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block,cr), _mm_cmpeq_epi8(block,lf)))) { break; }
+        ptr -= 16;
+    }
+#elif defined(TEXTF__NEON)
+    const uint8x16_t cr = vdupq_n_u8('\r');
+    const uint8x16_t lf = vdupq_n_u8('\n');
+    uint8x16_t block;
+    while ((ptr-begin)>=16) {
+        block = vld1q_u8(ptr-16);
+        if (vmaxvq_u8(vorrq_u8(vceqq_u8(block,cr), vceqq_u8(block,lf)))) { break; }
+        ptr -= 16;
+    }
+#endif
+    while (ptr>begin && ptr[-1]!='\n' && ptr[-1]!='\r') { --ptr; }
+    return ptr>begin ? ptr : NULL;
+}
+
+/**
+ * Finds the line that precedes a position of the file, scanning the file backward
+ * (it follows the same rules as `textf__nextline(..)`, so the lines are the same than reading forward)
+ * @param textfile      The pointer to the TEXTFILE object
+ * @param pos           Offset in the file of the beginning of a line (or of the end of the file if 'isEnd' is TRUE)
+ * @param isEnd         TRUE if 'pos' is the end of the file (the last line doesn't have end-of-line)
+ * @param[out] out_end  Offset in the file where the line ends (its end-of-line or the end of the file)
+ * @returns             Offset in the file of the beginning of the line or -1 if the file can't be read
+ */
+static long textf__prevline(TEXTFILE* textfile, long pos, int isEnd, long* out_end) {
+    const unsigned char *ptr, *found; unsigned int unit, prev=0; long start, begin, cur, length; int size, hi, lo;
+    assert( textfile!=NULL && out_end!=NULL );
+    
+    start = textf__datastart(textfile);
+    size  = textfile->decoder==textf__decode_utf16 ? 2 : 1;
+    hi    = (textfile->encoding==TEXTF_ENCODING_UTF16_BE || textfile->encoding==TEXTF_ENCODING_UTF16_BE_BOM) ? 0 : 1;
+    lo    = 1-hi;
+#   define textf__unit(p) (size==1 ? (unsigned int)(p)[0] : (((unsigned int)(p)[hi]<<8) | (p)[lo]))
+#   define textf__iseol(c) ((c)=='\n' || (c)=='\r')
+    
+    (*out_end) = pos;
+    pos = start + ((pos-start)/size)*size;
+    if (!isEnd) {
+        /* the end-of-line that precedes 'pos' is the last one of its run: going back to the last repeated */
+        /* character, the rest of the run is split in pairs ('\r\n' or '\n\r') as when it's read forward */
+        for (length=0, cur=pos; cur>start; cur-=size, ++length) {
+            if (!(ptr=textf__tailbefore(textfile, start, cur, size, &begin))) { return -1; }
+            unit = textf__unit(ptr-size);
+            if (!textf__iseol(unit) || (length>0 && unit==prev)) { break; }
+            prev = unit;
+        }
+        if (length>0) {
+            pos = (*out_end) = pos - ((length&1) ? 1 : 2)*size;
+            /* another end-of-line just before it -> empty line */
+            if (pos>start) {
+                if (!(ptr=textf__tailbefore(textfile, start, pos, size, &begin))) { return -1; }
+                if (textf__iseol(textf__unit(ptr-size))) { return pos; }
+            }
+        }
+    }
+    /* the beginning of the line is after the previous end-of-line (or the beginning of the file) */
+    while (pos>start) {
+        if (!(ptr=textf__tailbefore(textfile, start, pos, size, &begin))) { return -1; }
+        if (size==1) { found = textf__findeol_reverse(ptr-(pos-begin), ptr); if (found) { return pos-(ptr-found); } }
+        else {
+            for (found=ptr; found>(ptr-(pos-begin)) && !textf__iseol(textf__unit(found-size)); found-=size) { }
+            if (found>(ptr-(pos-begin))) { return pos-(ptr-found); }
+        }
+        pos = begin;
+    }
+#   undef textf__unit
+#   undef textf__iseol
+    return start;
+}
+
+/**
+ * Returns the provided range of raw data converted to UTF-8 (it's decoded in 'lineBuffer' when the file isn't UTF-8)
+ */
+static const char* textf__tailline(TEXTFILE* textfile, long begin, long end, size_t* out_length) {
+    const unsigned char *raw, *rawNext, *rawEnd; unsigned int moreRawDataAvailable; size_t size;
+    assert( textfile!=NULL && begin<=end && out_length!=NULL );
+    
+    raw = textf__tailrange(textfile, begin, end);
+    if (!raw) { return NULL; }
+    if (!textfile->decoder) { (*out_length) = (size_t)(end-begin); return (const char*)raw; }
+    
+    /* each raw byte can turn into 3 bytes of UTF-8 (+ the space the decoders require to decode one more character) */
+    size = 3*(size_t)(end-begin) + TEXTF__MIN_DECODE;
+    if (size>textfile->lineBufferSize) {
+        textf__free(textfile, textfile->lineBuffer);
+        textfile->lineBufferSize = (size<TEXTFILE_INI_BUFSIZE ? TEXTFILE_INI_BUFSIZE : size);
+        textfile->lineBuffer     = textf__malloc(textfile, textfile->lineBufferSize);
+        if (!textfile->lineBuffer) { textfile->lineBufferSize = 0; return NULL; }
+    }
+    rawNext = textfile->rawNext; rawEnd = textfile->rawEnd; moreRawDataAvailable = textfile->moreRawDataAvailable;
+    textfile->rawNext = raw; textfile->rawEnd = raw + (end-begin); textfile->moreRawDataAvailable = 0;
+    (*out_length) = (size_t)textfile->decoder(textfile, textfile->lineBuffer, (int)textfile->lineBufferSize);
+    textfile->rawNext = rawNext; textfile->rawEnd = rawEnd; textfile->moreRawDataAvailable = moreRawDataAvailable;
+    return textfile->lineBuffer;
+}
+
+
+/*=================================================================================================================*/
+#pragma mark - > FOLLOW MODE
+
+#define TEXTF__FOLLOW_POLL  250  /* < milliseconds between two checks of the followed file when inotify isn't available */
+#define TEXTF__FOLLOW_CHECK 1000 /* < maximum milliseconds waiting for inotify events (the replacement of the file is  */
+                                 /*   detected checking its name, the new file isn't watched until it's opened)       */
+#if defined(TEXTF__FOLLOW)
+
+/**
+ * Enables the follow mode if the file read through 'fd' is a regular file
+ * (pipes and terminals don't need it, 'read' waits for their data until the writer closes them)
+ */
+static void textf__startfollow(TEXTFILE* textfile) {
+    struct stat st;
+    assert( textfile!=NULL && textfile->fd>=0 );
+    textfile->isFollowing = (fstat(textfile->fd, &st)==0 && S_ISREG(st.st_mode));
+    if (textfile->isFollowing) { textfile->options.readAhead = 0; }
+}
+
+/**
+ * Opens a file to follow it while it grows (it's read through its file descriptor)
+ * @returns TRUE(1) if the file was opened or FALSE(0) if it can't be opened
+ */
+static int textf__openfollow(TEXTFILE* textfile, const char* filename) {
+    assert( textfile!=NULL && filename!=NULL );
+    textfile->fd = open(filename, O_RDONLY);
+    if (textfile->fd<0) { return 0; }
+    textf__startfollow(textfile);
+    return 1;
+}
+
+/**
+ * Restarts the reading at the beginning of the followed file (it was truncated or replaced by a new file)
+ * (the encoding detected when the file was opened is kept)
+ */
+static void textf__restartfollow(TEXTFILE* textfile) {
+    assert( textfile!=NULL );
+    textfile->startOffset     = 0;
+    textfile->lineNumber      = 0;
+    textfile->indexCount      = 0;
+    textfile->isIndexModified = 0;
+    textfile->isSkippingLine  = 0;
+    textfile->isRotated       = 0;
+    textf__seekoffset(textfile, textf__datastart(textfile));
+}
+
+/**
+ * Opens the new file that replaced the followed one (log rotation)
+ * @returns TRUE(1) if the new file was opened or FALSE(0) if it can't be opened yet
+ */
+static int textf__reopenfollow(TEXTFILE* textfile) {
+    int fd;
+    assert( textfile!=NULL && textfile->filename!=NULL );
+    
+    fd = open(textfile->filename, O_RDONLY);
+    if (fd<0) { return 0; }
+    close(textfile->fd);
+    textfile->fd = fd;
+#if defined(TEXTF__INOTIFY)
+    if (textfile->watchFd>=0) { close(textfile->watchFd); textfile->watchFd = -1; }
+#endif
+    textf__restartfollow(textfile);
+    return 1;
+}
+
+/**
+ * Checks if the followed file has changed since the last read
+ * @returns 1 if more lines can be read, 0 if the file hasn't changed or -1 if the file can't be followed
+ */
+static int textf__checkfollow(TEXTFILE* textfile) {
+    struct stat st, named;
+    assert( textfile!=NULL );
+    
+    if (!textfile->isFollowing || (textfile->nextLine==NULL && !textfile->isRotated)) { return -1; }
+    /* the rest of the replaced file was read -> continue with the new file */
+    if (textfile->isRotated) { return textfile->nextLine ? 1 : textf__reopenfollow(textfile); }
+    if (fstat(textfile->fd, &st)!=0) { return -1; }
+    
+    /* truncated -> read it again from its beginning / more data -> continue reading */
+    if ((long)st.st_size<textfile->dataOffset) { textf__restartfollow(textfile); return 1; }
+    if ((long)st.st_size>textfile->dataOffset) {
+        textfile->moreDataAvailable = 1;
+        if (textfile->decoder) { textfile->moreRawDataAvailable = 1; }
+        return 1;
+    }
+    /* replaced by a new file with the same name -> return its incomplete last line (if any) and open the new file */
+    if (textfile->filename && stat(textfile->filename, &named)==0 && (named.st_ino!=st.st_ino || named.st_dev!=st.st_dev)) {
+        if (textfile->nextLine<textfile->bufferEnd) { textfile->isRotated = 1; return 1; }
+        return textf__reopenfollow(textfile);
+    }
+    return 0;
+}
+
+/**
+ * Starts watching the followed file with inotify (if it's available and the file was opened by name)
+ */
+static void textf__watchfollow(TEXTFILE* textfile) {
+#if defined(TEXTF__INOTIFY)
+    assert( textfile!=NULL );
+    if (textfile->watchFd>=0 || !textfile->filename) { return; }
+    textfile->watchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (textfile->watchFd<0) { return; }
+    if (inotify_add_watch(textfile->watchFd, textfile->filename, IN_MODIFY|IN_ATTRIB|IN_MOVE_SELF|IN_DELETE_SELF)<0) {
+        close(textfile->watchFd); textfile->watchFd = -1;
+    }
+#else
+    (void)textfile;
+#endif
+}
+
+/**
+ * Waits for a change in the followed file or until the provided time expires (without consuming CPU)
+ */
+static void textf__waitfollow(TEXTFILE* textfile, int milliseconds) {
+#if defined(TEXTF__INOTIFY)
+    struct pollfd pfd; char events[1024];
+    assert( textfile!=NULL );
+    if (textfile->watchFd>=0) {
+        pfd.fd = textfile->watchFd; pfd.events = POLLIN; pfd.revents = 0;
+        if (poll(&pfd, 1, milliseconds)>0) { while (read(textfile->watchFd, events, sizeof(events))>0) { } }
+        return;
+    }
+#else
+    (void)textfile;
+#endif
+    poll(NULL, 0, milliseconds);
+}
+
+#else
+#   define textf__startfollow(textfile)
+#   define textf__openfollow(textfile, filename) 0
+#endif /* if defined(TEXTF__FOLLOW) */
+
+
+/*=================================================================================================================*/
+#pragma mark - > PARALLEL READER
+
+#define TEXTF__CHUNKS_PER_JOB 8
+
+typedef struct TEXTF__LINEREF {
+    size_t offset;              /* < offset of the line from the chunk 'base' */
+    size_t length;
+    long   number;
+} TEXTF__LINEREF;
+
+typedef struct TEXTF__CHUNK {
+    const char*     start;      /* < first byte of the chunk (raw data)                       */
+    const char*     end;
+    long            firstLine;  /* < number of the first line in the chunk                    */
+    long            lineCount;
+    const char*     base;       /* < data referenced by 'accepted' (the mapping or 'text')    */
+    TEXTF__LINEREF* accepted;   /* < lines accepted by the filter and waiting to be delivered */
+    int             acceptedCount;
+    int             acceptedCapacity;
+    char*           text;       /* < copy of the accepted lines (only when the file is decoded) */
+    size_t          textSize;
+    size_t          textCapacity;
+    int             isDone;
+} TEXTF__CHUNK;
+
+typedef struct TEXTF__PARALLEL {
+    TEXTFILE*       textfile;
+    const char*     dataEnd;
+    TEXTF__CHUNK*   chunks;
+    int             chunkCount;
+    int             nextChunk;     /* < next chunk to process                */
+    int             nextDelivery;  /* < next chunk to deliver (ordered mode) */
+    int             isCounting;    /* < TRUE during the line counting pass   */
+    int             ordered;
+    volatile int    stop;
+    int             isOutOfMemory; /* < TRUE if a line couldn't be kept for its delivery */
+    TEXTF_LINEFUNC  filter;
+    TEXTF_LINEFUNC  deliver;
+    void*           userData;
+#if defined(TEXTF__THREADS)
+    pthread_mutex_t queueMutex;
+    pthread_mutex_t deliveryMutex;
+#endif
+} TEXTF__PARALLEL;
+
+/**
+ * Initializes a TEXTFILE object that reads the lines contained in a range of raw data of another TEXTFILE
+ */
+static void textf__openrange(TEXTFILE* range, const TEXTFILE* textfile, const char* start, const char* end) {
+    assert( range!=NULL && textfile!=NULL && start<=end );
+    textf__init(range, NULL);
+    range->options.mallocFunc    = textfile->options.mallocFunc;
+    range->options.freeFunc      = textfile->options.freeFunc;
+    range->options.allocatorData = textfile->options.allocatorData;
+    range->encoding = textfile->encoding;
+    range->eol      = textfile->eol;
+    if (textfile->decoder) {
+        range->decoder           = textfile->decoder;
+        range->rawNext           = (const unsigned char*)start;
+        range->rawEnd            = (const unsigned char*)end;
+        range->moreDataAvailable = (start<end);
+    }
+    else {
+        range->buffer           = (char*)start;
+        range->nextLine         = (char*)start;
+        range->bufferEnd        = (char*)end;
+        range->isBufferReadOnly = 1;
+    }
+}
+
+/**
+ * Returns the position where the first line starting at (or after) 'pos' begins
+ * (it follows the same rules as `textf__nextline(..)` so that the result is the same than reading sequentially)
+ */
+static const char* textf__findlinestart(const TEXTFILE* textfile, const char* begin, const char* pos, const char* end) {
+    const unsigned char *ptr; unsigned int unit, next; int size, hi, lo;
+    assert( textfile!=NULL && begin<=pos && pos<=end );
+    
+    size = textfile->decoder==textf__decode_utf16 ? 2 : 1;
+    hi   = (textfile->encoding==TEXTF_ENCODING_UTF16_BE || textfile->encoding==TEXTF_ENCODING_UTF16_BE_BOM) ? 0 : 1;
+    lo   = 1-hi;
+#   define textf__unit(p) (size==1 ? (unsigned int)(p)[0] : (((unsigned int)(p)[hi]<<8) | (p)[lo]))
+#   define textf__iseol(c) ((c)=='\n' || (c)=='\r')
+    
+    /* align to code units and go back to the beginning of the end-of-line sequence containing 'pos' */
+    ptr = (const unsigned char*)begin + ((pos-begin)/size)*size;
+    while (ptr>(const unsigned char*)begin && textf__iseol(textf__unit(ptr-size))) { ptr-=size; }
+    /* find the next end-of-line sequence */
+    if (size==1) { ptr = (const unsigned char*)textf__findeol((const char*)ptr, end); }
+    else { while ((ptr+size)<=(const unsigned char*)end && !textf__iseol(textf__unit(ptr))) { ptr+=size; } }
+    if ((ptr+size)>(const unsigned char*)end) { return end; }
+    /* skip its first end-of-line ('\r', '\n', '\r\n' or '\n\r') */
+    unit = textf__unit(ptr); ptr+=size;
+    if ((ptr+size)<=(const unsigned char*)end) {
+        next = textf__unit(ptr);
+        if ((unit=='\r' && next=='\n') || (unit=='\n' && next=='\r')) { ptr+=size; }
+    }
+#   undef textf__unit
+#   undef textf__iseol
+    return (const char*)ptr;
+}
+
+/**
+ * Adds a line accepted by the filter to the list of lines waiting to be delivered
+ * @returns TRUE(1) on success or FALSE(0) if there isn't enough memory
+ */
+static int textf__keepline(TEXTFILE* textfile, TEXTF__CHUNK* chunk, const char* line, size_t length, long number, int copy) {
+    TEXTF__LINEREF* ref; void* data; size_t capacity;
+    assert( textfile!=NULL && chunk!=NULL && line!=NULL );
+    
+    if (chunk->acceptedCount==chunk->acceptedCapacity) {
+        capacity = chunk->acceptedCapacity ? 2*chunk->acceptedCapacity : 64;
+        data     = textf__realloc(textfile, chunk->accepted, chunk->acceptedCount*sizeof(TEXTF__LINEREF),
+                                  capacity*sizeof(TEXTF__LINEREF));
+        if (!data) { return 0; }
+        chunk->accepted         = data;
+        chunk->acceptedCapacity = (int)capacity;
+    }
+    if (copy && (chunk->textSize+length)>chunk->textCapacity) {
+        capacity = 2*(chunk->textSize+length) + TEXTFILE_INI_BUFSIZE;
+        data     = textf__realloc(textfile, chunk->text, chunk->textSize, capacity);
+        if (!data) { return 0; }
+        chunk->text         = data;
+        chunk->textCapacity = capacity;
+    }
+    ref = &chunk->accepted[chunk->acceptedCount++];
+    ref->length = length;
+    ref->number = number;
+    if (copy) {
+        if (length) { memcpy(&chunk->text[chunk->textSize], line, length); }
+        ref->offset = chunk->textSize;
+        chunk->textSize += length;
+    }
+    else {
+        ref->offset = (size_t)(line - chunk->base);
+    }
+    return 1;
+}
+
+/**
+ * Delivers all the lines of a chunk that were accepted by the filter (the delivery mutex must be locked)
+ */
+static void textf__deliverchunk(TEXTF__PARALLEL* parallel, TEXTF__CHUNK* chunk) {
+    const char* base; int i;
+    assert( parallel!=NULL && chunk!=NULL );
+    
+    base = chunk->text ? chunk->text : chunk->base;
+    for (i=0; i<chunk->acceptedCount && !parallel->stop; ++i) {
+        if (!parallel->deliver(parallel->userData, base+chunk->accepted[i].offset,
+                               chunk->accepted[i].length, chunk->accepted[i].number)) { parallel->stop=1; }
+    }
+    textf__free(parallel->textfile, chunk->accepted); chunk->accepted=NULL; chunk->acceptedCount=0;
+    textf__free(parallel->textfile, chunk->text);     chunk->text    =NULL; chunk->textSize     =0; chunk->textCapacity=0;
+}
+
+/**
+ * Returns the number of lines of a chunk, counting its end-of-lines over the raw data without reading the lines
+ * (the SIMD counter is used except in UTF-16, where the end-of-lines are code units and they're counted one by one)
+ */
+static long textf__countchunklines(const TEXTF__PARALLEL* parallel, const TEXTF__CHUNK* chunk) {
+    const TEXTFILE* textfile; const unsigned char *ptr, *end; TEXTF__EOLCOUNT count; unsigned int unit, next;
+    long lines=0; int hi, lo;
+    assert( parallel!=NULL && chunk!=NULL );
+    
+    textfile = parallel->textfile;
+    if (textfile->decoder!=textf__decode_utf16) {
+        memset(&count, 0, sizeof(count));
+        textf__counteols(&count, chunk->start, chunk->end);
+        lines = (count.cr + count.lf) - (count.crlf + count.lfcr);
+    }
+    else {
+        hi  = (textfile->encoding==TEXTF_ENCODING_UTF16_BE || textfile->encoding==TEXTF_ENCODING_UTF16_BE_BOM) ? 0 : 1;
+        lo  = 1-hi;
+        ptr = (const unsigned char*)chunk->start; end = (const unsigned char*)chunk->end;
+        for (; (ptr+2)<=end; ptr+=2) {
+            unit = ((unsigned int)ptr[hi]<<8) | ptr[lo];
+            if (unit!='\r' && unit!='\n') { continue; }
+            ++lines;
+            /* (the pairs '\r\n' and '\n\r' are one end-of-line) */
+            if ((ptr+4)<=end) {
+                next = ((unsigned int)ptr[2+hi]<<8) | ptr[2+lo];
+                if (next==(unit=='\r' ? '\n' : '\r')) { ptr+=2; }
+            }
+        }
+    }
+    /* (the chunk ends after its last end-of-line, only the last chunk has the line at the end-of-file) */
+    return chunk->end==parallel->dataEnd ? lines+1 : lines;
+}
+
+/**
+ * Reads all the lines of a chunk passing them through the filter, or only counts them during the counting pass
+ */
+static void textf__processchunk(TEXTF__PARALLEL* parallel, TEXTF__CHUNK* chunk) {
+    TEXTFILE range; char *line, *end; long number; int isLast;
+    assert( parallel!=NULL && chunk!=NULL );
+    
+    if (parallel->isCounting) { chunk->lineCount = textf__countchunklines(parallel, chunk); return; }
+    
+    isLast = (chunk->end==parallel->dataEnd);
+    number = chunk->firstLine;
+    chunk->base = chunk->start;
+    textf__openrange(&range, parallel->textfile, chunk->start, chunk->end);
+    /* the chunk ends after its last end-of-line, only the last chunk includes the (empty) line at the end-of-file */
+    while (!parallel->stop && (isLast || range.nextLine<range.bufferEnd || range.moreDataAvailable)) {
+        line = textf__nextline(&range, &end);
+        if (line==NULL) { break; }
+        if (parallel->filter==NULL || parallel->filter(parallel->userData, line, (size_t)(end-line), number)) {
+            if (parallel->deliver &&
+                !textf__keepline(parallel->textfile, chunk, line, (size_t)(end-line), number, range.decoder!=NULL)) {
+                parallel->isOutOfMemory = 1; parallel->stop = 1;
+            }
+        }
+        ++number;
+    }
+    textf__free(&range, range.expandedBuffer);
+#if defined(TEXTF__STATS)
+    textf__lock(&parallel->deliveryMutex);
+    textf__mergestats(parallel->textfile, &range);
+    textf__unlock(&parallel->deliveryMutex);
+#endif
+    if (parallel->deliver==NULL) { return; }
+    
+    /* deliver the lines in file order or as soon as the chunk is completed */
+    textf__lock(&parallel->deliveryMutex);
+    chunk->isDone = 1;
+    if (parallel->ordered) {
+        while (parallel->nextDelivery<parallel->chunkCount && parallel->chunks[parallel->nextDelivery].isDone) {
+            textf__deliverchunk(parallel, &parallel->chunks[parallel->nextDelivery++]);
+        }
+    }
+    else { textf__deliverchunk(parallel, chunk); }
+    textf__unlock(&parallel->deliveryMutex);
+}
+
+/**
+ * Processes chunks until all of them are taken (this function is executed by each thread of the pool)
+ */
+static void* textf__worker(void* parallel_) {
+    TEXTF__PARALLEL* parallel = (TEXTF__PARALLEL*)parallel_; int index;
+    assert( parallel!=NULL );
+    for (;;) {
+        textf__lock(&parallel->queueMutex);
+        index = parallel->nextChunk++;
+        textf__unlock(&parallel->queueMutex);
+        if (index>=parallel->chunkCount || parallel->stop) { return NULL; }
+        textf__processchunk(parallel, &parallel->chunks[index]);
+    }
+}
+
+/**
+ * Processes all chunks using a pool of threads (the calling thread is one of them)
+ */
+static void textf__runpool(TEXTF__PARALLEL* parallel, int jobs) {
+#if defined(TEXTF__THREADS)
+    pthread_t* threads; int i, created;
+    threads = textf__malloc(parallel->textfile, jobs*sizeof(pthread_t));
+    parallel->nextChunk = 0;
+    for (created=0; threads && created<(jobs-1); ++created) {
+        if (pthread_create(&threads[created], NULL, textf__worker, parallel)!=0) { break; }
+    }
+    textf__worker(parallel);
+    for (i=0; i<created; ++i) { pthread_join(threads[i], NULL); }
+    textf__free(parallel->textfile, threads);
+#else
+    (void)jobs;
+    parallel->nextChunk = 0;
+    textf__worker(parallel);
+#endif
+}
+
+
+/*=================================================================================================================*/
+#pragma mark - > TEXT SEARCH
+
+#define TEXTF__MAX_STARTS 4 /* < maximum number of different first bytes searched with SIMD */
+
+struct TEXTF_SEARCH {
+    TEXTF_OPTIONS   options;      /* < only its allocator is used (malloc/free by default) */
+    int             flags;
+    int             patternCount;
+    size_t*         lengths;        /* < length of each pattern                                                     */
+    int             stateCount;     /* < number of states of the automaton (state 0 = nothing matched)             */
+    int             classCount;     /* < number of byte classes (the bytes not used by the patterns are class 0)   */
+    unsigned short  classes[256];   /* < class of each byte (with IGNORECASE both cases of a letter share class)   */
+    int*            next;           /* < transition table of the automaton [state*classCount + class]              */
+    int*            found;          /* < pattern found when each state is reached (-1 = none)                      */
+    unsigned char   isStart[256];   /* < TRUE for the bytes that can start a pattern                               */
+    unsigned char   starts[TEXTF__MAX_STARTS]; /* < the bytes that can start a pattern (when they are only a few) */
+    int             startCount;     /* < number of elements in 'starts' (0 = too many, only 'isStart' is used)     */
+};
+
+/**
+ * Returns a pointer to the first byte in the range [ptr,end) that can start a pattern or 'end' if there is none
+ */
+static const unsigned char* textf__findstart(const TEXTF_SEARCH* search, const unsigned char* ptr, const unsigned char* end) {
+#if defined(TEXTF__SSE2)
+    __m128i block, matches, starts[TEXTF__MAX_STARTS]; int i, mask;
+    if (search->startCount>0) {
+        for (i=0; i<search->startCount; ++i) { starts[i] = _mm_set1_epi8((char)search->starts[i]); }
+        while ((end-ptr)>=16) {
+            block   = _mm_loadu_si128((const __m128i*)ptr);
+            matches = _mm_cmpeq_epi8(block, starts[0]);
+            for (i=1; i<search->startCount; ++i) { matches = _mm_or_si128(matches, _mm_cmpeq_epi8(block, starts[i])); }
+            mask = _mm_movemask_epi8(matches);
+            if (mask) { return ptr + textf__ctz((unsigned int)mask); }
+            ptr += 16;
+        }
+    }
+#elif defined(TEXTF__NEON)
+    uint8x16_t block, matches, starts[TEXTF__MAX_STARTS]; int i;
+    if (search->startCount>0) {
+        for (i=0; i<search->startCount; ++i) { starts[i] = vdupq_n_u8(search->starts[i]); }
+        while ((end-ptr)>=16) {
+            block   = vld1q_u8(ptr);
+            matches = vceqq_u8(block, starts[0]);
+            for (i=1; i<search->startCount; ++i) { matches = vorrq_u8(matches, vceqq_u8(block, starts[i])); }
+            if (vmaxvq_u8(matches)) { break; }
+            ptr += 16;
+        }
+    }
+#endif
+    while (ptr<end && !search->isStart[*ptr]) { ++ptr; }
+    return ptr;
+}
+
+/**
+ * Returns a pointer to the first occurrence of any of the patterns in the range [begin,end) or 'end' if there is none
+ * (the occurrence reported is the one that ends first, the index of its pattern is returned in 'out_pattern')
+ */
+static const char* textf__searchtext(const TEXTF_SEARCH* search, const char* begin, const char* end, int* out_pattern) {
+    const unsigned char *ptr=(const unsigned char*)begin, *uend=(const unsigned char*)end;
+    const int *next=search->next, *found=search->found; int state=0, classCount=search->classCount;
+    assert( search!=NULL && begin<=end && out_pattern!=NULL );
+    
+    if (found[0]>=0) { *out_pattern = found[0]; return begin; }
+    while (ptr<uend) {
+        /* outside of any partial match -> jump to the next byte that can start a pattern */
+        if (state==0) { ptr = textf__findstart(search, ptr, uend); if (ptr==uend) { break; } }
+        state = next[state*classCount + search->classes[*ptr++]];
+        if (found[state]>=0) {
+            *out_pattern = found[state];
+            return (const char*)ptr - search->lengths[found[state]];
+        }
+    }
+    return end;
+}
+
+
+/*=================================================================================================================*/
+#pragma mark - > TEXTFILE IMPLEMENTATION
+
+/**
+ * Opens a file and returns a TEXTFILE object that controls it
+ *
+ * @param filename  The path to the file to open
+ * @param mode      A null-terminated string determining the file access mode:
+ *                    "r"  = read the file through a buffer
+ *                    "rm" = map the whole file in memory (read-only), falls back to "r" for pipes and special files
+ *                    "rf" = follow the file while it grows (logs), the incomplete last line is returned when its
+ *                           end-of-line arrives and `textfwait(..)` waits for more data (POSIX systems only)
+ * @returns         The pointer to the TEXTFILE object that controls the opened file or NULL if an error has ocurred.
+ */
+TEXTFILE* textfopen(const char* filename, const char* mode) {
+    return textfopen_ex(filename, mode, NULL);
+}
+
+/**
+ * Opens a file using the provided options and returns a TEXTFILE object that controls it
+ *
+ * @param filename  The path to the file to open
+ * @param mode      A null-terminated string determining the file access mode ("r", "rm" or "rf", see textfopen)
+ * @param options   The size of the buffers, the policy for long lines and the memory allocator (NULL = defaults)
+ * @returns         The pointer to the TEXTFILE object that controls the opened file or NULL if an error has ocurred.
+ */
+TEXTFILE* textfopen_ex(const char* filename, const char* mode, const TEXTF_OPTIONS* options) {
+    TEXTFILE* textfile; FILE* file=NULL; int mapped, followed;
+    assert( filename!=NULL );
+    assert( mode[0]=='r' && (mode[1]=='\0' || ((mode[1]=='m' || mode[1]=='f') && mode[2]=='\0')) );
+
+    textfile = textf__new(options);
+    if (!textfile) { return NULL; }
+    textfile->filename = textf__malloc(textfile, strlen(filename)+1);
+    if (!textfile->filename) { textfclose(textfile); return NULL; }
+    strcpy(textfile->filename, filename);
+    
+    /* map the whole file in memory or, if that is not possible, open it and read the first chunk of data */
+    /* (the followed files are read through their file descriptor, its size is checked while they grow)   */
+    mapped   = (mode[1]=='m') && textf__mapfile(textfile, filename);
+    followed = (mode[1]=='f') && textf__openfollow(textfile, filename);
+    if (!mapped && !followed) {
+        file = fopen(filename,"r");
+        if (!file) { textfclose(textfile); return NULL; }
+    }
+    if (!mapped) { textf__allocbuffer(textfile); }
+    textfile->file = file;
+    if (file)    { textf__startreadahead(textfile); }
+    if (!mapped) { textf__readmoredata(textfile);   }
+    textf__detectencoding(textfile);
+    return textfile;
+}
+
+/**
+ * Returns a TEXTFILE object that reads the lines contained in a block of memory (without copying it)
+ *
+ * @param data      Pointer to the text, it must remain valid and unmodified until the TEXTFILE object is closed
+ * @param size      The size of the text in bytes
+ * @returns         The pointer to the TEXTFILE object that controls the text or NULL if an error has ocurred
+ */
+TEXTFILE* textfopen_mem(const void* data, size_t size) {
+    return textfopen_mem_ex(data, size, NULL);
+}
+
+/**
+ * Returns a TEXTFILE object that reads the lines contained in a block of memory using the provided options
+ *
+ * @param data      Pointer to the text, it must remain valid and unmodified until the TEXTFILE object is closed
+ * @param size      The size of the text in bytes
+ * @param options   The options used to read the text, see textfopen_ex (NULL = defaults)
+ * @returns         The pointer to the TEXTFILE object that controls the text or NULL if an error has ocurred
+ */
+TEXTFILE* textfopen_mem_ex(const void* data, size_t size, const TEXTF_OPTIONS* options) {
+    TEXTFILE* textfile;
+    assert( data!=NULL || size==0 );
+    
+    textfile = textf__new(options);
+    if (!textfile) { return NULL; }
+    /* the block of memory is used as a read-only mapping of the whole file */
+    /* (an empty text is an empty mapping too, so it can be repositioned and read backward like the others) */
+    textfile->mapping        = size>0 ? (char*)data : (char*)"";
+    textfile->mappingSize    = size;
+    textfile->isMappingOwned = 0;
+    textfile->dataOffset     = (long)size;
+    textfile->buffer         = textfile->mapping;
+    textfile->nextLine       = textfile->mapping;
+    textfile->bufferEnd      = textfile->mapping + size;
+    textfile->isBufferReadOnly = 1;
+    textf__detectencoding(textfile);
+    return textfile;
+}
+
+/**
+ * Returns a TEXTFILE object that reads the file associated with a file descriptor (POSIX systems only)
+ *
+ * @param fd        The file descriptor, it's read from its current position and closed by textfclose()
+ * @param mode      "r", "rm" or "rf" (see textfopen), "rm" maps the file only if it's a regular file read from its beginning
+ * @returns         The pointer to the TEXTFILE object that controls the file or NULL if an error has ocurred
+ */
+TEXTFILE* textfdopen(int fd, const char* mode) {
+    return textfdopen_ex(fd, mode, NULL);
+}
+
+/**
+ * Returns a TEXTFILE object that reads the file associated with a file descriptor using the provided options
+ *
+ * @param fd        The file descriptor, it's read from its current position and closed by textfclose()
+ * @param mode      "r", "rm" or "rf" (see textfdopen)
+ * @param options   The size of the buffers, the policy for long lines and the memory allocator (NULL = defaults)
+ * @returns         The pointer to the TEXTFILE object that controls the file or NULL if an error has ocurred
+ */
+TEXTFILE* textfdopen_ex(int fd, const char* mode, const TEXTF_OPTIONS* options) {
+#if defined(TEXTF__FILEDESC)
+    TEXTFILE* textfile; off_t position; int mapped;
+    assert( fd>=0 );
+    assert( mode[0]=='r' && (mode[1]=='\0' || ((mode[1]=='m' || mode[1]=='f') && mode[2]=='\0')) );
+    
+    textfile = textf__new(options);
+    if (!textfile) { return NULL; }
+    position = lseek(fd, 0, SEEK_CUR);
+    mapped   = (mode[1]=='m') && position==0 && textf__mapfd(textfile, fd);
+    textfile->fd = fd;
+    if (!mapped) {
+        textfile->startOffset = textfile->dataOffset = (position>0 ? (long)position : 0);
+        if (mode[1]=='f') { textf__startfollow(textfile); }
+        textf__allocbuffer(textfile);
+        if (mode[1]!='f') { textf__startreadahead(textfile); }
+        textf__readmoredata(textfile);
+    }
+    textf__detectencoding(textfile);
+    return textfile;
+#else
+    (void)fd; (void)mode; (void)options;
+    return NULL;
+#endif
+}
+
+/**
+ * Returns a TEXTFILE object that reads an already open stream (ex: stdin)
+ *
+ * @param stream    The stream, it's read from its current position and it's NOT closed by textfclose()
+ * @returns         The pointer to the TEXTFILE object that controls the stream or NULL if an error has ocurred
+ */
+TEXTFILE* textfopen_stream(FILE* stream) {
+    return textfopen_stream_ex(stream, NULL);
+}
+
+/**
+ * Returns a TEXTFILE object that reads an already open stream using the provided options
+ *
+ * @param stream    The stream, it's read from its current position and it's NOT closed by textfclose()
+ * @param options   The size of the buffers, the policy for long lines and the memory allocator (NULL = defaults)
+ * @returns         The pointer to the TEXTFILE object that controls the stream or NULL if an error has ocurred
+ */
+TEXTFILE* textfopen_stream_ex(FILE* stream, const TEXTF_OPTIONS* options) {
+    TEXTFILE* textfile; long position;
+    assert( stream!=NULL );
+    
+    textfile = textf__new(options);
+    if (!textfile) { return NULL; }
+    position = ftell(stream);
+    textfile->file        = stream;
+    textfile->isFileOwned = 0;
+    textfile->startOffset = textfile->dataOffset = (position>0 ? position : 0);
+    textf__allocbuffer(textfile);
+    textf__startreadahead(textfile);
+    textf__readmoredata(textfile);
+    textf__detectencoding(textfile);
+    return textfile;
+}
+
+/**
+ * Read a line of text from the provided file
+ * @param textfile  The pointer to a TEXTFILE object that controls the file to read the data from
+ * @returns         A pointer to the buffer containing the read line or NULL if there isn't more lines to read
+ */
+char* textfgetline(TEXTFILE* textfile) {
+    char *line, *end; size_t length;
+    assert( textfile!=NULL );
+    
+    line = textf__nextline(textfile, &end);
+    if (line==NULL) { return NULL; }
+    
+    /* the mapped file is read-only (or the line was split and the next piece starts at its end) */
+    /* -> copy the line to a buffer where it can be null-terminated (unless it's already a copy)  */
+    if ((textfile->isBufferReadOnly || end==textfile->nextLine) && line!=textfile->lineBuffer) {
+        length = (size_t)(end - line);
+        if (length>=textfile->lineBufferSize) {
+            textf__free(textfile, textfile->lineBuffer);
+            textfile->lineBufferSize = (length<TEXTFILE_INI_BUFSIZE ? TEXTFILE_INI_BUFSIZE : 2*length);
+            textfile->lineBuffer     = textf__malloc(textfile, textfile->lineBufferSize);
+            if (!textfile->lineBuffer) { textfile->lineBufferSize = 0; return NULL; }
+        }
+        memcpy(textfile->lineBuffer, line, length);
+        line = textfile->lineBuffer;
+        end  = textfile->lineBuffer + length;
+    }
+    /* mark the end-of-line (or end-of-file) with a string terminator '\0' */
+    *end = '\0';
+    return line;
+}
+
+/**
+ * Read a line of text from the provided file without copying or modifying it
+ * (the returned line is NOT null-terminated, it can contain '\0' characters and it's only valid until the next read operation)
+ * @param textfile        The pointer to a TEXTFILE object that controls the file to read the data from
+ * @param[out] out_length Pointer to the variable where the length of the line (in bytes) will be returned
+ * @returns               A pointer to the first character of the line or NULL if there isn't more lines to read
+ */
+const char* textfgetline_n(TEXTFILE* textfile, size_t* out_length) {
+    char *line, *end;
+    assert( textfile!=NULL && out_length!=NULL );
+    
+    line = textf__nextline(textfile, &end);
+    (*out_length) = line ? (size_t)(end - line) : 0;
+    return line;
+}
+
+/**
+ * Read several lines of text from the provided file without copying or modifying them
+ * (all the complete lines available in the buffer are returned, the buffer is refilled only when they are drained)
+ * @param textfile  The pointer to a TEXTFILE object that controls the file to read the data from
+ * @param spans     Array where the position and length of each line will be returned (the lines are NOT null-terminated)
+ * @param max       The number of elements in the 'spans' array
+ * @returns         The number of lines returned (0 if there isn't more lines to read), they are valid until the next read operation
+ */
+int textfgetlines(TEXTFILE* textfile, TEXTF_SPAN* spans, int max) {
+    char *line, *end; long maxLength; int count, validate;
+    textf__timer(scanStart);
+    assert( textfile!=NULL && spans!=NULL && max>0 );
+    
+    /* the first line can refill the buffer (the lines returned by the previous call are no longer valid) */
+    line = textf__nextline(textfile, &end);
+    if (line==NULL) { return 0; }
+    spans[0].line = line; spans[0].length = (size_t)(end - line);
+    
+    /* the next lines are taken while they are complete in the buffer (no refill, so all the lines stay valid) */
+    /* (the lines with invalid UTF-8 are left to the next call, their copy can't be shared)                    */
+    maxLength = textfile->maxLineLength;
+    validate  = (textfile->options.validate && !textfile->decoder);
+    textf__starttimer(scanStart);
+    for (count=1; count<max && textfile->nextLine!=NULL && !textfile->isSkippingLine; ++count) {
+        line = textfile->nextLine;
+        end  = (char*)textf__findeol(line, textfile->bufferEnd);
+        if ((end+1)>=textfile->bufferEnd && textfile->moreDataAvailable) { break; }
+        if (end>=textfile->bufferEnd && textfile->isFollowing)            { break; }
+        if (maxLength && (end-line)>maxLength)                            { break; }
+        if (validate && !textf__isvalidline(textfile, line, end))         { break; }
+        spans[count].line = line; spans[count].length = (size_t)(end - line);
+        textf__acceptline(textfile, line, end);
+    }
+    textf__stoptimer(textfile, scanTime, scanStart);
+    return count;
+}
+
+/**
+ * Read the next line of text that contains any of the patterns, without copying or modifying it
+ * (the whole buffer is searched at once and the lines without occurrences are skipped without examining them)
+ * @param textfile         The pointer to a TEXTFILE object that controls the file to read the data from
+ * @param search           Pointer to a TEXTF_SEARCH object created with `textfsearch_new(..)`
+ * @param[out] out_length  Pointer to the variable where the length of the line (in bytes) will be returned
+ * @param[out] out_pattern Pointer to the variable where the index of the pattern found will be returned (can be NULL)
+ * @returns                A pointer to the first character of the line (NOT null-terminated) or NULL if there isn't more
+ *                         lines containing the patterns; the number of the line is available in `textfile->lineNumber`
+ */
+const char* textfgetmatch(TEXTFILE* textfile, const TEXTF_SEARCH* search, size_t* out_length, int* out_pattern) {
+    char *line, *end; const char* hit; long maxLength; int pattern, validate;
+    textf__timer(scanStart);
+    assert( textfile!=NULL && search!=NULL && out_length!=NULL );
+    
+    maxLength = textfile->maxLineLength;
+    validate  = (textfile->options.validate && !textfile->decoder);
+    while (textfile->nextLine!=NULL) {
+        /* search the rest of the buffer at once and skip the complete lines before the first occurrence */
+        /* (with the same conditions used by 'textfgetlines(..)' to take the lines directly from the buffer) */
+        if (!textfile->isSkippingLine) {
+            textf__starttimer(scanStart);
+            hit = textf__searchtext(search, textfile->nextLine, textfile->bufferEnd, &pattern);
+            while (textfile->nextLine!=NULL) {
+                line = textfile->nextLine;
+                end  = (char*)textf__findeol(line, textfile->bufferEnd);
+                if (end>=hit)                                                     { break; }
+                if ((end+1)>=textfile->bufferEnd && textfile->moreDataAvailable) { break; }
+                if (end>=textfile->bufferEnd && textfile->isFollowing)            { break; }
+                if (maxLength && (end-line)>maxLength)                            { break; }
+                if (validate && !textf__isvalidline(textfile, line, end))         { break; }
+                textf__acceptline(textfile, line, end);
+            }
+            textf__stoptimer(textfile, scanTime, scanStart);
+        }
+        /* read the next line as usual (it can need a refill or a copy) and confirm the occurrence */
+        line = textf__nextline(textfile, &end);
+        if (line==NULL) { break; }
+        pattern = -1;
+        textf__searchtext(search, line, end, &pattern);
+        if (pattern>=0) {
+            if (out_pattern) { (*out_pattern) = pattern; }
+            (*out_length) = (size_t)(end - line);
+            return line;
+        }
+    }
+    (*out_length) = 0;
+    return NULL;
+}
+
+/**
+ * Counts the lines from the current position to the end of the file without returning them
+ * @param textfile        The pointer to a TEXTFILE object that controls the file to read the data from
+ * @param[out] out_counts Pointer to the structure where the number of end-of-lines of each style will be returned (can be NULL)
+ * @returns               The number of lines counted (0 if there isn't more lines to read)
+ */
+long textfcountlines(TEXTFILE* textfile, TEXTF_EOLCOUNTS* out_counts) {
+    TEXTF__EOLCOUNT count; TEXTF_VALIDATE validate; char *line, *end; long lines=0;
+    textf__timer(scanStart);
+    assert( textfile!=NULL );
+    
+    memset(&count, 0, sizeof(count));
+    if (textfile->isSkippingLine) { textf__skipline(textfile); }
+    if (textfile->nextLine!=NULL && (!textfile->pendingEol || textf__skippendingeol(textfile))) {
+        
+        /* following a file, cutting long lines or validating UTF-8 -> the lines are read one by one */
+        /* (replacing the invalid UTF-8 doesn't change the end-of-lines, so the lines are only validated) */
+        if (textfile->isFollowing || textfile->maxLineLength || (textfile->options.validate && !textfile->decoder)) {
+            validate = textfile->options.validate;
+            if (validate==TEXTF_VALIDATE_REPLACE) { textfile->options.validate = TEXTF_VALIDATE_REPORT; }
+            while ((line=textf__nextline(textfile, &end))!=NULL) {
+                ++lines;
+                if (end>=textfile->bufferEnd || textfile->isSkippingLine) { continue; }
+                if      (textfile->nextLine==(end+2)) { if (*end=='\r') { ++count.crlf; } else if (*end=='\n') { ++count.lfcr; } }
+                else if (*end=='\r')                  { ++count.cr; }
+                else if (*end=='\n')                  { ++count.lf; }
+            }
+            textfile->options.validate = validate;
+            count.cr += count.crlf + count.lfcr; count.lf += count.crlf + count.lfcr;
+        }
+        /* otherwise the end-of-lines are counted over the whole buffer, refilling it until the end of the file */
+        /* (the single-byte encodings share '\r' and '\n' with ASCII, their raw data is counted without decoding) */
+        else {
+            textf__starttimer(scanStart);
+            textf__counteols(&count, textfile->nextLine, textfile->bufferEnd);
+            textfile->nextLine = textfile->bufferEnd;
+            if (textfile->decoder==textf__decode_8bit) {
+                textf__counteols(&count, (const char*)textfile->rawNext, (const char*)textfile->rawEnd);
+                textfile->rawNext = textfile->rawEnd;
+                while (textfile->moreRawDataAvailable) {
+                    textf__readmorerawdata(textfile);
+                    textf__counteols(&count, (const char*)textfile->rawNext, (const char*)textfile->rawEnd);
+                    textfile->rawNext = textfile->rawEnd;
+                }
+                textfile->moreDataAvailable = 0;
+            }
+            while (textfile->moreDataAvailable) {
+                textf__readmoredata(textfile);
+                textf__counteols(&count, textfile->nextLine, textfile->bufferEnd);
+                textfile->nextLine = textfile->bufferEnd;
+            }
+            textfile->validEnd = NULL;
+            textfile->nextLine = NULL;
+            /* (a pair counts as one end-of-line, and the text after the last end-of-line is one more line) */
+            lines = (count.cr + count.lf) - (count.crlf + count.lfcr) + 1;
+            textfile->lineNumber += lines;
+            textf__count(textfile, lineCount, lines);
+            textf__stoptimer(textfile, scanTime, scanStart);
+        }
+    }
+    if (out_counts) {
+        out_counts->crlf = count.crlf;
+        out_counts->lfcr = count.lfcr;
+        out_counts->cr   = count.cr - (count.crlf + count.lfcr);
+        out_counts->lf   = count.lf - (count.crlf + count.lfcr);
+    }
+    return lines;
+}
+
+/**
+ * Moves the read position to the beginning of the provided line
+ *
+ * The position of every TEXTFILE_INDEX_STEP lines is recorded while reading, so that later calls can jump directly
+ * to any line. With the 'indexFile' option it's also kept in a sidecar file (filename + TEXTFILE_INDEX_EXT) for
+ * later runs.
+ *
+ * @param textfile   Pointer to a TEXTFILE object that identifies a file opened with the 'textfopen' function
+ * @param lineNumber The number of the line to be returned by the next read operation (starting at 1)
+ * @returns          Zero (0) on success or -1 if the file doesn't have that line (or it can't be reached)
+ */
+int textfseekline(TEXTFILE* textfile, long lineNumber) {
+    long linesToSkip, checkpoint; char* end;
+    assert( textfile!=NULL );
+    
+    if (!textfissupported(textfile)) { return -1; }
+    if (!textfile->index) { textf__loadindex(textfile); }
+    if (!textfile->index) { return -1; }
+    
+    /* jump to the nearest checkpoint if it's ahead, if the line is behind or if the lines read were not indexed */
+    linesToSkip = (lineNumber>1 ? lineNumber-1 : 0);
+    checkpoint  = linesToSkip / TEXTFILE_INDEX_STEP;
+    if (checkpoint>=textfile->indexCount) { checkpoint = textfile->indexCount-1; }
+    if ( (checkpoint*TEXTFILE_INDEX_STEP) > textfile->lineNumber ||
+         linesToSkip < textfile->lineNumber                      ||
+         textfile->lineNumber > (textfile->indexCount*TEXTFILE_INDEX_STEP) )
+    {
+        if (textf__seekoffset(textfile, textfile->index[checkpoint])) {
+            textfile->lineNumber = checkpoint*TEXTFILE_INDEX_STEP;
+        }
+    }
+    /* read the remaining lines (they are recorded in the index) */
+    while (textfile->lineNumber<linesToSkip) {
+        if (!textf__nextline(textfile, &end)) { return -1; }
+    }
+    return (textfile->lineNumber==linesToSkip && textfile->nextLine!=NULL) ? 0 : -1;
+}
+
+/**
+ * Moves the read position to the beginning of the last lines of the file
+ *
+ * The file is scanned backward from its end, so the cost depends on the number of lines and not on the size of the file.
+ * The number of lines of the file is unknown, so the lines are numbered from the end of the file (the last line is -1),
+ * except when the beginning of the file is reached (then they are numbered from 1 as usual).
+ *
+ * @param textfile   Pointer to a TEXTFILE object that identifies a file opened with the 'textfopen' function
+ * @param lineCount  The number of lines to be returned by the next read operations (0 = move to the end of the file)
+ * @returns          Zero (0) on success or -1 if the file can't be read backward (pipes, terminals, ...)
+ */
+int textfseektail(TEXTFILE* textfile, long lineCount) {
+    long size, start, pos, end, count, incomplete; int isEnd;
+    assert( textfile!=NULL );
+    
+    if (!textfissupported(textfile)) { return -1; }
+    if ((size=textf__starttail(textfile))<0) { return -1; }
+    /* following a file, its last line is incomplete (it's returned when its end-of-line arrives) and it isn't counted */
+    incomplete = textfile->isFollowing ? 1 : 0;
+    start = textf__datastart(textfile);
+    pos   = size; isEnd = 1;
+    for (count=0; count<(lineCount+incomplete) && (isEnd || pos>start); ++count) {
+        if ((pos=textf__prevline(textfile, pos, isEnd, &end))<0) { break; }
+        isEnd = 0;
+    }
+    /* on error the read position is left at the end of the file */
+    textfile->isSkippingLine = 0;
+    if (pos<0 || !textf__seekoffset(textfile, pos)) {
+        textf__seekoffset(textfile, size); textfile->nextLine = NULL;
+        return -1;
+    }
+    if (isEnd) { textfile->nextLine = NULL; }
+    textfile->lineNumber = (!isEnd && pos<=start) ? 0 : -(count-incomplete)-1;
+    return 0;
+}
+
+/**
+ * Read the line that precedes the read position and move the read position back to its beginning
+ * (the lines are returned newest-first, call `textfseektail(textfile,0)` to start from the end of the file)
+ * @param textfile         The pointer to a TEXTFILE object that controls the file to read the data from
+ * @param[out] out_length  Pointer to the variable where the length of the line (in bytes) will be returned
+ * @returns                A pointer to the first character of the line (NOT null-terminated) or NULL if the beginning of
+ *                         the file was reached (or it can't be read backward); the number of the line is `lineNumber+1`
+ */
+const char* textfgetprevline(TEXTFILE* textfile, size_t* out_length) {
+    const char* line=NULL; long size, position, start, end; int isEnd;
+    assert( textfile!=NULL && out_length!=NULL );
+    
+    (*out_length) = 0;
+    if (!textfissupported(textfile)) { return NULL; }
+    isEnd    = (textfile->nextLine==NULL);
+    position = isEnd ? 0 : textf__lineoffset(textfile, textfile->nextLine);
+    if (!isEnd && position<=textf__datastart(textfile)) { return NULL; }
+    if ((size=textf__starttail(textfile))<0) { return NULL; }
+    if (isEnd) { position = size; }
+    
+    start = textf__prevline(textfile, position, isEnd, &end);
+    if (start>=0) { line = textf__tailline(textfile, start, end, out_length); }
+    /* the read position is moved to the beginning of the line (the line is kept in 'tailBuffer' or 'lineBuffer') */
+    /* or it's restored on error                                                                                   */
+    textfile->isSkippingLine = 0;
+    if (!line || !textf__seekoffset(textfile, start)) {
+        textf__seekoffset(textfile, position); if (isEnd) { textfile->nextLine = NULL; }
+        (*out_length) = 0;
+        return NULL;
+    }
+    --textfile->lineNumber;
+    return line;
+}
+
+/**
+ * Returns the read position of the file, so the reading can be resumed from there later (even by another process)
+ *
+ * @param textfile      Pointer to a TEXTFILE object that identifies a file opened with the 'textfopen' function
+ * @param[out] out_pos  Pointer to the TEXTF_POS structure where the position (offset, line number, encoding, ...) is returned
+ * @returns             Zero (0) on success or -1 if the encoding of the file isn't supported
+ */
+int textftell(TEXTFILE* textfile, TEXTF_POS* out_pos) {
+    assert( textfile!=NULL && out_pos!=NULL );
+    
+    if (!textfissupported(textfile)) { return -1; }
+    out_pos->offset         = textf__lineoffset(textfile, textfile->nextLine ? textfile->nextLine : textfile->bufferEnd);
+    out_pos->lineNumber     = textfile->lineNumber;
+    out_pos->encoding       = textfile->encoding;
+    out_pos->eol            = textfile->eol;
+    out_pos->pendingEol     = textfile->pendingEol;
+    out_pos->isSkippingLine = (int)textfile->isSkippingLine;
+    out_pos->isEnd          = (textfile->nextLine==NULL);
+    return 0;
+}
+
+/**
+ * Moves the read position to a position returned by `textftell(..)`
+ *
+ * @param textfile   Pointer to a TEXTFILE object that identifies a file opened with the 'textfopen' function
+ * @param pos        Pointer to the position returned by `textftell(..)` for the same file
+ * @returns          Zero (0) on success or -1 if the file can't be repositioned (pipes, terminals, ...)
+ */
+int textfseek(TEXTFILE* textfile, const TEXTF_POS* pos) {
+    long offset, start; int isSameEncoding;
+    assert( textfile!=NULL && pos!=NULL );
+    
+    isSameEncoding = (pos->encoding==textfile->encoding);
+    if (!textf__switchencoding(textfile, pos->encoding)) { return -1; }
+    textfile->eol = pos->eol;
+    
+    /* (a position inside the BOM or inside a UTF-16 code unit is moved to the beginning of the character) */
+    start  = textf__datastart(textfile);
+    offset = pos->offset>start ? pos->offset : start;
+    if (textfile->decoder==textf__decode_utf16) { offset = start + ((offset-start)/2)*2; }
+    if (!textf__seekoffset(textfile, offset)) {
+        /* the buffer contains data in the previous encoding -> the reading can't continue */
+        if (!isSameEncoding) { textfile->nextLine = NULL; }
+        return -1;
+    }
+    textfile->lineNumber     = pos->lineNumber;
+    textfile->pendingEol     = pos->pendingEol;
+    textfile->isSkippingLine = pos->isSkippingLine ? 1 : 0;
+    /* all the lines were read -> only the data appended later (if any) is read */
+    /* (a lone byte at the end of a UTF-16 file was already returned, it's read again only if the file grew) */
+    if (pos->isEnd) {
+        if (textfile->nextLine==textfile->bufferEnd && textfile->moreDataAvailable) { textf__readmoredata(textfile); }
+        if (textf__lineoffset(textfile, textfile->bufferEnd)<=pos->offset) { textfile->nextLine = NULL; }
+    }
+    return 0;
+}
+
+/**
+ * Waits until more data is appended to a file opened in follow mode ("rf")
+ *
+ * @param textfile  Pointer to a TEXTFILE object opened with the "rf" mode
+ * @param timeout   The maximum time to wait in milliseconds (-1 = no limit, 0 = only check the file)
+ * @returns         1 if more lines can be read, 0 if the time expired or -1 if the file can't be followed
+ */
+int textfwait(TEXTFILE* textfile, int timeout) {
+#if defined(TEXTF__FOLLOW)
+    int status, interval;
+    assert( textfile!=NULL );
+    
+    textf__watchfollow(textfile);
+    while ((status=textf__checkfollow(textfile))==0 && timeout!=0) {
+        interval = textfile->watchFd>=0 ? TEXTF__FOLLOW_CHECK : TEXTF__FOLLOW_POLL;
+        if (timeout>0 && timeout<interval) { interval = timeout; }
+        textf__waitfollow(textfile, interval);
+        if (timeout>0) { timeout -= interval; }
+    }
+    return status;
+#else
+    (void)textfile; (void)timeout;
+    return -1;
+#endif
+}
+
+/**
+ * Returns the performance counters of the file (collected only when TEXTFILE_STATS is defined)
+ * @param textfile        Pointer to a TEXTFILE object that identifies a file opened with the 'textfopen' function
+ * @param[out] out_stats  Pointer to the TEXTF_STATS structure where the counters are returned
+ * @returns               Zero (0) on success or -1 if the counters were compiled out (all of them are returned as zero)
+ */
+int textfstats(const TEXTFILE* textfile, TEXTF_STATS* out_stats) {
+    assert( textfile!=NULL && out_stats!=NULL );
+#if defined(TEXTF__STATS)
+    (*out_stats) = textfile->stats;
+    return 0;
+#else
+    (void)textfile;
+    memset(out_stats, 0, sizeof(TEXTF_STATS));
+    return -1;
+#endif
+}
+
+/**
+ * This function is for compatibility with preexistent source code using standard file access
+ *
+ * Reads characters from text file until (bufsize-1) characters have been read or either
+ * a newline or end-of-file is reached, whichever happens first.
+ *
+ * @param buffer   Pointer to the buffer of chars where the string read will be stored
+ * @param bufsize  Maximum number of bytes to be copied into 'buffer' (including '\0')
+ * @param textfile Pointer to a TEXTFILE object that identifies a file opened with the 'textfopen' function
+ * @returns
+ *     pointer to 'buffer' when success or NULL when no more lines can be read
+ */
+char* textfgets(char* buffer, int bufsize, TEXTFILE* textfile) {
+    const char* line; size_t length;
+    assert( buffer!=NULL && bufsize>2 );
+    assert( textfile!=NULL );
+ 
+    line = textfgetline_n(textfile, &length); if (line==NULL) { return NULL; }
+    if (length>(size_t)(bufsize-2)) { length=(size_t)(bufsize-2); }
+    memcpy(buffer, line, length);
+    buffer[length]='\n'; buffer[length+1]='\0';
+    return buffer;
+}
+
+/**
+ * Reads all the remaining lines of a file using several threads
+ *
+ * The file is split into chunks that are processed in parallel by a pool of 'jobs' threads, each chunk begins
+ * in the next end-of-line found after its nominal offset. The 'filter' function is called concurrently from
+ * the threads, while the 'deliver' function is never called concurrently (the allocator of the options is also
+ * called from the threads). Only files opened in "rm" mode are processed in parallel, other files are read
+ * sequentially. The reading starts at the current position, the lines already read are not delivered again and
+ * the numbers continue from the last line read.
+ *
+ * @param textfile  Pointer to a TEXTFILE object that identifies a file opened with the 'textfopen' function
+ * @param jobs      The number of threads to use (including the calling thread)
+ * @param ordered   TEXTF_ORDERED to deliver the lines in file order, TEXTF_UNORDERED otherwise
+ * @param filter    Function called for every line, it returns TRUE to deliver the line (NULL = deliver all lines)
+ * @param deliver   Function called for every line accepted by 'filter' (can be NULL)
+ * @param userData  Pointer passed to the 'filter' and 'deliver' functions
+ * @returns         The number of lines read (all the remaining lines, even if 'deliver' stops the delivery)
+ *                  or -1 if an error has ocurred
+ */
+long textfparallel(TEXTFILE* textfile, int jobs, int ordered,
+                   TEXTF_LINEFUNC filter, TEXTF_LINEFUNC deliver, void* userData) {
+    TEXTF__PARALLEL parallel; const char *begin, *end; const char* line;
+    size_t length, chunkSize; long firstLine, lineNumber; int i;
+    assert( textfile!=NULL );
+    
+    /* files not mapped in memory are read sequentially */
+#if !defined(TEXTF__THREADS)
+    jobs = 1;
+#endif
+    firstLine = textfile->lineNumber;
+    if (!textfile->mapping || jobs<=1) {
+        while ((line=textfgetline_n(textfile,&length))!=NULL) {
+            if (filter==NULL || filter(userData, line, length, textfile->lineNumber)) {
+                /* (the delivery was stopped, the rest of the lines are read without delivering them) */
+                if (deliver && !deliver(userData, line, length, textfile->lineNumber)) { textfcountlines(textfile, NULL); break; }
+            }
+        }
+        return textfile->lineNumber - firstLine;
+    }
+    if (!textfissupported(textfile)) { return -1; }
+    
+    /* raw data to read, from the current position (in decoded files it's the offset of the next line) */
+    /* (an end-of-line before the position, ex: '\r' restored by textfseek, can have its second half there) */
+    if (textfile->isSkippingLine) { textf__skipline(textfile); }
+    if (textfile->nextLine==NULL) { return 0; }
+    if (textfile->pendingEol && !textf__skippendingeol(textfile)) { return 0; }
+    end   = textfile->mapping + textfile->mappingSize;
+    begin = textfile->decoder ? textfile->mapping + textf__lineoffset(textfile, textfile->nextLine) : textfile->nextLine;
+    
+    /* split the data into chunks beginning at line boundaries */
+    parallel.textfile      = textfile;
+    parallel.dataEnd       = end;
+    parallel.chunkCount    = jobs * TEXTF__CHUNKS_PER_JOB;
+    parallel.chunks        = textf__malloc(textfile, parallel.chunkCount*sizeof(TEXTF__CHUNK));
+    parallel.nextDelivery  = 0;
+    parallel.ordered       = ordered;
+    parallel.stop          = 0;
+    parallel.isOutOfMemory = 0;
+    if (!parallel.chunks) { return -1; }
+    parallel.filter        = filter;
+    parallel.deliver       = deliver;
+    parallel.userData      = userData;
+    chunkSize = (size_t)(end-begin) / parallel.chunkCount;
+    for (i=0; i<parallel.chunkCount; ++i) {
+        memset(&parallel.chunks[i], 0, sizeof(TEXTF__CHUNK));
+        parallel.chunks[i].start = (i==0) ? begin : parallel.chunks[i-1].end;
+        parallel.chunks[i].end   = (i==parallel.chunkCount-1) ? end :
+                                   textf__findlinestart(textfile, begin, begin+(i+1)*chunkSize, end);
+        if (parallel.chunks[i].end<parallel.chunks[i].start) { parallel.chunks[i].end = parallel.chunks[i].start; }
+    }
+    /* remove empty chunks (they would report an extra empty line) */
+    for (i=0; i<parallel.chunkCount; ) {
+        if (parallel.chunks[i].start==parallel.chunks[i].end && parallel.chunkCount>1) {
+            memmove(&parallel.chunks[i], &parallel.chunks[i+1], (parallel.chunkCount-i-1)*sizeof(TEXTF__CHUNK));
+            --parallel.chunkCount;
+        }
+        else { ++i; }
+    }
+#if defined(TEXTF__THREADS)
+    pthread_mutex_init(&parallel.queueMutex, NULL);
+    pthread_mutex_init(&parallel.deliveryMutex, NULL);
+#endif
+    
+    /* first pass: count the end-of-lines of each chunk to know the number of its first line */
+    parallel.isCounting = 1;
+    textf__runpool(&parallel, jobs);
+    lineNumber = firstLine + 1;
+    for (i=0; i<parallel.chunkCount; ++i) {
+        parallel.chunks[i].firstLine = lineNumber;
+        lineNumber += parallel.chunks[i].lineCount;
+    }
+    /* second pass: filter and deliver the lines */
+    parallel.isCounting = 0;
+    textf__runpool(&parallel, jobs);
+    
+#if defined(TEXTF__THREADS)
+    pthread_mutex_destroy(&parallel.queueMutex);
+    pthread_mutex_destroy(&parallel.deliveryMutex);
+#endif
+    for (i=0; i<parallel.chunkCount; ++i) {
+        textf__free(textfile, parallel.chunks[i].accepted);
+        textf__free(textfile, parallel.chunks[i].text);
+    }
+    textf__free(textfile, parallel.chunks);
+    /* all lines were read */
+    if (textfile->decoder) { textfile->rawNext = textfile->rawEnd; }
+    textfile->nextLine          = NULL;
+    textfile->moreDataAvailable = 0;
+    textfile->lineNumber        = lineNumber-1;
+    return parallel.isOutOfMemory ? -1 : (lineNumber-1) - firstLine;
+}
+
+/**
+ * Closes the file associated with the provided TEXTFILE object and releases all related resources
+ * @param textfile Pointer to a TEXTFILE object that specifies the file to close
+ * @returns        Zero (0) if the file is successfully closed
+ */
+int textfclose(TEXTFILE* textfile) {
+    int error=0;
+    if (textfile!=NULL) {
+        textf__stopreadahead(textfile);
+#if defined(TEXTF__MMAP)
+        if (textfile->mapping && textfile->isMappingOwned) { munmap(textfile->mapping, textfile->mappingSize); }
+#endif
+#if defined(TEXTF__FILEDESC)
+        if (textfile->fd>=0 && close(textfile->fd)!=0) { error = EOF; }
+#endif
+#if defined(TEXTF__INOTIFY)
+        if (textfile->watchFd>=0) { close(textfile->watchFd); }
+#endif
+#if defined(TEXTF__INDEXFILE)
+        if (textfile->index && textfile->isIndexModified) { textf__writeindexfile(textfile); }
+#endif
+        if (textfile->file && textfile->isFileOwned) { error = fclose(textfile->file); }
+        textf__free(textfile, textfile->index);
+        textf__free(textfile, textfile->filename);
+        textf__free(textfile, textfile->lineBuffer);
+        textf__free(textfile, textfile->rawBuffer);
+        textf__free(textfile, textfile->tailBuffer);
+        textf__free(textfile, textfile->expandedBuffer);
+        textfile->options.freeFunc(textfile->options.allocatorData, textfile);
+    }
+    return error;
+}
+
+
+/*=================================================================================================================*/
+#pragma mark - > TEXT SEARCH IMPLEMENTATION
+
+/**
+ * Prepares the search of several patterns at once (Aho-Corasick automaton)
+ * @param patterns  Array of null-terminated patterns (they can't contain end-of-line characters)
+ * @param count     The number of elements in the 'patterns' array
+ * @param flags     TEXTF_SEARCH_IGNORECASE or 0
+ * @returns         The pointer to the TEXTF_SEARCH object or NULL if a pattern contains end-of-line characters
+ *                  (or if there isn't enough memory)
+ */
+TEXTF_SEARCH* textfsearch_new(const char* const* patterns, int count, int flags) {
+    return textfsearch_new_ex(patterns, count, flags, NULL);
+}
+
+/**
+ * Same as `textfsearch_new(..)` but allocating the memory with the allocator of the provided options
+ * @param options   The options providing 'mallocFunc', 'freeFunc' and 'allocatorData' (NULL = malloc/free)
+ */
+TEXTF_SEARCH* textfsearch_new_ex(const char* const* patterns, int count, int flags, const TEXTF_OPTIONS* options) {
+    TEXTF_SEARCH* search; const unsigned char* ptr; unsigned char used[256];
+    int *child, *queue, *fail; int i, c, state, maxStates, head, tail, target, classCount, isCustom;
+    assert( (patterns!=NULL || count==0) && count>=0 );
+    
+    for (i=0; i<count; ++i) { if (strpbrk(patterns[i], "\r\n")) { return NULL; } }
+    isCustom = options && options->mallocFunc && options->freeFunc;
+    search   = isCustom ? options->mallocFunc(options->allocatorData, sizeof(TEXTF_SEARCH)) : malloc(sizeof(TEXTF_SEARCH));
+    if (!search) { return NULL; }
+    memset(&search->options, 0, sizeof(search->options));
+    search->options.mallocFunc    = isCustom ? options->mallocFunc    : textf__stdmalloc;
+    search->options.freeFunc      = isCustom ? options->freeFunc      : textf__stdfree;
+    search->options.allocatorData = isCustom ? options->allocatorData : NULL;
+    search->flags        = flags;
+    search->patternCount = count;
+    search->lengths      = textf__malloc(search, (count+1)*sizeof(size_t));
+    search->next         = NULL;
+    search->found        = NULL;
+    if (!search->lengths) { textfsearch_free(search); return NULL; }
+    
+    /* group the bytes in classes (only the bytes used by the patterns need a column in the transition table) */
+    memset(used, 0, sizeof(used));
+    for (i=0; i<count; ++i) {
+        search->lengths[i] = strlen(patterns[i]);
+        for (ptr=(const unsigned char*)patterns[i]; *ptr; ++ptr) { used[*ptr]=1; }
+    }
+    if (flags & TEXTF_SEARCH_IGNORECASE) {
+        for (c='a'; c<='z'; ++c) { used[c] = used[c-'a'+'A'] = (used[c] || used[c-'a'+'A']); }
+    }
+    classCount = 1;
+    for (c=0; c<256; ++c) {
+        search->classes[c] = 0;
+        if (!used[c] || ((flags & TEXTF_SEARCH_IGNORECASE) && 'A'<=c && c<='Z')) { continue; }
+        search->classes[c] = (unsigned short)classCount++;
+    }
+    if (flags & TEXTF_SEARCH_IGNORECASE) {
+        for (c='A'; c<='Z'; ++c) { search->classes[c] = search->classes[c-'A'+'a']; }
+    }
+    search->classCount = classCount;
+    
+    /* build the trie of the patterns (-1 = no transition) */
+    maxStates = 1;
+    for (i=0; i<count; ++i) { maxStates += (int)search->lengths[i]; }
+    child         = textf__malloc(search, (size_t)maxStates*classCount*sizeof(int));
+    search->found = textf__malloc(search, (size_t)maxStates*sizeof(int));
+    search->next  = child;
+    if (!child || !search->found) { textfsearch_free(search); return NULL; }
+    for (i=0; i<maxStates*classCount; ++i) { child[i]=-1; }
+    search->found[0] = -1; search->stateCount = 1;
+    for (i=0; i<count; ++i) {
+        state = 0;
+        for (ptr=(const unsigned char*)patterns[i]; *ptr; ++ptr) {
+            c = search->classes[*ptr];
+            if (child[state*classCount+c]<0) {
+                search->found[search->stateCount] = -1;
+                child[state*classCount+c] = search->stateCount++;
+            }
+            state = child[state*classCount+c];
+        }
+        if (search->found[state]<0) { search->found[state] = i; }
+    }
+    
+    /* complete the missing transitions following the failure links            */
+    /* (breadth-first, so the states of the failure links are always completed) */
+    queue = textf__malloc(search, (size_t)search->stateCount*sizeof(int));
+    fail  = textf__malloc(search, (size_t)search->stateCount*sizeof(int));
+    if (!queue || !fail) { textf__free(search, queue); textf__free(search, fail); textfsearch_free(search); return NULL; }
+    head = tail = 0;
+    for (c=0; c<classCount; ++c) {
+        target = child[c];
+        if (target<0) { child[c] = 0; }
+        else          { fail[target] = 0; queue[tail++] = target; }
+    }
+    while (head<tail) {
+        state = queue[head++];
+        if (search->found[state]<0) { search->found[state] = search->found[fail[state]]; }
+        for (c=0; c<classCount; ++c) {
+            target = child[state*classCount+c];
+            if (target<0) { child[state*classCount+c] = child[fail[state]*classCount+c]; }
+            else          { fail[target] = child[fail[state]*classCount+c]; queue[tail++] = target; }
+        }
+    }
+    textf__free(search, queue);
+    textf__free(search, fail);
+    
+    /* collect the bytes that can start a pattern (the SIMD prefilter is used when they are only a few) */
+    search->startCount = 0;
+    for (c=0; c<256; ++c) {
+        search->isStart[c] = (search->classes[c]!=0 && child[search->classes[c]]!=0);
+        if (!search->isStart[c]) { continue; }
+        if (0<=search->startCount && search->startCount<TEXTF__MAX_STARTS) { search->starts[search->startCount++] = (unsigned char)c; }
+        else { search->startCount = -1; }
+    }
+    if (search->startCount<0) { search->startCount = 0; }
+    return search;
+}
+
+/**
+ * Finds the first occurrence of any of the patterns in the provided text (it can be called concurrently)
+ * @param search           Pointer to a TEXTF_SEARCH object created with `textfsearch_new(..)`
+ * @param text             The text where the patterns are searched (it doesn't need to be null-terminated)
+ * @param length           The length of the text in bytes
+ * @param[out] out_pattern Pointer to the variable where the index of the pattern found will be returned (can be NULL)
+ * @returns                A pointer to the beginning of the occurrence or NULL if none of the patterns was found
+ */
+const char* textfsearch_find(const TEXTF_SEARCH* search, const char* text, size_t length, int* out_pattern) {
+    const char* found; int pattern=-1;
+    assert( search!=NULL && text!=NULL );
+    
+    found = textf__searchtext(search, text, text+length, &pattern);
+    if (out_pattern) { (*out_pattern) = pattern; }
+    return pattern>=0 ? found : NULL;
+}
+
+/**
+ * Releases a TEXTF_SEARCH object
+ * @param search  Pointer to the TEXTF_SEARCH object to release (NULL is ignored)
+ */
+void textfsearch_free(TEXTF_SEARCH* search) {
+    if (!search) { return; }
+    textf__free(search, search->lengths);
+    textf__free(search, search->next);
+    textf__free(search, search->found);
+    search->options.freeFunc(search->options.allocatorData, search);
+}
 
 #endif /* ifdef TEXTFILE_IMPLEMENTATION */
 
@@ -0,0 +1,203 @@
+/**
+ * @file       textfile.hpp
+ * @date       Oct 16, 2026
+ * @author     Martin Rizzo | <martinrizzo@gmail.com>
+ * @copyright  Copyright (c) 2020 Martin Rizzo.
+ *             This project is released under the MIT License.
+ * -------------------------------------------------------------------------
+ *  TextFile - C++17 interface (RAII reader and range of lines) over the
+ *             'textfile.h' library
+ * -------------------------------------------------------------------------
+ *  Copyright (c) 2020 Martin Rizzo
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ *  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ *  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ *  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ * -------------------------------------------------------------------------
+ *  The implementation of the library is compiled as C, in one '.c' file of
+ *  the project that defines TEXTFILE_IMPLEMENTATION before including
+ *  'textfile.h'; this header only adds inline C++ code over its functions.
+ * -------------------------------------------------------------------------
+ */
+#ifndef TEXTFILE_HPP_INCLUDED
+#define TEXTFILE_HPP_INCLUDED
+
+#include "textfile.h"
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+#include <utility>
+#ifndef TEXTFILE_HPP_BATCH
+#define TEXTFILE_HPP_BATCH 256          /* < number of lines requested to 'textfgetlines' by each range of lines */
+#endif
+
+namespace textf {
+
+
+/*=================================================================================================================*/
+#pragma mark - > RANGE OF LINES
+
+/**
+ * Range of the remaining lines of a file, each line is a `std::string_view` that points into the buffer of the file
+ * (the lines are taken in batches with `textfgetlines(..)`, so nothing is allocated or copied)
+ *
+ * It's an input range: the lines are consumed while iterating and each line is valid until the iterator is
+ * incremented. When the end is reached, `begin()` can be called again to continue with the lines appended later
+ * (files followed with the "rf" mode, after `textfwait(..)`).
+ */
+class line_range {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = std::string_view;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const std::string_view*;
+        using reference         = const std::string_view&;
+
+        iterator() noexcept = default;
+        explicit iterator(line_range* range) noexcept : m_range(range) { }
+
+        reference operator*()  const noexcept { return m_range->m_line;  }
+        pointer   operator->() const noexcept { return &m_range->m_line; }
+        iterator& operator++() noexcept { if (!m_range->next()) { m_range = nullptr; } return *this; }
+        void      operator++(int) noexcept { ++(*this); }
+
+        /** Returns the number of the current line, starting at 1 */
+        long line_number() const noexcept { return m_range->line_number(); }
+
+        friend bool operator==(const iterator& a, const iterator& b) noexcept { return a.m_range==b.m_range; }
+        friend bool operator!=(const iterator& a, const iterator& b) noexcept { return a.m_range!=b.m_range; }
+
+    private:
+        line_range* m_range = nullptr;
+    };
+
+    explicit line_range(TEXTFILE* textfile) noexcept : m_textfile(textfile) { }
+    line_range(const line_range&) = delete;
+    line_range& operator=(const line_range&) = delete;
+
+    iterator begin() noexcept { return (m_index<m_count || next()) ? iterator(this) : iterator(); }
+    iterator end()   noexcept { return iterator(); }
+
+    /** Returns the number of the current line, starting at 1 */
+    long line_number() const noexcept { return m_lastNumber - (m_count-1-m_index); }
+
+private:
+    /** Moves to the next line, requesting a new batch of lines when the current one is drained */
+    bool next() noexcept {
+        if (++m_index>=m_count) {
+            m_index = 0;
+            m_count = m_textfile ? textfgetlines(m_textfile, m_spans, TEXTFILE_HPP_BATCH) : 0;
+            if (m_count<=0) { m_count = 0; return false; }
+            m_lastNumber = m_textfile->lineNumber;
+        }
+        m_line = std::string_view(m_spans[m_index].line, m_spans[m_index].length);
+        return true;
+    }
+
+    TEXTFILE*        m_textfile;
+    TEXTF_SPAN       m_spans[TEXTFILE_HPP_BATCH];
+    int              m_count      = 0;
+    int              m_index      = 0;
+    long             m_lastNumber = 0; /* < number of the last line of the batch */
+    std::string_view m_line;
+};
+
+
+/*=================================================================================================================*/
+#pragma mark - > READER
+
+/**
+ * Owns a TEXTFILE object and closes it when destroyed (it can be moved but not copied)
+ *
+ * The functions report errors like the C library does: `is_open()`, `is_supported()` and `error()` are checked
+ * by the caller, no exception is thrown.
+ */
+class reader {
+public:
+    reader() noexcept = default;
+
+    /**
+     * Opens a file (see textfopen_ex)
+     * @param filename  The path to the file to open
+     * @param mode      "r", "rm" or "rf"
+     * @param options   The options used to open the file (NULL = defaults)
+     */
+    explicit reader(const char* filename, const char* mode = "r", const TEXTF_OPTIONS* options = nullptr) noexcept
+        : m_textfile(textfopen_ex(filename, mode, options)) { }
+
+    /** Takes the ownership of a TEXTFILE object opened with the C functions (textfopen_mem, textfdopen, ...) */
+    explicit reader(TEXTFILE* textfile) noexcept : m_textfile(textfile) { }
+
+    reader(reader&& other) noexcept : m_textfile(std::exchange(other.m_textfile, nullptr)) { }
+    reader& operator=(reader&& other) noexcept {
+        if (this!=&other) { close(); m_textfile = std::exchange(other.m_textfile, nullptr); }
+        return *this;
+    }
+    reader(const reader&) = delete;
+    reader& operator=(const reader&) = delete;
+    ~reader() { close(); }
+
+    bool           is_open()      const noexcept { return m_textfile!=nullptr; }
+    bool           is_supported() const noexcept { return m_textfile && textfissupported(m_textfile); }
+    TEXTF_ENCODING encoding()     const noexcept { return m_textfile ? m_textfile->encoding : TEXTF_ENCODING_BINARY; }
+    TEXTF_EOL      eol()          const noexcept { return m_textfile ? m_textfile->eol : TEXTF_EOL_UNKNOWN; }
+    TEXTF_ERROR    error()        const noexcept { return m_textfile ? textferror(m_textfile) : TEXTF_ERROR_NONE; }
+    long           line_number()  const noexcept { return m_textfile ? m_textfile->lineNumber : 0; }
+    TEXTFILE*      get()          const noexcept { return m_textfile; }
+
+    /** Gives up the ownership of the TEXTFILE object (it must be closed with textfclose) */
+    TEXTFILE* release() noexcept { return std::exchange(m_textfile, nullptr); }
+
+    /** Closes the file (it's closed automatically when the reader is destroyed) */
+    int close() noexcept { return m_textfile ? textfclose(std::exchange(m_textfile, nullptr)) : 0; }
+
+    /**
+     * Reads the next line of text (see textfgetline_n)
+     * @param[out] out_line  The line (it's valid until the next read operation)
+     * @returns              TRUE if a line was read, FALSE if there isn't more lines to read
+     */
+    bool getline(std::string_view& out_line) noexcept {
+        const char* line; size_t length=0;
+        line = m_textfile ? textfgetline_n(m_textfile, &length) : nullptr;
+        out_line = line ? std::string_view(line, length) : std::string_view();
+        return line!=nullptr;
+    }
+
+    /** Returns the range of the remaining lines, ex: `for (std::string_view line : reader.lines()) { .. }` */
+    line_range lines() noexcept { return line_range(is_supported() ? m_textfile : nullptr); }
+
+    int  seek_line(long lineNumber) noexcept { return m_textfile ? textfseekline(m_textfile, lineNumber) : -1; }
+    int  seek_tail(long lineCount)  noexcept { return m_textfile ? textfseektail(m_textfile, lineCount)  : -1; }
+    int  wait(int timeout)          noexcept { return m_textfile ? textfwait(m_textfile, timeout)        : -1; }
+    int  tell(TEXTF_POS& out_pos)   noexcept { return m_textfile ? textftell(m_textfile, &out_pos)        : -1; }
+    int  seek(const TEXTF_POS& pos) noexcept { return m_textfile ? textfseek(m_textfile, &pos)            : -1; }
+
+    /** Counts the remaining lines without returning them (the counts of each end-of-line style are optional) */
+    long count_lines(TEXTF_EOLCOUNTS* out_counts = nullptr) noexcept {
+        return m_textfile ? textfcountlines(m_textfile, out_counts) : 0;
+    }
+
+private:
+    TEXTFILE* m_textfile = nullptr;
+};
+
+} /* namespace textf */
+
+#endif /* ifndef TEXTFILE_HPP_INCLUDED */